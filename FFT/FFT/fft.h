@@ -0,0 +1,1072 @@
+#ifndef fft_h
+#define fft_h
+
+#include <complex>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <float.h>
+#include <math.h>
+
+#include "thread_pool.h"
+
+#if defined( __x86_64__ ) || defined( __i386__ )
+#define FFT_X86_KERNELS 1
+#include <immintrin.h>
+#else
+#define FFT_X86_KERNELS 0
+#endif
+
+using cld = std::complex <long double>;
+const long double PI = acosl(-1.0);
+
+// Largest value of estimateFFTError at which rounding of the double
+// transform is still trusted
+const double FFT_SAFE_ERROR = 0.25;
+
+// Largest measured distance of an output from the nearest integer at which
+// a result is accepted; beyond it the next, more precise method is tried.
+// Trusted transforms stay several times below it
+const double FFT_ROUNDING_LIMIT = 0.125;
+
+// Coefficients are split into high * 2^FFT_SPLIT_BITS + low when a plain
+// double transform is not precise enough
+const int FFT_SPLIT_BITS = 16;
+
+// Transforms of this size and larger are done by the multithreaded
+// four-step algorithm. On one thread it catches up with the plain one
+// at about this size, where data stops fitting in cache
+const size_t FFT_FOUR_STEP_SIZE = size_t( 1 ) << 22;
+
+inline size_t findUpperDegreeOfTwo( size_t v )
+{
+    size_t n = 1;
+    while ( n < v ) {
+        n *= 2;
+    }
+    return n;
+}
+
+std::vector <cld> makeComplexVector( const std::vector<int> & a, size_t n )
+{
+    std::vector <cld> ca( n, cld( 0.0, 0.0 ) );
+    for ( size_t i = 0; i < a.size(); i++ ) {
+        ca[i] = cld( a[i], 0.0 );
+    }
+    return ca;
+}
+
+// Moves a[i] to the position with reversed bits of i
+void makeBitReversal( std::vector <cld> & a )
+{
+    size_t n = a.size();
+    for ( size_t i = 1, j = 0; i < n; i++ ) {
+        size_t bit = n >> 1;
+        for ( ; j & bit; bit >>= 1 ) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if ( i < j ) {
+            std::swap( a[i], a[j] );
+        }
+    }
+}
+
+// Roots for every level of the transform: for each power of two len < n
+// w[len + j] = exp(i * PI * j / len), j < len. Every root is computed
+// directly, so there is no drift from repeated multiplication. Only the
+// first eighth of the circle needs cosl and sinl, the rest is obtained by
+// symmetry, and lower levels are every other root of the level above
+template <class Real = long double>
+std::vector <std::complex <Real>> makeTwiddles( size_t n )
+{
+    using Complex = std::complex <Real>;
+
+    std::vector <Complex> w( std::max( n, size_t( 2 ) ) );
+    size_t top = n / 2;
+    if ( top == 0 ) {
+        return w;
+    }
+
+    for ( size_t j = 0; 4 * j <= top; j++ ) {
+        Real ang = static_cast <Real> ( PI ) * j / top;
+        w[top + j] = Complex( std::cos( ang ), std::sin( ang ) );
+    }
+    for ( size_t j = top / 4 + 1; 2 * j <= top; j++ ) {
+        w[top + j] = Complex( w[top + top / 2 - j].imag(), w[top + top / 2 - j].real() );
+    }
+    for ( size_t j = top / 2 + 1; j < top; j++ ) {
+        w[top + j] = Complex( -w[top + top - j].real(), w[top + top - j].imag() );
+    }
+
+    for ( size_t len = top / 2; len >= 1; len /= 2 ) {
+        for ( size_t j = 0; j < len; j++ ) {
+            w[len + j] = w[2 * len + 2 * j];
+        }
+    }
+    return w;
+}
+
+// Plain product without the NaN/Inf recovery of std::complex operator *
+inline cld multiplyComplex( const cld & a, const cld & b )
+{
+    return cld( a.real() * b.real() - a.imag() * b.imag(), a.real() * b.imag() + a.imag() * b.real() );
+}
+
+// Iterative in-place Cooley-Tukey transform with roots from makeTwiddles,
+// a.size() must be a power of two
+void makeGeneralFFT( std::vector <cld> & a, const std::vector <cld> & w )
+{
+    size_t n = a.size();
+
+    makeBitReversal( a );
+
+    for ( size_t len = 1; len < n; len *= 2 ) {
+        for ( size_t i = 0; i < n; i += 2 * len ) {
+            for ( size_t j = 0; j < len; j++ ) {
+                cld u = a[i + j];
+                cld v = multiplyComplex( a[i + j + len], w[len + j] );
+                a[i + j] = u + v;
+                a[i + j + len] = u - v;
+            }
+        }
+    }
+}
+
+// Inverse transform through the forward one: conjugate roots give the same
+// values as forward transform with reversed order of a[1..n-1]
+void makeGeneralInverseFFT( std::vector <cld> & a, const std::vector <cld> & w )
+{
+    makeGeneralFFT( a, w );
+    std::reverse( a.begin() + 1, a.end() );
+    for ( size_t i = 0; i < a.size(); i++ ) {
+        a[i] /= a.size();
+    }
+}
+
+std::vector <cld> makeFFT( std::vector <cld> a )
+{
+    makeGeneralFFT( a, makeTwiddles( a.size() ) );
+    return a;
+}
+
+std::vector <cld> makeInverseFFT( std::vector <cld> a )
+{
+    makeGeneralInverseFFT( a, makeTwiddles( a.size() ) );
+    return a;
+}
+
+std::vector <int> makeIntVector( const std::vector<cld> & a )
+{
+    std::vector <int> ans( a.size() );
+    for ( size_t i = 0; i < a.size(); i++ ) {
+        ans[i] = floorl( a[i].real() + 0.5 );
+    }
+    return ans;
+}
+
+//
+// Double precision transform
+//
+
+// Complex vector stored as two arrays (structure of arrays), so one vector
+// instruction loads several real or several imaginary parts
+struct SplitComplex
+{
+    std::vector <double> re;
+    std::vector <double> im;
+
+    explicit SplitComplex( size_t n = 0 ) : re( n, 0.0 ), im( n, 0.0 ) {}
+
+    size_t size() const
+    {
+        return re.size();
+    }
+};
+
+enum FFTKernel
+{
+    SCALAR_KERNEL,
+    AVX2_KERNEL,
+    AVX512_KERNEL
+};
+
+// Widest butterfly kernel the processor supports, asked from CPUID
+FFTKernel detectFFTKernel()
+{
+#if FFT_X86_KERNELS
+    __builtin_cpu_init();
+    if ( __builtin_cpu_supports( "avx512f" ) ) {
+        return AVX512_KERNEL;
+    }
+    if ( __builtin_cpu_supports( "avx2" ) && __builtin_cpu_supports( "fma" ) ) {
+        return AVX2_KERNEL;
+    }
+#endif
+    return SCALAR_KERNEL;
+}
+
+// Kernel used by double transforms, detected on first call. It may be lowered
+// (e.g. by benchmarks), but never raised above detectFFTKernel()
+FFTKernel & currentFFTKernel()
+{
+    static FFTKernel kernel = detectFFTKernel();
+    return kernel;
+}
+
+// Same layout as makeTwiddles
+SplitComplex makeDoubleTwiddles( size_t n )
+{
+    std::vector <std::complex <double>> w = makeTwiddles <double> ( n );
+    SplitComplex result( w.size() );
+    for ( size_t i = 0; i < w.size(); i++ ) {
+        result.re[i] = w[i].real();
+        result.im[i] = w[i].imag();
+    }
+    return result;
+}
+
+// One pass of butterflies with half-length len over arrays of size n
+void makeButterfliesScalar( double * re, double * im, const double * wr, const double * wi, size_t n, size_t len )
+{
+    for ( size_t i = 0; i < n; i += 2 * len ) {
+        for ( size_t j = 0; j < len; j++ ) {
+            double xr = re[i + j + len];
+            double xi = im[i + j + len];
+            double vr = xr * wr[len + j] - xi * wi[len + j];
+            double vi = xr * wi[len + j] + xi * wr[len + j];
+            re[i + j + len] = re[i + j] - vr;
+            im[i + j + len] = im[i + j] - vi;
+            re[i + j] += vr;
+            im[i + j] += vi;
+        }
+    }
+}
+
+#if FFT_X86_KERNELS
+
+// Same pass four butterflies at a time, len >= 4
+__attribute__(( target( "avx2,fma" ) ))
+void makeButterfliesAVX2( double * re, double * im, const double * wr, const double * wi, size_t n, size_t len )
+{
+    for ( size_t i = 0; i < n; i += 2 * len ) {
+        for ( size_t j = 0; j < len; j += 4 ) {
+            size_t k = i + j;
+            __m256d ur = _mm256_loadu_pd( re + k );
+            __m256d ui = _mm256_loadu_pd( im + k );
+            __m256d xr = _mm256_loadu_pd( re + k + len );
+            __m256d xi = _mm256_loadu_pd( im + k + len );
+            __m256d cr = _mm256_loadu_pd( wr + len + j );
+            __m256d ci = _mm256_loadu_pd( wi + len + j );
+            __m256d vr = _mm256_fmsub_pd( xr, cr, _mm256_mul_pd( xi, ci ) );
+            __m256d vi = _mm256_fmadd_pd( xr, ci, _mm256_mul_pd( xi, cr ) );
+            _mm256_storeu_pd( re + k, _mm256_add_pd( ur, vr ) );
+            _mm256_storeu_pd( im + k, _mm256_add_pd( ui, vi ) );
+            _mm256_storeu_pd( re + k + len, _mm256_sub_pd( ur, vr ) );
+            _mm256_storeu_pd( im + k + len, _mm256_sub_pd( ui, vi ) );
+        }
+    }
+}
+
+// Same pass eight butterflies at a time, len >= 8
+__attribute__(( target( "avx512f" ) ))
+void makeButterfliesAVX512( double * re, double * im, const double * wr, const double * wi, size_t n, size_t len )
+{
+    for ( size_t i = 0; i < n; i += 2 * len ) {
+        for ( size_t j = 0; j < len; j += 8 ) {
+            size_t k = i + j;
+            __m512d ur = _mm512_loadu_pd( re + k );
+            __m512d ui = _mm512_loadu_pd( im + k );
+            __m512d xr = _mm512_loadu_pd( re + k + len );
+            __m512d xi = _mm512_loadu_pd( im + k + len );
+            __m512d cr = _mm512_loadu_pd( wr + len + j );
+            __m512d ci = _mm512_loadu_pd( wi + len + j );
+            __m512d vr = _mm512_fmsub_pd( xr, cr, _mm512_mul_pd( xi, ci ) );
+            __m512d vi = _mm512_fmadd_pd( xr, ci, _mm512_mul_pd( xi, cr ) );
+            _mm512_storeu_pd( re + k, _mm512_add_pd( ur, vr ) );
+            _mm512_storeu_pd( im + k, _mm512_add_pd( ui, vi ) );
+            _mm512_storeu_pd( re + k + len, _mm512_sub_pd( ur, vr ) );
+            _mm512_storeu_pd( im + k + len, _mm512_sub_pd( ui, vi ) );
+        }
+    }
+}
+
+#endif
+
+// Passes with half-length len over n elements at re and im,
+// done by the widest kernel that fits len
+void makeButterflies( double * re, double * im, const SplitComplex & w, size_t n, size_t len, FFTKernel kernel )
+{
+#if FFT_X86_KERNELS
+    if ( kernel == AVX512_KERNEL && len >= 8 ) {
+        makeButterfliesAVX512( re, im, w.re.data(), w.im.data(), n, len );
+        return;
+    }
+    if ( kernel != SCALAR_KERNEL && len >= 4 ) {
+        makeButterfliesAVX2( re, im, w.re.data(), w.im.data(), n, len );
+        return;
+    }
+#else
+    (void) kernel;
+#endif
+    makeButterfliesScalar( re, im, w.re.data(), w.im.data(), n, len );
+}
+
+// Passes of the transform over n bit reversed elements, with roots from
+// makeDoubleTwiddles. First passes run block by block, so that each
+// block stays in cache for all of them
+void makeButterflyPasses( double * re, double * im, size_t n, const SplitComplex & w )
+{
+    const size_t block = 1 << 12;
+
+    size_t first = std::min( n, block );
+    FFTKernel kernel = currentFFTKernel();
+
+    for ( size_t offset = 0; offset < n; offset += first ) {
+        for ( size_t len = 1; len < first; len *= 2 ) {
+            makeButterflies( re + offset, im + offset, w, first, len, kernel );
+        }
+    }
+    for ( size_t len = first; len < n; len *= 2 ) {
+        makeButterflies( re, im, w, n, len, kernel );
+    }
+}
+
+// Buffers for convolutions and large transforms, one set per thread. They
+// keep their capacity between calls, so repeated work of the same size
+// does not allocate
+SplitComplex & findScratch( int index )
+{
+    static thread_local SplitComplex scratch[4];
+    return scratch[index];
+}
+
+// Number of threads for transforms of FFT_FOUR_STEP_SIZE and more, all
+// cores by default. It may be changed at any time (e.g. by benchmarks),
+// transforms already running keep their pool
+std::atomic <size_t> & currentFFTThreads()
+{
+    static std::atomic <size_t> threads( std::max( 1u, std::thread::hardware_concurrency() ) );
+    return threads;
+}
+
+// Pool with currentFFTThreads() threads, rebuilt when that number changes.
+// Callers hold the pointer for the whole transform: a rebuild only drops
+// the shared reference, and the old pool goes away with its last user
+std::shared_ptr <ThreadPool> findFFTThreadPool()
+{
+    static std::mutex mutex;
+    static std::shared_ptr <ThreadPool> pool;
+
+    size_t threads = currentFFTThreads();
+    std::lock_guard <std::mutex> lock( mutex );
+    if ( !pool || pool->size() != threads ) {
+        pool = std::make_shared <ThreadPool> ( threads );
+    }
+    return pool;
+}
+
+// to = transposed from, where from is a rows x columns matrix stored by
+// rows. Goes by square tiles, each tile is written column by column so
+// that writes are contiguous, and real and imaginary parts are done one
+// after another to halve the number of memory streams. Columns of tiles
+// (rows of the result) are shared among the threads
+void transposeMatrix( const SplitComplex & from, SplitComplex & to, size_t rows, size_t columns, ThreadPool & pool )
+{
+    const size_t tile = 32;
+
+    pool.parallelFor( ( columns + tile - 1 ) / tile, [&]( size_t t ) {
+        size_t column_end = std::min( columns, ( t + 1 ) * tile );
+        const double * source[2] = { from.re.data(), from.im.data() };
+        double * target[2] = { to.re.data(), to.im.data() };
+
+        for ( int part = 0; part < 2; part++ ) {
+            for ( size_t row = 0; row < rows; row += tile ) {
+                size_t row_end = std::min( rows, row + tile );
+                for ( size_t j = t * tile; j < column_end; j++ ) {
+                    for ( size_t i = row; i < row_end; i++ ) {
+                        target[part][j * rows + i] = source[part][i * columns + j];
+                    }
+                }
+            }
+        }
+    } );
+}
+
+// Everything a double transform of size n needs besides the data:
+// twiddles and the bit reversal table. They also serve every smaller
+// power of two, since lower levels of the twiddle table do not depend on
+// n and reversing fewer bits is a shift of the full reversal. A plan is
+// never changed after construction, so threads may share it freely
+class FFTPlan
+{
+
+public:
+
+    explicit FFTPlan( size_t );
+
+    size_t size() const;
+    const SplitComplex & twiddles() const;
+
+    // Forward and inverse transforms of in to out. in.size() must be a
+    // power of two not greater than size(), out must be of the same size
+    // (it may be in itself). Sizes from FFT_FOUR_STEP_SIZE go through
+    // executeFourStep. Nothing is allocated, except for per-thread scratch
+    // the first time a size is seen
+    void execute( const SplitComplex & in, SplitComplex & out ) const;
+    void executeInverse( const SplitComplex & in, SplitComplex & out ) const;
+
+    // In-place forward transform of n elements at re and im, one row of
+    // a larger array; n is a power of two not greater than size()
+    void executeRow( double *, double *, size_t ) const;
+
+    // Plan shared by the whole program, built on the first request for
+    // the size. Plans are never destroyed, so the reference stays valid
+    static const FFTPlan & get( size_t );
+
+
+private:
+
+    // Class fields
+    size_t n_;
+    SplitComplex w_;
+    std::vector <uint32_t> reversal_;
+
+
+    // Secondary functions
+    void permute( const SplitComplex &, SplitComplex & ) const;
+    void executeFourStep( const SplitComplex &, SplitComplex & ) const;
+    std::complex <double> findRoot( size_t, size_t ) const;
+};
+
+FFTPlan::FFTPlan( size_t n ) : n_( n ), w_( makeDoubleTwiddles( n ) ), reversal_( n, 0 )
+{
+    for ( size_t i = 1, j = 0; i < n; i++ ) {
+        size_t bit = n >> 1;
+        for ( ; j & bit; bit >>= 1 ) {
+            j ^= bit;
+        }
+        j ^= bit;
+        reversal_[i] = static_cast <uint32_t> ( j );
+    }
+}
+
+size_t FFTPlan::size() const
+{
+    return n_;
+}
+
+const SplitComplex & FFTPlan::twiddles() const
+{
+    return w_;
+}
+
+// out[reverse(i)] = in[i], where reverse takes log in.size() bits
+void FFTPlan::permute( const SplitComplex & in, SplitComplex & out ) const
+{
+    size_t n = in.size();
+    int shift = 0;
+    while ( ( n << shift ) < n_ ) {
+        shift++;
+    }
+
+    if ( &in == &out ) {
+        for ( size_t i = 1; i < n; i++ ) {
+            size_t j = reversal_[i] >> shift;
+            if ( i < j ) {
+                std::swap( out.re[i], out.re[j] );
+                std::swap( out.im[i], out.im[j] );
+            }
+        }
+        return;
+    }
+
+    for ( size_t i = 0; i < n; i++ ) {
+        size_t j = reversal_[i] >> shift;
+        out.re[j] = in.re[i];
+        out.im[j] = in.im[i];
+    }
+}
+
+void FFTPlan::executeRow( double * re, double * im, size_t n ) const
+{
+    int shift = 0;
+    while ( ( n << shift ) < n_ ) {
+        shift++;
+    }
+
+    for ( size_t i = 1; i < n; i++ ) {
+        size_t j = reversal_[i] >> shift;
+        if ( i < j ) {
+            std::swap( re[i], re[j] );
+            std::swap( im[i], im[j] );
+        }
+    }
+    makeButterflyPasses( re, im, n, w_ );
+}
+
+// exp(2 * PI * i * m / n) for m < n, n not greater than size()
+std::complex <double> FFTPlan::findRoot( size_t m, size_t n ) const
+{
+    if ( 2 * m < n ) {
+        return std::complex <double> ( w_.re[n / 2 + m], w_.im[n / 2 + m] );
+    }
+    return std::complex <double> ( -w_.re[m], -w_.im[m] );
+}
+
+// Four-step (Bailey) transform for n = rows * columns: with j = j1 + rows * j2
+// and k = k2 + columns * k1, X[k] = sum over j1 of w_n^(j1 k2) w_rows^(j1 k1) *
+// (transform of length columns over j2 of x[j1 + rows * j2]). So the data is
+// transposed, rows of length columns are transformed and multiplied by
+// w_n^(j1 k2), transposed back, rows of length rows are transformed, and
+// a last transpose puts k in order. Every row fits in L2 cache, and rows
+// are spread over findFFTThreadPool()
+void FFTPlan::executeFourStep( const SplitComplex & in, SplitComplex & out ) const
+{
+    size_t n = in.size();
+    size_t rows = 1;
+    while ( rows * rows < n ) {
+        rows *= 2;
+    }
+    size_t columns = n / rows;
+    int shift = 0;
+    while ( ( size_t( 1 ) << shift ) < columns ) {
+        shift++;
+    }
+
+    std::shared_ptr <ThreadPool> shared_pool = findFFTThreadPool();
+    ThreadPool & pool = *shared_pool;
+    SplitComplex & scratch = findScratch( 2 );
+    scratch.re.resize( n );
+    scratch.im.resize( n );
+
+    // w_n^m = low[m % columns] * high[m / columns], low is a piece of w_
+    SplitComplex & high = findScratch( 3 );
+    high.re.resize( rows );
+    high.im.resize( rows );
+    for ( size_t i = 0; i < rows; i++ ) {
+        std::complex <double> root = findRoot( i * columns, n );
+        high.re[i] = root.real();
+        high.im[i] = root.imag();
+    }
+    const double * low_re = w_.re.data() + n / 2;
+    const double * low_im = w_.im.data() + n / 2;
+
+    transposeMatrix( in, scratch, columns, rows, pool );
+
+    pool.parallelFor( rows, [&]( size_t j1 ) {
+        double * re = scratch.re.data() + j1 * columns;
+        double * im = scratch.im.data() + j1 * columns;
+        executeRow( re, im, columns );
+
+        // w_n^(j1 k2) = w_n^(j1 k) * w_n^(j1 r) for k2 = k + r, r < 8: one
+        // table lookup per 8 elements, the inner loop vectorizes
+        double step_re[8], step_im[8];
+        for ( size_t r = 0; r < 8; r++ ) {
+            size_t m = j1 * r;
+            step_re[r] = low_re[m & ( columns - 1 )] * high.re[m >> shift] - low_im[m & ( columns - 1 )] * high.im[m >> shift];
+            step_im[r] = low_re[m & ( columns - 1 )] * high.im[m >> shift] + low_im[m & ( columns - 1 )] * high.re[m >> shift];
+        }
+        for ( size_t k = 0; k < columns; k += 8 ) {
+            size_t m = j1 * k;
+            size_t l = m & ( columns - 1 ), h = m >> shift;
+            double base_re = low_re[l] * high.re[h] - low_im[l] * high.im[h];
+            double base_im = low_re[l] * high.im[h] + low_im[l] * high.re[h];
+
+            for ( size_t r = 0; r < 8; r++ ) {
+                double cr = base_re * step_re[r] - base_im * step_im[r];
+                double ci = base_re * step_im[r] + base_im * step_re[r];
+                double xr = re[k + r];
+                re[k + r] = xr * cr - im[k + r] * ci;
+                im[k + r] = xr * ci + im[k + r] * cr;
+            }
+        }
+    } );
+
+    transposeMatrix( scratch, out, rows, columns, pool );
+
+    pool.parallelFor( columns, [&]( size_t k2 ) {
+        executeRow( out.re.data() + k2 * rows, out.im.data() + k2 * rows, rows );
+    } );
+
+    transposeMatrix( out, scratch, columns, rows, pool );
+    out.re.swap( scratch.re );
+    out.im.swap( scratch.im );
+}
+
+void FFTPlan::execute( const SplitComplex & in, SplitComplex & out ) const
+{
+    if ( in.size() >= FFT_FOUR_STEP_SIZE ) {
+        executeFourStep( in, out );
+        return;
+    }
+    permute( in, out );
+    makeButterflyPasses( out.re.data(), out.im.data(), out.size(), w_ );
+}
+
+// Conjugate roots give the same values as the forward transform with
+// reversed order of out[1..n-1]
+void FFTPlan::executeInverse( const SplitComplex & in, SplitComplex & out ) const
+{
+    execute( in, out );
+    std::reverse( out.re.begin() + 1, out.re.end() );
+    std::reverse( out.im.begin() + 1, out.im.end() );
+
+    double scale = 1.0 / out.size();
+    for ( size_t i = 0; i < out.size(); i++ ) {
+        out.re[i] *= scale;
+        out.im[i] *= scale;
+    }
+}
+
+const FFTPlan & FFTPlan::get( size_t n )
+{
+    static std::mutex mutex;
+    static std::map <size_t, std::unique_ptr <FFTPlan>> plans;
+
+    std::lock_guard <std::mutex> lock( mutex );
+    std::unique_ptr <FFTPlan> & plan = plans[n];
+    if ( !plan ) {
+        plan.reset( new FFTPlan( n ) );
+    }
+    return *plan;
+}
+
+// a goes to the real part and b, multiplied by scale_b, to the imaginary
+// one: since both are real, one transform gives spectra of both. p is
+// resized to n, keeping its capacity
+void makePackedComplex( const std::vector<int> & a, const std::vector<int> & b, size_t n, double scale_b, SplitComplex & p )
+{
+    p.re.assign( n, 0.0 );
+    p.im.assign( n, 0.0 );
+    for ( size_t i = 0; i < a.size(); i++ ) {
+        p.re[i] = a[i];
+    }
+    for ( size_t i = 0; i < b.size(); i++ ) {
+        p.im[i] = b[i] * scale_b;
+    }
+}
+
+double findSquaredNorm( const std::vector<int> & a )
+{
+    double norm = 0.0;
+    for ( size_t i = 0; i < a.size(); i++ ) {
+        norm += static_cast <double> ( a[i] ) * a[i];
+    }
+    return norm;
+}
+
+// Bound for the rounding error of a double convolution of vectors with
+// norms norm_a and norm_b and transform size n: eps * log n * |a|_2 * |b|_2.
+// On random and on constant inputs the measured error stays at least
+// 6 times below it
+double estimateFFTError( double norm_a, double norm_b, size_t n )
+{
+    return DBL_EPSILON * log2( static_cast <double> ( n ) ) * norm_a * norm_b;
+}
+
+double estimateFFTError( const std::vector<int> & a, const std::vector<int> & b, size_t n )
+{
+    return estimateFFTError( sqrt( findSquaredNorm( a ) ), sqrt( findSquaredNorm( b ) ), n );
+}
+
+// Spectra A and B of real vectors packed into p = a + ib, at index k.
+// With X = P[k] and Y = conj(P[n - k]): A[k] = (X + Y) / 2, B[k] = (X - Y) / 2i
+inline void unpackSpectra( const SplitComplex & p, size_t k, double & ar, double & ai, double & br, double & bi )
+{
+    size_t r = ( p.size() - k ) & ( p.size() - 1 );
+    double xr = p.re[k], xi = p.im[k];
+    double yr = p.re[r], yi = -p.im[r];
+
+    ar = ( xr + yr ) / 2;
+    ai = ( xi + yi ) / 2;
+    br = ( xi - yi ) / 2;
+    bi = ( yr - xr ) / 2;
+}
+
+// Inverts the spectrum q of a real vector c of size n with a complex
+// transform of size n / 2: z[m] = c[2m] + i c[2m + 1] has spectrum E + iO,
+// where E[k] = (Q[k] + Q[k + n/2]) / 2 and O[k] = (Q[k] - Q[k + n/2]) / 2 * w^-k
+// are spectra of even and odd elements of c. z replaces q, so afterwards
+// q.re[m] = c[2m] and q.im[m] = c[2m + 1]
+void makeRealInverseFFT( SplitComplex & q, const FFTPlan & plan )
+{
+    const SplitComplex & w = plan.twiddles();
+    size_t half = q.size() / 2;
+    if ( half == 0 ) {
+        return;
+    }
+
+    for ( size_t k = 0; k < half; k++ ) {
+        double even_re = ( q.re[k] + q.re[k + half] ) / 2;
+        double even_im = ( q.im[k] + q.im[k + half] ) / 2;
+        double dr = ( q.re[k] - q.re[k + half] ) / 2;
+        double di = ( q.im[k] - q.im[k + half] ) / 2;
+        double odd_re = dr * w.re[half + k] + di * w.im[half + k];
+        double odd_im = di * w.re[half + k] - dr * w.im[half + k];
+
+        q.re[k] = even_re - odd_im;
+        q.im[k] = even_im + odd_re;
+    }
+    q.re.resize( half );
+    q.im.resize( half );
+
+    // A plan for n serves size n / 2 as well
+    plan.executeInverse( q, q );
+}
+
+// Largest distance of values from the nearest integer
+class RoundingTracker
+{
+
+public:
+
+    RoundingTracker();
+
+    long long round( double );
+    long long round( long double );
+    double error() const;
+
+
+private:
+
+    // Class fields
+    double error_;
+};
+
+RoundingTracker::RoundingTracker() : error_( 0.0 )
+{
+}
+
+inline long long RoundingTracker::round( double x )
+{
+    double rounded = nearbyint( x );
+    error_ = std::max( error_, fabs( x - rounded ) );
+    return llround( rounded );
+}
+
+inline long long RoundingTracker::round( long double x )
+{
+    long double rounded = nearbyintl( x );
+    error_ = std::max( error_, static_cast <double> ( fabsl( x - rounded ) ) );
+    return llroundl( rounded );
+}
+
+double RoundingTracker::error() const
+{
+    return error_;
+}
+
+// Product of a and b computed with double transforms of size n, without
+// any checks; results are rounded to the nearest integer, the largest
+// rounding distance goes to rounding_error. a and b share one forward
+// transform, and the real product is inverted at half size
+std::vector <long long> makeDoubleConvolution( const std::vector<int> & a, const std::vector<int> & b, size_t n, const FFTPlan & plan,
+                                               double * rounding_error = nullptr )
+{
+    // b is scaled by a power of two (so, exactly) to get close norms of the
+    // packed parts, otherwise the larger one would dominate rounding errors
+    double norm_a = findSquaredNorm( a ), norm_b = findSquaredNorm( b );
+    int exponent = 0;
+    if ( norm_a > 0.0 && norm_b > 0.0 ) {
+        exponent = static_cast <int> ( lround( log2( norm_a / norm_b ) / 2 ) );
+    }
+
+    SplitComplex & p = findScratch( 0 );
+    makePackedComplex( a, b, n, ldexp( 1.0, exponent ), p );
+    plan.execute( p, p );
+
+    // a and b are real, so A[n - k] = conj(A[k]), the same holds for B
+    // and for the product: only a half of the products is computed
+    for ( size_t k = 0; 2 * k <= n; k++ ) {
+        size_t r = ( n - k ) & ( n - 1 );
+        double ar, ai, br, bi;
+        unpackSpectra( p, k, ar, ai, br, bi );
+
+        double re = ar * br - ai * bi;
+        double im = ar * bi + ai * br;
+        p.re[r] = re;
+        p.im[r] = -im;
+        p.re[k] = re;
+        p.im[k] = im;
+    }
+
+    makeRealInverseFFT( p, plan );
+
+    std::vector <long long> result( n );
+    RoundingTracker tracker;
+    double scale = ldexp( 1.0, -exponent );
+    for ( size_t i = 0; 2 * i + 1 < n; i++ ) {
+        result[2 * i] = tracker.round( p.re[i] * scale );
+        result[2 * i + 1] = tracker.round( p.im[i] * scale );
+    }
+    if ( n == 1 ) {
+        result[0] = tracker.round( p.re[0] * scale );
+    }
+    if ( rounding_error != nullptr ) {
+        *rounding_error = tracker.error();
+    }
+    return result;
+}
+
+// Splits every coefficient into high * 2^FFT_SPLIT_BITS + low with low in
+// [-2^(FFT_SPLIT_BITS - 1), 2^(FFT_SPLIT_BITS - 1)), so both halves are small
+void splitCoefficients( const std::vector<int> & a, std::vector<int> & low, std::vector<int> & high )
+{
+    const long long base = 1LL << FFT_SPLIT_BITS;
+
+    low.resize( a.size() );
+    high.resize( a.size() );
+    for ( size_t i = 0; i < a.size(); i++ ) {
+        long long value = a[i];
+        long long rest = ( ( value % base ) + base + base / 2 ) % base - base / 2;
+        low[i] = static_cast <int> ( rest );
+        high[i] = static_cast <int> ( ( value - rest ) / base );
+    }
+}
+
+// low + middle * 2^FFT_SPLIT_BITS + high * 2^(2 * FFT_SPLIT_BITS), wraps
+// modulo 2^64 like the rest of integer arithmetic
+std::vector <long long> joinSplitProducts( const std::vector<long long> & low, const std::vector<long long> & middle, const std::vector<long long> & high )
+{
+    std::vector <long long> result( low.size() );
+    for ( size_t i = 0; i < low.size(); i++ ) {
+        unsigned long long value = static_cast <unsigned long long> ( high[i] );
+        value = ( value << FFT_SPLIT_BITS ) + static_cast <unsigned long long> ( middle[i] );
+        value = ( value << FFT_SPLIT_BITS ) + static_cast <unsigned long long> ( low[i] );
+        result[i] = static_cast <long long> ( value );
+    }
+    return result;
+}
+
+// Same as makeDoubleConvolution on split coefficients. Halves of a and of b
+// are packed together, so there are two forward transforms. Low and middle
+// products are real, so low + i * middle is inverted by one transform,
+// and the high product by a transform of half size
+std::vector <long long> makeDoubleSplitConvolution( const std::vector<int> & a, const std::vector<int> & b, size_t n, const FFTPlan & plan,
+                                                    double * rounding_error = nullptr )
+{
+    std::vector <int> a_low, a_high, b_low, b_high;
+    splitCoefficients( a, a_low, a_high );
+    splitCoefficients( b, b_low, b_high );
+
+    SplitComplex & pa = findScratch( 0 );
+    SplitComplex & pb = findScratch( 1 );
+    makePackedComplex( a_low, a_high, n, 1.0, pa );
+    makePackedComplex( b_low, b_high, n, 1.0, pb );
+
+    plan.execute( pa, pa );
+    plan.execute( pb, pb );
+
+    // low + i * middle goes to pa, high to pb. All three products are
+    // spectra of real vectors, so values at n - k are conjugate to those at k
+    for ( size_t k = 0; 2 * k <= n; k++ ) {
+        size_t r = ( n - k ) & ( n - 1 );
+        double xr, xi, yr, yi, ur, ui, vr, vi;
+        unpackSpectra( pa, k, xr, xi, yr, yi );
+        unpackSpectra( pb, k, ur, ui, vr, vi );
+
+        double low_re = xr * ur - xi * ui;
+        double low_im = xr * ui + xi * ur;
+        double middle_re = xr * vr - xi * vi + yr * ur - yi * ui;
+        double middle_im = xr * vi + xi * vr + yr * ui + yi * ur;
+        double high_re = yr * vr - yi * vi;
+        double high_im = yr * vi + yi * vr;
+
+        pa.re[r] = low_re + middle_im;
+        pa.im[r] = middle_re - low_im;
+        pb.re[r] = high_re;
+        pb.im[r] = -high_im;
+        pa.re[k] = low_re - middle_im;
+        pa.im[k] = low_im + middle_re;
+        pb.re[k] = high_re;
+        pb.im[k] = high_im;
+    }
+
+    plan.executeInverse( pa, pa );
+    makeRealInverseFFT( pb, plan );
+
+    std::vector <long long> parts[3];
+    for ( int k = 0; k < 3; k++ ) {
+        parts[k].resize( n );
+    }
+    RoundingTracker tracker;
+    for ( size_t i = 0; i < n; i++ ) {
+        parts[0][i] = tracker.round( pa.re[i] );
+        parts[1][i] = tracker.round( pa.im[i] );
+        parts[2][i] = tracker.round( i % 2 == 0 ? pb.re[i / 2] : pb.im[i / 2] );
+    }
+    if ( rounding_error != nullptr ) {
+        *rounding_error = tracker.error();
+    }
+
+    return joinSplitProducts( parts[0], parts[1], parts[2] );
+}
+
+// Product of a and b with the long double transform of size n
+std::vector <long long> makeLongDoubleConvolution( const std::vector<int> & a, const std::vector<int> & b, size_t n,
+                                                   double * rounding_error = nullptr )
+{
+    std::vector <cld> ca = makeComplexVector( a, n );
+    std::vector <cld> cb = makeComplexVector( b, n );
+
+    std::vector <cld> w = makeTwiddles( n );
+
+    makeGeneralFFT( ca, w );
+    makeGeneralFFT( cb, w );
+
+    for ( size_t i = 0; i < n; i++ ) {
+        ca[i] = multiplyComplex( ca[i], cb[i] );
+    }
+
+    makeGeneralInverseFFT( ca, w );
+
+    std::vector <long long> result( n );
+    RoundingTracker tracker;
+    for ( size_t i = 0; i < n; i++ ) {
+        result[i] = tracker.round( ca[i].real() );
+    }
+    if ( rounding_error != nullptr ) {
+        *rounding_error = tracker.error();
+    }
+    return result;
+}
+
+// Exact product modulo 2^64 by number theoretic transforms of size n
+// (ntt.h, included at the end of this file); empty for n above NTT_MAX_SIZE
+std::vector <long long> makeExactConvolution( const std::vector<int> & a, const std::vector<int> & b, size_t n );
+
+// Ways makeConvolution can compute a product, from the fastest
+enum FFTMethod
+{
+    DOUBLE_METHOD,
+    SPLIT_METHOD,
+    EXACT_METHOD,
+    LONG_DOUBLE_METHOD
+};
+
+// What makeConvolution (or convolve2d, or a transform of
+// multiplicatePolynomBatch) did for one product
+struct FFTDiagnostics
+{
+    size_t n;
+    double estimated_error;   // estimateFFTError of the plain double transform
+    double rounding_error;    // measured for the accepted result, 0 if exact
+    double rejected_error;    // largest one of rejected results, 0 if none
+    FFTMethod method;         // the method of the accepted result
+    int attempts;             // methods run, the accepted one included
+};
+
+// Called after every makeConvolution, convolve2d and transformed pair of
+// multiplicatePolynomBatch, from the thread that made it. Empty by default
+std::function <void ( const FFTDiagnostics & )> & currentFFTDiagnosticsHook()
+{
+    static std::function <void ( const FFTDiagnostics & )> hook;
+    return hook;
+}
+
+std::vector <long long> makeSplitLongDoubleConvolution( const std::vector<int> & a, const std::vector<int> & b, size_t n, double * rounding_error )
+{
+    std::vector <int> a_low, a_high, b_low, b_high;
+    splitCoefficients( a, a_low, a_high );
+    splitCoefficients( b, b_low, b_high );
+
+    double errors[4];
+    std::vector <long long> middle = makeLongDoubleConvolution( a_low, b_high, n, &errors[0] );
+    std::vector <long long> other = makeLongDoubleConvolution( a_high, b_low, n, &errors[1] );
+    for ( size_t i = 0; i < n; i++ ) {
+        middle[i] += other[i];
+    }
+
+    std::vector <long long> low = makeLongDoubleConvolution( a_low, b_low, n, &errors[2] );
+    std::vector <long long> high = makeLongDoubleConvolution( a_high, b_high, n, &errors[3] );
+    *rounding_error = *std::max_element( errors, errors + 4 );
+    return joinSplitProducts( low, middle, high );
+}
+
+// Product of a and b modulo 2^64 with transforms of size n. The plain
+// double transform is used when its rounding can be trusted, otherwise
+// coefficients are split in halves. Rounding of every double result is
+// measured as well, and a result further than FFT_ROUNDING_LIMIT from
+// integers is not trusted either: then the next method is tried, down to
+// exact number theoretic transforms (long double ones for sizes above
+// NTT_MAX_SIZE). The outcome goes to currentFFTDiagnosticsHook()
+std::vector <long long> makeConvolution( const std::vector<int> & a, const std::vector<int> & b, size_t n )
+{
+    FFTDiagnostics diagnostics;
+    diagnostics.n = n;
+    diagnostics.estimated_error = estimateFFTError( a, b, n );
+    diagnostics.rounding_error = 0.0;
+    diagnostics.rejected_error = 0.0;
+    diagnostics.attempts = 0;
+
+    std::vector <long long> result;
+    auto accept = [&]( FFTMethod method ) {
+        diagnostics.method = method;
+        if ( currentFFTDiagnosticsHook() ) {
+            currentFFTDiagnosticsHook()( diagnostics );
+        }
+    };
+
+    if ( diagnostics.estimated_error <= FFT_SAFE_ERROR ) {
+        diagnostics.attempts++;
+        result = makeDoubleConvolution( a, b, n, FFTPlan::get( n ), &diagnostics.rounding_error );
+        if ( diagnostics.rounding_error <= FFT_ROUNDING_LIMIT ) {
+            accept( DOUBLE_METHOD );
+            return result;
+        }
+        diagnostics.rejected_error = diagnostics.rounding_error;
+    }
+
+    std::vector <int> a_low, a_high, b_low, b_high;
+    splitCoefficients( a, a_low, a_high );
+    splitCoefficients( b, b_low, b_high );
+
+    // Halves are packed together, so errors depend on norms of the packs
+    double split_error = estimateFFTError( sqrt( findSquaredNorm( a_low ) + findSquaredNorm( a_high ) ),
+                                           sqrt( findSquaredNorm( b_low ) + findSquaredNorm( b_high ) ), n );
+
+    if ( split_error <= FFT_SAFE_ERROR ) {
+        diagnostics.attempts++;
+        result = makeDoubleSplitConvolution( a, b, n, FFTPlan::get( n ), &diagnostics.rounding_error );
+        if ( diagnostics.rounding_error <= FFT_ROUNDING_LIMIT ) {
+            accept( SPLIT_METHOD );
+            return result;
+        }
+        diagnostics.rejected_error = std::max( diagnostics.rejected_error, diagnostics.rounding_error );
+    }
+
+    result = makeExactConvolution( a, b, n );
+    if ( !result.empty() ) {
+        diagnostics.attempts++;
+        diagnostics.rounding_error = 0.0;
+        accept( EXACT_METHOD );
+        return result;
+    }
+
+    diagnostics.attempts++;
+    result = makeSplitLongDoubleConvolution( a, b, n, &diagnostics.rounding_error );
+    accept( LONG_DOUBLE_METHOD );
+    return result;
+}
+
+std::vector <int> multiplicatePolynoms( const std::vector <int> & a, const std::vector <int> & b )
+{
+    size_t n = findUpperDegreeOfTwo( std::max( a.size(), b.size() ) );
+    n *= 2;
+
+    std::vector <long long> c = makeConvolution( a, b, n );
+
+    return std::vector <int> ( c.begin(), c.end() );
+}
+
+// Exact transforms for makeConvolution. ntt.h includes this file first,
+// so it sees everything above whichever of the two is included first
+#include "ntt.h"
+
+#endif /* fft_h */
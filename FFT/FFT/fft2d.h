@@ -0,0 +1,386 @@
+#ifndef fft2d_h
+#define fft2d_h
+
+#include <vector>
+#include <iostream>
+
+#include "fft.h"
+
+//
+// Convolution of integer grids by row-column transforms
+//
+
+// Smallest side of tiles when a grid is convolved with a small kernel
+const size_t FFT_2D_TILE_SIZE = 512;
+
+// Row-major integer grid
+struct IntGrid
+{
+    std::vector <int> values;
+    size_t rows;
+    size_t columns;
+
+    IntGrid() : rows( 0 ), columns( 0 )
+    {
+    }
+
+    IntGrid( size_t rows, size_t columns ) : values( rows * columns, 0 ), rows( rows ), columns( columns )
+    {
+    }
+};
+
+double findSquaredNorm( const IntGrid & a )
+{
+    return findSquaredNorm( a.values );
+}
+
+// Transforms every row of length columns in p, rows are shared among the threads
+void makeRowTransforms( SplitComplex & p, size_t rows, size_t columns, const FFTPlan & plan, ThreadPool & pool )
+{
+    pool.parallelFor( rows, [&]( size_t i ) {
+        plan.executeRow( p.re.data() + i * columns, p.im.data() + i * columns, columns );
+    } );
+}
+
+// Forward transform of the rows x columns grid in p: rows, blocked
+// transpose to q, rows again. The spectrum is left transposed in q, as
+// products need no particular order
+void makeForward2DFFT( SplitComplex & p, SplitComplex & q, size_t rows, size_t columns, const FFTPlan & plan, ThreadPool & pool )
+{
+    makeRowTransforms( p, rows, columns, plan, pool );
+    transposeMatrix( p, q, rows, columns, pool );
+    makeRowTransforms( q, columns, rows, plan, pool );
+}
+
+// The same transform from the transposed layout in q back to p. Applied
+// to conj(X) it gives conj(rows * columns * x), x the inverse transform
+// of X, so with two transposes in total a product is back in order
+void makeBackward2DFFT( SplitComplex & q, SplitComplex & p, size_t rows, size_t columns, const FFTPlan & plan, ThreadPool & pool )
+{
+    makeRowTransforms( q, columns, rows, plan, pool );
+    transposeMatrix( q, p, columns, rows, pool );
+    makeRowTransforms( p, rows, columns, plan, pool );
+}
+
+// Full convolution of a and b (a.rows + b.rows - 1 by a.columns + b.columns - 1)
+// with double transforms of rows x columns, without any checks; the
+// largest rounding distance goes to rounding_error. a and b share one
+// transform, packed as a + i * b like in makeDoubleConvolution
+std::vector <long long> makeDouble2DConvolution( const IntGrid & a, const IntGrid & b, size_t rows, size_t columns,
+                                                 double * rounding_error = nullptr )
+{
+    const FFTPlan & plan = FFTPlan::get( std::max( rows, columns ) );
+    std::shared_ptr <ThreadPool> shared_pool = findFFTThreadPool();
+    ThreadPool & pool = *shared_pool;
+
+    double norm_a = findSquaredNorm( a ), norm_b = findSquaredNorm( b );
+    int exponent = 0;
+    if ( norm_a > 0.0 && norm_b > 0.0 ) {
+        exponent = static_cast <int> ( lround( log2( norm_a / norm_b ) / 2 ) );
+    }
+    double scale = ldexp( 1.0, exponent );
+
+    SplitComplex & p = findScratch( 0 );
+    SplitComplex & q = findScratch( 1 );
+    p.re.assign( rows * columns, 0.0 );
+    p.im.assign( rows * columns, 0.0 );
+    q.re.resize( rows * columns );
+    q.im.resize( rows * columns );
+
+    for ( size_t i = 0; i < a.rows; i++ ) {
+        for ( size_t j = 0; j < a.columns; j++ ) {
+            p.re[i * columns + j] = a.values[i * a.columns + j];
+        }
+    }
+    for ( size_t i = 0; i < b.rows; i++ ) {
+        for ( size_t j = 0; j < b.columns; j++ ) {
+            p.im[i * columns + j] = b.values[i * b.columns + j] * scale;
+        }
+    }
+
+    makeForward2DFFT( p, q, rows, columns, plan, pool );
+
+    // q[k2 * rows + k1] = P[k1][k2]. Spectra of real grids are conjugate at
+    // k and -k, so the pair is done at once, as in unpackSpectra. The
+    // product is stored conjugated for makeBackward2DFFT
+    pool.parallelFor( columns / 2 + 1, [&]( size_t k2 ) {
+        size_t r2 = ( columns - k2 ) & ( columns - 1 );
+        for ( size_t k1 = 0; k1 < rows; k1++ ) {
+            size_t r1 = ( rows - k1 ) & ( rows - 1 );
+            if ( k2 == r2 && k1 > r1 ) {
+                continue;
+            }
+
+            size_t k = k2 * rows + k1, r = r2 * rows + r1;
+            double xr = q.re[k], xi = q.im[k];
+            double yr = q.re[r], yi = -q.im[r];
+            double ar = ( xr + yr ) / 2, ai = ( xi + yi ) / 2;
+            double br = ( xi - yi ) / 2, bi = ( yr - xr ) / 2;
+
+            double re = ar * br - ai * bi;
+            double im = ar * bi + ai * br;
+            q.re[k] = re;
+            q.im[k] = -im;
+            q.re[r] = re;
+            q.im[r] = im;
+        }
+    } );
+
+    makeBackward2DFFT( q, p, rows, columns, plan, pool );
+
+    size_t c_rows = a.rows + b.rows - 1, c_columns = a.columns + b.columns - 1;
+    std::vector <long long> result( c_rows * c_columns );
+    RoundingTracker tracker;
+    double inverse = ldexp( 1.0 / ( static_cast <double> ( rows ) * columns ), -exponent );
+    for ( size_t i = 0; i < c_rows; i++ ) {
+        for ( size_t j = 0; j < c_columns; j++ ) {
+            result[i * c_columns + j] = tracker.round( p.re[i * columns + j] * inverse );
+        }
+    }
+    if ( rounding_error != nullptr ) {
+        *rounding_error = tracker.error();
+    }
+    return result;
+}
+
+// Full convolution of a with a small kernel b by overlap-add: a is cut
+// into tiles that convolve with b within rows x columns transforms. b is
+// transformed once; two tiles are packed as x + i * y, and since the
+// kernel is real, the inverse transform of (X + iY) B is x * b + i (y * b).
+// The largest rounding distance over all tiles goes to rounding_error
+std::vector <long long> makeTiled2DConvolution( const IntGrid & a, const IntGrid & b, size_t rows, size_t columns,
+                                                double * rounding_error = nullptr )
+{
+    const FFTPlan & plan = FFTPlan::get( std::max( rows, columns ) );
+    std::shared_ptr <ThreadPool> shared_pool = findFFTThreadPool();
+    ThreadPool & pool = *shared_pool;
+
+    size_t n = rows * columns;
+    size_t step_rows = rows - b.rows + 1, step_columns = columns - b.columns + 1;
+    size_t tile_rows = ( a.rows + step_rows - 1 ) / step_rows;
+    size_t tile_columns = ( a.columns + step_columns - 1 ) / step_columns;
+    size_t c_rows = a.rows + b.rows - 1, c_columns = a.columns + b.columns - 1;
+
+    SplitComplex & p = findScratch( 0 );
+    SplitComplex & q = findScratch( 1 );
+    p.re.assign( n, 0.0 );
+    p.im.assign( n, 0.0 );
+    q.re.resize( n );
+    q.im.resize( n );
+
+    for ( size_t i = 0; i < b.rows; i++ ) {
+        for ( size_t j = 0; j < b.columns; j++ ) {
+            p.re[i * columns + j] = b.values[i * b.columns + j];
+        }
+    }
+    makeForward2DFFT( p, q, rows, columns, plan, pool );
+
+    SplitComplex kernel;
+    kernel.re.swap( q.re );
+    kernel.im.swap( q.im );
+    q.re.resize( n );
+    q.im.resize( n );
+
+    std::vector <unsigned long long> sum( c_rows * c_columns, 0 );
+    RoundingTracker tracker;
+    double inverse = 1.0 / static_cast <double> ( n );
+
+    for ( size_t tile = 0; tile < tile_rows * tile_columns; tile += 2 ) {
+        p.re.assign( n, 0.0 );
+        p.im.assign( n, 0.0 );
+        for ( size_t part = 0; part < 2 && tile + part < tile_rows * tile_columns; part++ ) {
+            std::vector <double> & target = ( part == 0 ? p.re : p.im );
+            size_t first_row = ( ( tile + part ) / tile_columns ) * step_rows;
+            size_t first_column = ( ( tile + part ) % tile_columns ) * step_columns;
+            size_t row_end = std::min( a.rows, first_row + step_rows );
+            size_t column_end = std::min( a.columns, first_column + step_columns );
+            for ( size_t i = first_row; i < row_end; i++ ) {
+                for ( size_t j = first_column; j < column_end; j++ ) {
+                    target[( i - first_row ) * columns + j - first_column] = a.values[i * a.columns + j];
+                }
+            }
+        }
+
+        makeForward2DFFT( p, q, rows, columns, plan, pool );
+        pool.parallelFor( columns, [&]( size_t k2 ) {
+            for ( size_t k = k2 * rows; k < ( k2 + 1 ) * rows; k++ ) {
+                double re = q.re[k] * kernel.re[k] - q.im[k] * kernel.im[k];
+                double im = q.re[k] * kernel.im[k] + q.im[k] * kernel.re[k];
+                q.re[k] = re;
+                q.im[k] = -im;
+            }
+        } );
+        makeBackward2DFFT( q, p, rows, columns, plan, pool );
+
+        // p.re is the first tile, -p.im the second one
+        for ( size_t part = 0; part < 2 && tile + part < tile_rows * tile_columns; part++ ) {
+            const std::vector <double> & source = ( part == 0 ? p.re : p.im );
+            double scale = ( part == 0 ? inverse : -inverse );
+            size_t first_row = ( ( tile + part ) / tile_columns ) * step_rows;
+            size_t first_column = ( ( tile + part ) % tile_columns ) * step_columns;
+            size_t row_end = std::min( c_rows, first_row + rows );
+            size_t column_end = std::min( c_columns, first_column + columns );
+            for ( size_t i = first_row; i < row_end; i++ ) {
+                for ( size_t j = first_column; j < column_end; j++ ) {
+                    double value = source[( i - first_row ) * columns + j - first_column] * scale;
+                    sum[i * c_columns + j] += static_cast <unsigned long long> ( tracker.round( value ) );
+                }
+            }
+        }
+    }
+
+    if ( rounding_error != nullptr ) {
+        *rounding_error = tracker.error();
+    }
+    return std::vector <long long> ( sum.begin(), sum.end() );
+}
+
+// Side of tiles for makeTiled2DConvolution with kernel b: at least
+// FFT_2D_TILE_SIZE and four times the kernel, so that overlaps between
+// tiles stay small
+size_t find2DTileSize( const IntGrid & b )
+{
+    return std::max( FFT_2D_TILE_SIZE, 4 * findUpperDegreeOfTwo( std::max( b.rows, b.columns ) ) );
+}
+
+void splitCoefficients( const IntGrid & a, IntGrid & low, IntGrid & high )
+{
+    low.rows = high.rows = a.rows;
+    low.columns = high.columns = a.columns;
+    splitCoefficients( a.values, low.values, high.values );
+}
+
+// Exact convolution of grids a and b modulo 2^64. Rows of both are laid
+// out with the width of the result, so the 2D product is a 1D one, done
+// by makeExactConvolution for bands of rows of a as long as the transform
+// allows. Empty (with a message) if even one row of a with the whole
+// kernel b does not fit into NTT_MAX_SIZE
+std::vector <long long> makeExact2DConvolution( const IntGrid & a, const IntGrid & b )
+{
+    size_t width = a.columns + b.columns - 1;
+    size_t c_rows = a.rows + b.rows - 1;
+    if ( b.rows * width > NTT_MAX_SIZE || b.values.size() > NTT_MAX_SIZE / 2 ) {
+        std::cerr << "Grids are too large for exact transforms!";
+        return std::vector <long long> ();
+    }
+
+    std::vector <int> kernel( b.rows * width, 0 );
+    for ( size_t i = 0; i < b.rows; i++ ) {
+        std::copy( b.values.begin() + i * b.columns, b.values.begin() + ( i + 1 ) * b.columns, kernel.begin() + i * width );
+    }
+
+    size_t band = std::min( a.rows, NTT_MAX_SIZE / width - b.rows + 1 );
+    std::vector <unsigned long long> sum( c_rows * width, 0 );
+    std::vector <int> part;
+    for ( size_t first = 0; first < a.rows; first += band ) {
+        size_t height = std::min( band, a.rows - first );
+        part.assign( height * width, 0 );
+        for ( size_t i = 0; i < height; i++ ) {
+            std::copy( a.values.begin() + ( first + i ) * a.columns, a.values.begin() + ( first + i + 1 ) * a.columns,
+                       part.begin() + i * width );
+        }
+
+        size_t length = ( height + b.rows - 1 ) * width;
+        std::vector <long long> product = makeExactConvolution( part, kernel, findUpperDegreeOfTwo( length ) );
+        for ( size_t k = 0; k < length; k++ ) {
+            sum[first * width + k] += static_cast <unsigned long long> ( product[k] );
+        }
+    }
+
+    return std::vector <long long> ( sum.begin(), sum.end() );
+}
+
+// Full convolution of grids a and b, (a.rows + b.rows - 1) x (a.columns +
+// b.columns - 1) stored by rows, modulo 2^64 like makeConvolution. b is
+// the kernel: when it is small against a, a goes by tiles. Correlation
+// with a kernel is convolution with the kernel flipped in both
+// directions. When rounding of a plain double transform cannot be
+// trusted, coefficients are split in halves as in makeConvolution and
+// four products of halves are joined; when even that cannot be trusted,
+// makeExact2DConvolution is used. As in makeConvolution, a double result
+// further than FFT_ROUNDING_LIMIT from integers is not trusted either,
+// and the outcome goes to currentFFTDiagnosticsHook(). Empty if the grids
+// are too large for exact transforms
+std::vector <long long> convolve2d( const IntGrid & a, const IntGrid & b )
+{
+    if ( a.values.empty() || b.values.empty() ) {
+        return std::vector <long long> ();
+    }
+
+    size_t rows = findUpperDegreeOfTwo( a.rows + b.rows - 1 );
+    size_t columns = findUpperDegreeOfTwo( a.columns + b.columns - 1 );
+    size_t tile = find2DTileSize( b );
+    bool tiled = ( rows > tile || columns > tile );
+    if ( tiled ) {
+        rows = std::min( rows, tile );
+        columns = std::min( columns, tile );
+    }
+
+    auto convolve = [&]( const IntGrid & x, const IntGrid & y, double & error ) {
+        double rounding_error;
+        std::vector <long long> result = ( tiled ? makeTiled2DConvolution( x, y, rows, columns, &rounding_error )
+                                                 : makeDouble2DConvolution( x, y, rows, columns, &rounding_error ) );
+        error = std::max( error, rounding_error );
+        return result;
+    };
+
+    // Tiles of a are not larger than a, so the bound holds for them too.
+    // A 1 x 1 transform is still a rounded product, so n is at least 2
+    FFTDiagnostics diagnostics;
+    diagnostics.n = std::max( rows * columns, size_t( 2 ) );
+    diagnostics.estimated_error = estimateFFTError( sqrt( findSquaredNorm( a ) ), sqrt( findSquaredNorm( b ) ), diagnostics.n );
+    diagnostics.rounding_error = 0.0;
+    diagnostics.rejected_error = 0.0;
+    diagnostics.attempts = 0;
+
+    std::vector <long long> result;
+    auto accept = [&]( FFTMethod method ) {
+        diagnostics.method = method;
+        if ( currentFFTDiagnosticsHook() ) {
+            currentFFTDiagnosticsHook()( diagnostics );
+        }
+    };
+
+    if ( diagnostics.estimated_error <= FFT_SAFE_ERROR ) {
+        diagnostics.attempts++;
+        result = convolve( a, b, diagnostics.rounding_error );
+        if ( diagnostics.rounding_error <= FFT_ROUNDING_LIMIT ) {
+            accept( DOUBLE_METHOD );
+            return result;
+        }
+        diagnostics.rejected_error = diagnostics.rounding_error;
+    }
+
+    IntGrid a_low, a_high, b_low, b_high;
+    splitCoefficients( a, a_low, a_high );
+    splitCoefficients( b, b_low, b_high );
+
+    double split_error = estimateFFTError( sqrt( std::max( findSquaredNorm( a_low ), findSquaredNorm( a_high ) ) ),
+                                           sqrt( std::max( findSquaredNorm( b_low ), findSquaredNorm( b_high ) ) ), diagnostics.n );
+    if ( split_error <= FFT_SAFE_ERROR ) {
+        diagnostics.attempts++;
+        diagnostics.rounding_error = 0.0;
+        std::vector <long long> middle = convolve( a_low, b_high, diagnostics.rounding_error );
+        std::vector <long long> other = convolve( a_high, b_low, diagnostics.rounding_error );
+        for ( size_t i = 0; i < middle.size(); i++ ) {
+            middle[i] = static_cast <long long> ( static_cast <unsigned long long> ( middle[i] ) + static_cast <unsigned long long> ( other[i] ) );
+        }
+        std::vector <long long> low = convolve( a_low, b_low, diagnostics.rounding_error );
+        std::vector <long long> high = convolve( a_high, b_high, diagnostics.rounding_error );
+        if ( diagnostics.rounding_error <= FFT_ROUNDING_LIMIT ) {
+            accept( SPLIT_METHOD );
+            return joinSplitProducts( low, middle, high );
+        }
+        diagnostics.rejected_error = std::max( diagnostics.rejected_error, diagnostics.rounding_error );
+    }
+
+    result = makeExact2DConvolution( a, b );
+    if ( !result.empty() ) {
+        diagnostics.attempts++;
+        diagnostics.rounding_error = 0.0;
+        accept( EXACT_METHOD );
+    }
+    return result;
+}
+
+#endif /* fft2d_h */
@@ -0,0 +1,86 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "fft2d.h"
+
+template <class Function>
+long long measure(Function function)
+{
+    using namespace std::chrono;
+
+    auto start = high_resolution_clock::now();
+    function();
+    auto finish = high_resolution_clock::now();
+    return duration_cast<milliseconds>(finish - start).count();
+}
+
+IntGrid randomGrid(size_t rows, size_t columns, int max_value, std::mt19937 & gen)
+{
+    IntGrid a(rows, columns);
+    for (size_t i = 0; i < a.values.size(); i++) {
+        a.values[i] = static_cast<int>(gen() % (2u * max_value + 1)) - max_value;
+    }
+    return a;
+}
+
+// Direct full convolution modulo 2^64, the kernel loop is innermost over
+// columns so that it vectorizes
+std::vector <long long> convolveDirect(const IntGrid & a, const IntGrid & b)
+{
+    size_t c_rows = a.rows + b.rows - 1, c_columns = a.columns + b.columns - 1;
+    std::vector <unsigned long long> c(c_rows * c_columns, 0);
+    for (size_t i = 0; i < a.rows; i++) {
+        for (size_t k = 0; k < b.rows; k++) {
+            unsigned long long * row = c.data() + (i + k) * c_columns;
+            for (size_t j = 0; j < a.columns; j++) {
+                unsigned long long x = static_cast<unsigned long long>(static_cast<long long>(a.values[i * a.columns + j]));
+                for (size_t l = 0; l < b.columns; l++) {
+                    row[j + l] += x * static_cast<unsigned long long>(static_cast<long long>(b.values[k * b.columns + l]));
+                }
+            }
+        }
+    }
+    return std::vector <long long> (c.begin(), c.end());
+}
+
+void printTime(long long time, bool correct)
+{
+    std::cout << "\t" << time << (correct ? "" : "(wrong)");
+}
+
+// Usage: fft2d_benchmark [grid side] [max direct kernel side]
+int main(int argc, char ** argv)
+{
+    size_t side = (argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2048);
+    size_t max_direct = (argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 33);
+
+    std::mt19937 gen(2019);
+
+    // Small values go through one packed double transform, large ones
+    // are split into halves
+    for (int max_value : {255, 1 << 30}) {
+        IntGrid a = randomGrid(side, side, max_value, gen);
+        std::cout << "\n" << side << "x" << side << " grid, |values| <= " << max_value << ", time in ms\nkernel\tconvolve2d\tdirect\n";
+
+        for (size_t kernel = 3; kernel <= 257; kernel = 2 * kernel - 1) {
+            IntGrid b = randomGrid(kernel, kernel, max_value, gen);
+            std::vector <long long> c, expected;
+
+            long long time = measure([&]() { c = convolve2d(a, b); });
+            std::cout << kernel << "x" << kernel;
+            if (kernel <= max_direct) {
+                long long direct_time = measure([&]() { expected = convolveDirect(a, b); });
+                printTime(time, c == expected);
+                std::cout << "\t" << direct_time << "\n";
+            } else {
+                printTime(time, true);
+                std::cout << "\t-\n";
+            }
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,448 @@
+#ifndef fft_batch_h
+#define fft_batch_h
+
+#include <vector>
+#include <map>
+#include <algorithm>
+
+#include "fft.h"
+
+//
+// Many independent small products at once
+//
+
+// Pairs where the shorter factor has at most FFT_BATCH_SCHOOLBOOK_SIZE
+// terms are multiplied directly, the rest by transforms grouped by size.
+// Pairs with coefficients too large for a plain double transform are
+// multiplied by Karatsuba up to FFT_BATCH_KARATSUBA_SIZE terms, where it
+// is still faster than the split transforms of makeConvolution
+const size_t FFT_BATCH_SCHOOLBOOK_SIZE = 32;
+const size_t FFT_BATCH_KARATSUBA_SIZE = 256;
+
+// Number of equally sized transforms done together, one per vector lane
+const size_t FFT_BATCH_LANES = 8;
+
+struct PolynomPair
+{
+    const int * a;
+    size_t a_size;
+    const int * b;
+    size_t b_size;
+
+    size_t productSize() const
+    {
+        return ( a_size == 0 || b_size == 0 ? 0 : a_size + b_size - 1 );
+    }
+};
+
+// c = a * b modulo 2^64, c has a_size + b_size - 1 elements
+void multiplySchoolbook( const int * a, size_t a_size, const int * b, size_t b_size, long long * c )
+{
+    // Unsigned sums wrap around instead of overflowing
+    unsigned long long * sum = reinterpret_cast <unsigned long long *> ( c );
+    std::fill( sum, sum + a_size + b_size - 1, 0 );
+    for ( size_t i = 0; i < a_size; i++ ) {
+        unsigned long long x = static_cast <unsigned long long> ( static_cast <long long> ( a[i] ) );
+        for ( size_t j = 0; j < b_size; j++ ) {
+            sum[i + j] += x * static_cast <unsigned long long> ( static_cast <long long> ( b[j] ) );
+        }
+    }
+}
+
+// c[0..2n-1) = a * b for a and b of n elements, modulo 2^64. Needs 4 * n + 64
+// elements of scratch: a = a0 + x^h a1, b = b0 + x^h b1, and the middle
+// part is (a0 + a1) (b0 + b1) - a0 b0 - a1 b1
+void makeKaratsuba( const unsigned long long * a, const unsigned long long * b, size_t n, unsigned long long * c, unsigned long long * scratch )
+{
+    if ( n <= FFT_BATCH_SCHOOLBOOK_SIZE ) {
+        std::fill( c, c + 2 * n - 1, 0 );
+        for ( size_t i = 0; i < n; i++ ) {
+            for ( size_t j = 0; j < n; j++ ) {
+                c[i + j] += a[i] * b[j];
+            }
+        }
+        return;
+    }
+
+    size_t h = n / 2, m = n - h;
+    unsigned long long * sum_a = scratch;
+    unsigned long long * sum_b = scratch + m;
+    unsigned long long * middle = scratch + 2 * m;
+    unsigned long long * rest = scratch + 4 * m;
+
+    for ( size_t i = 0; i < m; i++ ) {
+        sum_a[i] = ( i < h ? a[i] : 0 ) + a[h + i];
+        sum_b[i] = ( i < h ? b[i] : 0 ) + b[h + i];
+    }
+    makeKaratsuba( sum_a, sum_b, m, middle, rest );
+
+    std::fill( c + 2 * h - 1, c + 2 * n - 1, 0 );
+    makeKaratsuba( a, b, h, c, rest );
+    makeKaratsuba( a + h, b + h, m, c + 2 * h, rest );
+
+    for ( size_t i = 0; i + 1 < 2 * h; i++ ) {
+        middle[i] -= c[i];
+    }
+    for ( size_t i = 0; i + 1 < 2 * m; i++ ) {
+        middle[i] -= c[2 * h + i];
+    }
+    for ( size_t i = 0; i + 1 < 2 * m; i++ ) {
+        c[h + i] += middle[i];
+    }
+}
+
+// c = a * b modulo 2^64, factors are padded with zeros to the same length
+void multiplyKaratsuba( const int * a, size_t a_size, const int * b, size_t b_size, long long * c )
+{
+    static thread_local std::vector <unsigned long long> buffer;
+
+    size_t n = std::max( a_size, b_size );
+    if ( buffer.size() < 8 * n + 64 ) {
+        buffer.resize( 8 * n + 64 );
+    }
+    unsigned long long * x = buffer.data();
+    unsigned long long * y = x + n;
+    unsigned long long * product = y + n;
+    unsigned long long * scratch = product + 2 * n;
+
+    for ( size_t i = 0; i < n; i++ ) {
+        x[i] = ( i < a_size ? static_cast <unsigned long long> ( static_cast <long long> ( a[i] ) ) : 0 );
+        y[i] = ( i < b_size ? static_cast <unsigned long long> ( static_cast <long long> ( b[i] ) ) : 0 );
+    }
+
+    makeKaratsuba( x, y, n, product, scratch );
+
+    for ( size_t i = 0; i + 1 < a_size + b_size; i++ ) {
+        c[i] = static_cast <long long> ( product[i] );
+    }
+}
+
+double findSquaredNorm( const int * a, size_t size )
+{
+    double norm = 0.0;
+    for ( size_t i = 0; i < size; i++ ) {
+        norm += static_cast <double> ( a[i] ) * a[i];
+    }
+    return norm;
+}
+
+//
+// Transforms across the batch: element i of lane l is at i * FFT_BATCH_LANES + l,
+// so every butterfly does the same work with the same root on all lanes
+//
+
+void makeBatchButterfliesScalar( double * re, double * im, const double * wr, const double * wi, size_t n, size_t len )
+{
+    const size_t L = FFT_BATCH_LANES;
+
+    for ( size_t i = 0; i < n; i += 2 * len ) {
+        for ( size_t j = 0; j < len; j++ ) {
+            double cr = wr[len + j], ci = wi[len + j];
+            double * ur = re + ( i + j ) * L;
+            double * ui = im + ( i + j ) * L;
+            double * xr = re + ( i + j + len ) * L;
+            double * xi = im + ( i + j + len ) * L;
+            for ( size_t l = 0; l < L; l++ ) {
+                double vr = xr[l] * cr - xi[l] * ci;
+                double vi = xr[l] * ci + xi[l] * cr;
+                xr[l] = ur[l] - vr;
+                xi[l] = ui[l] - vi;
+                ur[l] += vr;
+                ui[l] += vi;
+            }
+        }
+    }
+}
+
+#if FFT_X86_KERNELS
+
+// Same pass, each row of eight lanes is two vectors
+__attribute__(( target( "avx2,fma" ) ))
+void makeBatchButterfliesAVX2( double * re, double * im, const double * wr, const double * wi, size_t n, size_t len )
+{
+    const size_t L = FFT_BATCH_LANES;
+
+    for ( size_t i = 0; i < n; i += 2 * len ) {
+        for ( size_t j = 0; j < len; j++ ) {
+            __m256d cr = _mm256_set1_pd( wr[len + j] );
+            __m256d ci = _mm256_set1_pd( wi[len + j] );
+            for ( size_t l = 0; l < L; l += 4 ) {
+                double * ur = re + ( i + j ) * L + l;
+                double * ui = im + ( i + j ) * L + l;
+                double * xr = re + ( i + j + len ) * L + l;
+                double * xi = im + ( i + j + len ) * L + l;
+                __m256d ar = _mm256_loadu_pd( xr ), ai = _mm256_loadu_pd( xi );
+                __m256d br = _mm256_loadu_pd( ur ), bi = _mm256_loadu_pd( ui );
+                __m256d vr = _mm256_fmsub_pd( ar, cr, _mm256_mul_pd( ai, ci ) );
+                __m256d vi = _mm256_fmadd_pd( ar, ci, _mm256_mul_pd( ai, cr ) );
+                _mm256_storeu_pd( ur, _mm256_add_pd( br, vr ) );
+                _mm256_storeu_pd( ui, _mm256_add_pd( bi, vi ) );
+                _mm256_storeu_pd( xr, _mm256_sub_pd( br, vr ) );
+                _mm256_storeu_pd( xi, _mm256_sub_pd( bi, vi ) );
+            }
+        }
+    }
+}
+
+// Same pass, each row of eight lanes is one vector
+__attribute__(( target( "avx512f" ) ))
+void makeBatchButterfliesAVX512( double * re, double * im, const double * wr, const double * wi, size_t n, size_t len )
+{
+    const size_t L = FFT_BATCH_LANES;
+
+    for ( size_t i = 0; i < n; i += 2 * len ) {
+        for ( size_t j = 0; j < len; j++ ) {
+            __m512d cr = _mm512_set1_pd( wr[len + j] );
+            __m512d ci = _mm512_set1_pd( wi[len + j] );
+            double * ur = re + ( i + j ) * L;
+            double * ui = im + ( i + j ) * L;
+            double * xr = re + ( i + j + len ) * L;
+            double * xi = im + ( i + j + len ) * L;
+            __m512d ar = _mm512_loadu_pd( xr ), ai = _mm512_loadu_pd( xi );
+            __m512d br = _mm512_loadu_pd( ur ), bi = _mm512_loadu_pd( ui );
+            __m512d vr = _mm512_fmsub_pd( ar, cr, _mm512_mul_pd( ai, ci ) );
+            __m512d vi = _mm512_fmadd_pd( ar, ci, _mm512_mul_pd( ai, cr ) );
+            _mm512_storeu_pd( ur, _mm512_add_pd( br, vr ) );
+            _mm512_storeu_pd( ui, _mm512_add_pd( bi, vi ) );
+            _mm512_storeu_pd( xr, _mm512_sub_pd( br, vr ) );
+            _mm512_storeu_pd( xi, _mm512_sub_pd( bi, vi ) );
+        }
+    }
+}
+
+#endif
+
+// Forward transforms of size n on all lanes at once, in place
+void makeBatchFFT( double * re, double * im, size_t n, const SplitComplex & w )
+{
+    const size_t L = FFT_BATCH_LANES;
+
+    for ( size_t i = 1, j = 0; i < n; i++ ) {
+        size_t bit = n >> 1;
+        for ( ; j & bit; bit >>= 1 ) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if ( i < j ) {
+            std::swap_ranges( re + i * L, re + ( i + 1 ) * L, re + j * L );
+            std::swap_ranges( im + i * L, im + ( i + 1 ) * L, im + j * L );
+        }
+    }
+
+    FFTKernel kernel = currentFFTKernel();
+    for ( size_t len = 1; len < n; len *= 2 ) {
+#if FFT_X86_KERNELS
+        if ( kernel == AVX512_KERNEL ) {
+            makeBatchButterfliesAVX512( re, im, w.re.data(), w.im.data(), n, len );
+            continue;
+        }
+        if ( kernel == AVX2_KERNEL ) {
+            makeBatchButterfliesAVX2( re, im, w.re.data(), w.im.data(), n, len );
+            continue;
+        }
+#else
+        (void) kernel;
+#endif
+        makeBatchButterfliesScalar( re, im, w.re.data(), w.im.data(), n, len );
+    }
+}
+
+// Products of up to FFT_BATCH_LANES pairs with transform size n, written
+// to output + offsets[k]; the largest rounding distance of lane k goes to
+// rounding_errors[k]. Same steps as makeDoubleConvolution, done on all
+// lanes at once: packed forward transform, product of the unpacked
+// spectra, half size inverse transform of the real product
+void makeBatchConvolution( const PolynomPair * const * pairs, const size_t * offsets, size_t count, size_t n, long long * output,
+                           double * rounding_errors )
+{
+    const size_t L = FFT_BATCH_LANES;
+    const SplitComplex & w = FFTPlan::get( n ).twiddles();
+
+    SplitComplex & p = findScratch( 0 );
+    p.re.assign( n * L, 0.0 );
+    p.im.assign( n * L, 0.0 );
+
+    int exponent[L] = {};
+    for ( size_t l = 0; l < count; l++ ) {
+        const PolynomPair & pair = *pairs[l];
+        double norm_a = findSquaredNorm( pair.a, pair.a_size );
+        double norm_b = findSquaredNorm( pair.b, pair.b_size );
+        if ( norm_a > 0.0 && norm_b > 0.0 ) {
+            exponent[l] = static_cast <int> ( lround( log2( norm_a / norm_b ) / 2 ) );
+        }
+
+        double scale = ldexp( 1.0, exponent[l] );
+        for ( size_t i = 0; i < pair.a_size; i++ ) {
+            p.re[i * L + l] = pair.a[i];
+        }
+        for ( size_t i = 0; i < pair.b_size; i++ ) {
+            p.im[i * L + l] = pair.b[i] * scale;
+        }
+    }
+
+    makeBatchFFT( p.re.data(), p.im.data(), n, w );
+
+    // Spectra of the real parts at k and n - k are conjugate, as in makeDoubleConvolution
+    for ( size_t k = 0; 2 * k <= n; k++ ) {
+        size_t r = ( n - k ) & ( n - 1 );
+        for ( size_t l = 0; l < L; l++ ) {
+            double xr = p.re[k * L + l], xi = p.im[k * L + l];
+            double yr = p.re[r * L + l], yi = -p.im[r * L + l];
+            double ar = ( xr + yr ) / 2, ai = ( xi + yi ) / 2;
+            double br = ( xi - yi ) / 2, bi = ( yr - xr ) / 2;
+
+            double re = ar * br - ai * bi;
+            double im = ar * bi + ai * br;
+            p.re[r * L + l] = re;
+            p.im[r * L + l] = -im;
+            p.re[k * L + l] = re;
+            p.im[k * L + l] = im;
+        }
+    }
+
+    // Half size inverse, as in makeRealInverseFFT
+    size_t half = n / 2;
+    for ( size_t k = 0; k < half; k++ ) {
+        double cr = w.re[half + k], ci = w.im[half + k];
+        for ( size_t l = 0; l < L; l++ ) {
+            size_t low = k * L + l, high = ( k + half ) * L + l;
+            double even_re = ( p.re[low] + p.re[high] ) / 2;
+            double even_im = ( p.im[low] + p.im[high] ) / 2;
+            double dr = ( p.re[low] - p.re[high] ) / 2;
+            double di = ( p.im[low] - p.im[high] ) / 2;
+            double odd_re = dr * cr + di * ci;
+            double odd_im = di * cr - dr * ci;
+            p.re[low] = even_re - odd_im;
+            p.im[low] = even_im + odd_re;
+        }
+    }
+
+    makeBatchFFT( p.re.data(), p.im.data(), half, w );
+
+    for ( size_t l = 0; l < count; l++ ) {
+        long long * c = output + offsets[l];
+        size_t size = pairs[l]->productSize();
+        double scale = ldexp( 1.0 / half, -exponent[l] );
+
+        // Inverse through the forward transform: element m comes from (half - m) % half
+        RoundingTracker tracker;
+        for ( size_t i = 0; i < size; i++ ) {
+            size_t m = ( half - i / 2 ) & ( half - 1 );
+            c[i] = tracker.round( ( i % 2 == 0 ? p.re[m * L + l] : p.im[m * L + l] ) * scale );
+        }
+        rounding_errors[l] = tracker.error();
+    }
+}
+
+// Product of a pair whose batch transform of size n could not be trusted,
+// written to c: Karatsuba for short pairs, exact number theoretic
+// transforms for the rest (long double ones above NTT_MAX_SIZE, their
+// rounding distance goes to rounding_error)
+FFTMethod multiplyExactPair( const PolynomPair & pair, size_t n, long long * c, double & rounding_error )
+{
+    rounding_error = 0.0;
+    if ( std::max( pair.a_size, pair.b_size ) <= FFT_BATCH_KARATSUBA_SIZE ) {
+        multiplyKaratsuba( pair.a, pair.a_size, pair.b, pair.b_size, c );
+        return EXACT_METHOD;
+    }
+
+    std::vector <int> a( pair.a, pair.a + pair.a_size ), b( pair.b, pair.b + pair.b_size );
+    std::vector <long long> product = makeExactConvolution( a, b, n );
+    FFTMethod method = EXACT_METHOD;
+    if ( product.empty() ) {
+        product = makeSplitLongDoubleConvolution( a, b, n, &rounding_error );
+        method = LONG_DOUBLE_METHOD;
+    }
+    std::copy( product.begin(), product.begin() + pair.productSize(), c );
+    return method;
+}
+
+// Offsets of the products in the output arena: product k takes
+// productSize() elements from offsets[k], offsets[count] is the total size
+std::vector <size_t> findBatchOffsets( const PolynomPair * pairs, size_t count )
+{
+    std::vector <size_t> offsets( count + 1, 0 );
+    for ( size_t k = 0; k < count; k++ ) {
+        offsets[k + 1] = offsets[k] + pairs[k].productSize();
+    }
+    return offsets;
+}
+
+// Products of count pairs modulo 2^64, written to the preallocated arena
+// output at findBatchOffsets. Small pairs are multiplied directly, others
+// are grouped by transform size and done FFT_BATCH_LANES at a time; pairs
+// whose rounding error could exceed FFT_SAFE_ERROR go to Karatsuba or
+// to makeConvolution. A transformed pair further than FFT_ROUNDING_LIMIT
+// from integers is multiplied again by multiplyExactPair, and the outcome
+// of every transformed pair goes to currentFFTDiagnosticsHook()
+void multiplicatePolynomBatch( const PolynomPair * pairs, size_t count, long long * output )
+{
+    std::vector <size_t> offsets = findBatchOffsets( pairs, count );
+    std::vector <double> estimated_errors( count, 0.0 );
+    std::map <size_t, std::vector <size_t>> groups;
+
+    for ( size_t k = 0; k < count; k++ ) {
+        const PolynomPair & pair = pairs[k];
+        size_t shorter = std::min( pair.a_size, pair.b_size );
+        size_t longer = std::max( pair.a_size, pair.b_size );
+
+        if ( shorter == 0 ) {
+            continue;
+        }
+        if ( shorter <= FFT_BATCH_SCHOOLBOOK_SIZE ) {
+            multiplySchoolbook( pair.a, pair.a_size, pair.b, pair.b_size, output + offsets[k] );
+            continue;
+        }
+
+        size_t n = 2 * findUpperDegreeOfTwo( longer );
+        double norm_a = sqrt( findSquaredNorm( pair.a, pair.a_size ) );
+        double norm_b = sqrt( findSquaredNorm( pair.b, pair.b_size ) );
+        estimated_errors[k] = estimateFFTError( norm_a, norm_b, n );
+        if ( estimated_errors[k] > FFT_SAFE_ERROR ) {
+            if ( longer <= FFT_BATCH_KARATSUBA_SIZE ) {
+                multiplyKaratsuba( pair.a, pair.a_size, pair.b, pair.b_size, output + offsets[k] );
+                continue;
+            }
+            std::vector <int> a( pair.a, pair.a + pair.a_size ), b( pair.b, pair.b + pair.b_size );
+            std::vector <long long> c = makeConvolution( a, b, n );
+            std::copy( c.begin(), c.begin() + pair.productSize(), output + offsets[k] );
+            continue;
+        }
+        groups[n].push_back( k );
+    }
+
+    for ( auto & group : groups ) {
+        const std::vector <size_t> & members = group.second;
+        for ( size_t first = 0; first < members.size(); first += FFT_BATCH_LANES ) {
+            size_t lanes = std::min( FFT_BATCH_LANES, members.size() - first );
+            const PolynomPair * lane_pairs[FFT_BATCH_LANES];
+            size_t lane_offsets[FFT_BATCH_LANES];
+            for ( size_t l = 0; l < lanes; l++ ) {
+                lane_pairs[l] = &pairs[members[first + l]];
+                lane_offsets[l] = offsets[members[first + l]];
+            }
+            double rounding_errors[FFT_BATCH_LANES];
+            makeBatchConvolution( lane_pairs, lane_offsets, lanes, group.first, output, rounding_errors );
+
+            for ( size_t l = 0; l < lanes; l++ ) {
+                FFTDiagnostics diagnostics;
+                diagnostics.n = group.first;
+                diagnostics.estimated_error = estimated_errors[members[first + l]];
+                diagnostics.rounding_error = rounding_errors[l];
+                diagnostics.rejected_error = 0.0;
+                diagnostics.method = DOUBLE_METHOD;
+                diagnostics.attempts = 1;
+                if ( rounding_errors[l] > FFT_ROUNDING_LIMIT ) {
+                    diagnostics.rejected_error = rounding_errors[l];
+                    diagnostics.method = multiplyExactPair( *lane_pairs[l], group.first, output + lane_offsets[l], diagnostics.rounding_error );
+                    diagnostics.attempts++;
+                }
+                if ( currentFFTDiagnosticsHook() ) {
+                    currentFFTDiagnosticsHook()( diagnostics );
+                }
+            }
+        }
+    }
+}
+
+#endif /* fft_batch_h */
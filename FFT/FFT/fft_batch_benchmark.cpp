@@ -0,0 +1,145 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "fft_batch.h"
+
+template <class Function>
+long long measure(Function function)
+{
+    using namespace std::chrono;
+
+    auto start = high_resolution_clock::now();
+    function();
+    auto finish = high_resolution_clock::now();
+    return duration_cast<milliseconds>(finish - start).count();
+}
+
+// Pairs of random polynomials of sizes from min_size to max_size, about
+// total coefficients in every factor list
+struct Batch
+{
+    std::vector <int> coefficients;
+    std::vector <PolynomPair> pairs;
+
+    Batch(size_t min_size, size_t max_size, size_t total, int max_value, std::mt19937 & gen)
+    {
+        std::vector <size_t> sizes;
+        for (size_t sum = 0; sum < total; ) {
+            size_t a_size = min_size + gen() % (max_size - min_size + 1);
+            size_t b_size = min_size + gen() % (max_size - min_size + 1);
+            sizes.push_back(a_size);
+            sizes.push_back(b_size);
+            sum += a_size;
+        }
+
+        size_t count = 0;
+        for (size_t i = 0; i < sizes.size(); i++) {
+            count += sizes[i];
+        }
+        coefficients.resize(count);
+        for (size_t i = 0; i < count; i++) {
+            coefficients[i] = static_cast<int>(gen() % (2u * max_value + 1)) - max_value;
+        }
+
+        const int * position = coefficients.data();
+        for (size_t i = 0; i < sizes.size(); i += 2) {
+            PolynomPair pair = {position, sizes[i], position + sizes[i], sizes[i + 1]};
+            pairs.push_back(pair);
+            position += sizes[i] + sizes[i + 1];
+        }
+    }
+};
+
+void printTime(long long time, bool correct)
+{
+    std::cout << "\t" << time << (correct ? "" : "(wrong)");
+}
+
+// Every product of the batch computed by method into one arena
+// multiplicatePolynoms returns int, so it is compared modulo 2^32
+template <class Method>
+long long measureMethod(const Batch & batch, const std::vector <long long> & expected, Method method, bool & correct, bool truncated = false)
+{
+    std::vector <size_t> offsets = findBatchOffsets(batch.pairs.data(), batch.pairs.size());
+    std::vector <long long> c(offsets.back());
+
+    long long time = measure([&]() {
+        for (size_t k = 0; k < batch.pairs.size(); k++) {
+            const PolynomPair & pair = batch.pairs[k];
+            method(pair, c.data() + offsets[k]);
+        }
+    });
+    correct = true;
+    for (size_t i = 0; i < c.size(); i++) {
+        correct &= (c[i] == (truncated ? static_cast<int>(expected[i]) : expected[i]));
+    }
+    return time;
+}
+
+// Usage: fft_batch_benchmark [log2 of coefficients per batch]
+int main(int argc, char ** argv)
+{
+    int degree = (argc > 1 ? std::atoi(argv[1]) : 22);
+    size_t total = size_t(1) << degree;
+
+    std::mt19937 gen(2019);
+
+    // Every pair is also done by the single product code: a call of
+    // multiplicatePolynoms, and a convolution with the cached plan. Large
+    // coefficients make the double transforms split them
+    size_t ranges[][2] = {{16, 16}, {32, 32}, {64, 64}, {96, 96}, {128, 128}, {256, 256}, {512, 512}, {1024, 1024}, {64, 1024}};
+    for (int max_value : {1000, 1 << 30}) {
+        std::cout << "\n2^" << degree << " coefficients per batch, |coefficients| <= " << max_value << ", time in ms\n";
+        std::cout << "sizes\tpairs\tpolynoms\tconvolution\tschoolbook\tkaratsuba\tbatch\n";
+
+        for (auto & range : ranges) {
+            Batch batch(range[0], range[1], total, max_value, gen);
+            const std::vector <PolynomPair> & pairs = batch.pairs;
+
+            std::vector <size_t> offsets = findBatchOffsets(pairs.data(), pairs.size());
+            std::vector <long long> expected(offsets.back());
+            for (size_t k = 0; k < pairs.size(); k++) {
+                multiplySchoolbook(pairs[k].a, pairs[k].a_size, pairs[k].b, pairs[k].b_size, expected.data() + offsets[k]);
+            }
+
+            std::cout << range[0] << "-" << range[1] << "\t" << pairs.size();
+            bool correct;
+
+            long long time = measureMethod(batch, expected, [](const PolynomPair & pair, long long * c) {
+                std::vector <int> a(pair.a, pair.a + pair.a_size), b(pair.b, pair.b + pair.b_size);
+                std::vector <int> result = multiplicatePolynoms(a, b);
+                for (size_t i = 0; i < pair.productSize(); i++) {
+                    c[i] = result[i];
+                }
+            }, correct, true);
+            printTime(time, correct);
+
+            time = measureMethod(batch, expected, [](const PolynomPair & pair, long long * c) {
+                std::vector <int> a(pair.a, pair.a + pair.a_size), b(pair.b, pair.b + pair.b_size);
+                std::vector <long long> result = makeConvolution(a, b, 2 * findUpperDegreeOfTwo(std::max(a.size(), b.size())));
+                std::copy(result.begin(), result.begin() + pair.productSize(), c);
+            }, correct);
+            printTime(time, correct);
+
+            time = measureMethod(batch, expected, [](const PolynomPair & pair, long long * c) {
+                multiplySchoolbook(pair.a, pair.a_size, pair.b, pair.b_size, c);
+            }, correct);
+            printTime(time, correct);
+
+            time = measureMethod(batch, expected, [](const PolynomPair & pair, long long * c) {
+                multiplyKaratsuba(pair.a, pair.a_size, pair.b, pair.b_size, c);
+            }, correct);
+            printTime(time, correct);
+
+            std::vector <long long> c(offsets.back());
+            time = measure([&]() { multiplicatePolynomBatch(pairs.data(), pairs.size(), c.data()); });
+            printTime(time, c == expected);
+            std::cout << "\n";
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,282 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "fft.h"
+
+// Previous recursive implementation, kept as a baseline
+namespace recursive
+{
+
+std::vector <cld> makeGeneralFFT(std::vector <cld> a, cld q)
+{
+    if (a.size() == 1)
+        return a;
+    std::vector <cld> a0, a1;
+    for (size_t i = 0; i < a.size(); i += 2) {
+        a0.push_back(a[i]);
+        a1.push_back(a[i + 1]);
+    }
+
+    a0 = makeGeneralFFT(a0, q * q);
+    a1 = makeGeneralFFT(a1, q * q);
+
+    cld w (1.0, 0.0);
+
+    for (size_t i = 0; i < a.size() / 2; i++) {
+        cld u = a0[i];
+        cld v = w * a1[i];
+        a[i] = u + v;
+        a[i + a.size() / 2] = u - v;
+        w *= q;
+    }
+
+    return a;
+}
+
+std::vector <int> multiplicatePolynoms( const std::vector <int> & a, const std::vector <int> & b )
+{
+    size_t n = findUpperDegreeOfTwo( std::max(a.size(), b.size()) );
+    n *= 2;
+
+    long double ang = 2.0 * PI / n;
+    cld q(cosl(ang), sinl(ang));
+
+    std::vector <cld> ca = makeGeneralFFT(makeComplexVector(a, n), q);
+    std::vector <cld> cb = makeGeneralFFT(makeComplexVector(b, n), q);
+
+    for ( size_t i = 0; i < n; i++ ) {
+        ca[i] *= cb[i];
+    }
+
+    std::vector <cld> cc = makeGeneralFFT(ca, std::conj(q));
+    for (size_t i = 0; i < n; i++) {
+        cc[i] /= n;
+    }
+
+    return makeIntVector(cc);
+}
+
+} // end of namespace
+
+template <class Function>
+long long measure(Function function)
+{
+    using namespace std::chrono;
+
+    auto start = high_resolution_clock::now();
+    function();
+    auto finish = high_resolution_clock::now();
+    return duration_cast<milliseconds>(finish - start).count();
+}
+
+std::vector <int> randomPolynom(size_t size, int max_value, std::mt19937 & gen)
+{
+    std::vector <int> a(size);
+    for (size_t i = 0; i < size; i++) {
+        a[i] = static_cast<int>(gen() % (2u * max_value + 1)) - max_value;
+    }
+    return a;
+}
+
+// Exact values (modulo 2^32, as multiplicatePolynoms returns them) of some
+// product coefficients, used to check every implementation
+struct Samples
+{
+    std::vector <size_t> index;
+    std::vector <int> value;
+
+    Samples(const std::vector <int> & a, const std::vector <int> & b, std::mt19937 & gen)
+    {
+        for (int k = 0; k < 32; k++) {
+            size_t i = gen() % (a.size() + b.size() - 1);
+            unsigned long long sum = 0;
+            for (size_t j = 0; j < a.size(); j++) {
+                if (i >= j && i - j < b.size()) {
+                    sum += static_cast<unsigned long long>(static_cast<long long>(a[j]) * b[i - j]);
+                }
+            }
+            index.push_back(i);
+            value.push_back(static_cast<int>(sum));
+        }
+    }
+
+    bool check(const std::vector <int> & c) const
+    {
+        for (size_t k = 0; k < index.size(); k++) {
+            if (c[index[k]] != value[k]) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+void printTime(long long time, bool correct)
+{
+    std::cout << "\t" << time << (correct ? "" : "(wrong)");
+}
+
+// Many products of the same small size: a plan built for every call (as
+// twiddles were before plans) against the cached one
+void benchmarkRepeatedProducts(std::mt19937 & gen)
+{
+    const size_t total = size_t(1) << 24;
+
+    std::cout << "\nrepeated products, " << total << " coefficients in total, time in ms\n";
+    std::cout << "size\tfresh plan\tcached plan\n";
+
+    for (int degree = 6; degree <= 14; degree += 2) {
+        size_t size = size_t(1) << degree;
+        size_t n = 2 * size;
+        size_t count = total / size;
+        std::vector <int> a = randomPolynom(size, 1000, gen);
+        std::vector <int> b = randomPolynom(size, 1000, gen);
+        long long checksum[2] = {0, 0};
+
+        long long fresh = measure([&]() {
+            for (size_t k = 0; k < count; k++) {
+                FFTPlan plan(n);
+                checksum[0] += makeDoubleConvolution(a, b, n, plan)[size];
+            }
+        });
+        long long cached = measure([&]() {
+            for (size_t k = 0; k < count; k++) {
+                checksum[1] += makeDoubleConvolution(a, b, n, FFTPlan::get(n))[size];
+            }
+        });
+
+        std::cout << "2^" << degree << "\t" << fresh << "\t\t" << cached << (checksum[0] == checksum[1] ? "" : "\tMISMATCH") << "\n";
+    }
+}
+
+// Strong scaling of one transform of size 2^degree over 1..max_threads
+// threads (powers of two and max_threads itself)
+void benchmarkScaling(int degree, size_t max_threads)
+{
+    size_t n = size_t(1) << degree;
+    const FFTPlan & plan = FFTPlan::get(n);
+    const int repeats = 4;
+
+    SplitComplex a(n);
+    for (size_t i = 0; i < n; i++) {
+        a.re[i] = static_cast<double>(i % 1000);
+    }
+
+    std::cout << "\nstrong scaling, transform of 2^" << degree << ", time in ms\nthreads\ttime\tspeedup\n";
+
+    std::vector <size_t> counts;
+    for (size_t threads = 1; threads < max_threads; threads *= 2) {
+        counts.push_back(threads);
+    }
+    counts.push_back(max_threads);
+
+    long long single = 0;
+    for (size_t threads : counts) {
+        currentFFTThreads() = threads;
+        plan.execute(a, a);
+
+        long long time = measure([&]() {
+            for (int k = 0; k < repeats; k++) {
+                plan.execute(a, a);
+            }
+        }) / repeats;
+        if (threads == 1) {
+            single = time;
+        }
+
+        std::cout << threads << "\t" << time << "\t" << (time > 0 ? static_cast<double>(single) / time : 0.0) << "\n";
+    }
+    currentFFTThreads() = std::max(1u, std::thread::hardware_concurrency());
+}
+
+// Method chosen by makeConvolution and its measured rounding for growing
+// coefficients, reported through the diagnostics hook
+void benchmarkDiagnostics(int degree, std::mt19937 & gen)
+{
+    const char * methods[] = {"double", "split", "exact", "long double"};
+    size_t size = size_t(1) << degree;
+
+    std::cout << "\ndiagnostics, size 2^" << degree << "\nbits\tmethod\tattempts\testimate\trounding\trejected\ttime\n";
+
+    FFTDiagnostics last;
+    currentFFTDiagnosticsHook() = [&](const FFTDiagnostics & diagnostics) { last = diagnostics; };
+    for (int bits = 10; bits <= 30; bits += 4) {
+        std::vector <int> a = randomPolynom(size, 1 << bits, gen);
+        std::vector <int> b = randomPolynom(size, 1 << bits, gen);
+        Samples samples(a, b, gen);
+        std::vector <int> c;
+
+        long long time = measure([&]() { c = multiplicatePolynoms(a, b); });
+        std::cout << bits << "\t" << methods[last.method] << "\t" << last.attempts << "\t\t" << last.estimated_error
+                  << "\t" << last.rounding_error << "\t" << last.rejected_error;
+        printTime(time, samples.check(c));
+        std::cout << "\n";
+    }
+    currentFFTDiagnosticsHook() = nullptr;
+}
+
+// Usage: fft_benchmark [max degree] [max threads], sizes go from 2^16 up to 2^max degree
+int main(int argc, char ** argv)
+{
+    int max_degree = (argc > 1 ? std::atoi(argv[1]) : 22);
+    size_t max_threads = (argc > 2 ? std::strtoul(argv[2], nullptr, 10) : std::max(1u, std::thread::hardware_concurrency()));
+
+    const char * names[] = {"scalar", "avx2", "avx512"};
+    FFTKernel best = detectFFTKernel();
+
+    std::mt19937 gen(2019);
+
+    // Small coefficients go through a plain double transform, large ones
+    // are split; recursive long double code is the previous implementation
+    for (int max_value : {1000, 1 << 30}) {
+        std::cout << "\n|coefficients| <= " << max_value << ", time in ms\nsize";
+        for (int kernel = best; kernel >= SCALAR_KERNEL; kernel--) {
+            std::cout << "\t" << names[kernel];
+        }
+        std::cout << "\tlong double\trecursive\n";
+
+        for (int degree = 16; degree <= max_degree; degree++) {
+            std::vector <int> a = randomPolynom(size_t(1) << degree, max_value, gen);
+            std::vector <int> b = randomPolynom(size_t(1) << degree, max_value, gen);
+            Samples samples(a, b, gen);
+            std::vector <int> c;
+
+            // Plan is built here, so that it is not counted for the first kernel
+            size_t n = 2 * findUpperDegreeOfTwo(a.size());
+            FFTPlan::get(n);
+
+            std::cout << "2^" << degree;
+            for (int kernel = best; kernel >= SCALAR_KERNEL; kernel--) {
+                currentFFTKernel() = static_cast<FFTKernel>(kernel);
+                long long time = measure([&]() { c = multiplicatePolynoms(a, b); });
+                printTime(time, samples.check(c));
+            }
+            currentFFTKernel() = best;
+
+            long long time = measure([&]() {
+                std::vector <long long> result = makeLongDoubleConvolution(a, b, n);
+                c.assign(result.begin(), result.end());
+            });
+            printTime(time, samples.check(c));
+
+            time = measure([&]() { c = recursive::multiplicatePolynoms(a, b); });
+            printTime(time, samples.check(c));
+            std::cout << "\n";
+        }
+    }
+
+    benchmarkRepeatedProducts(gen);
+
+    benchmarkDiagnostics(std::min(max_degree, 20), gen);
+
+    for (int degree = 22; degree <= std::max(max_degree, 24); degree += 2) {
+        benchmarkScaling(degree, max_threads);
+    }
+
+    return 0;
+}
@@ -0,0 +1,276 @@
+#ifndef fft_io_h
+#define fft_io_h
+
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <stdio.h>
+#include <stdint.h>
+
+//
+// Fast reading and writing of polynomials: decimal text and raw binary
+//
+
+const size_t IO_BUFFER_SIZE = 1 << 16;
+
+// Buffered reader of a whole stream, without the locale and
+// synchronisation work of std::cin
+class InputReader
+{
+
+public:
+
+    explicit InputReader( FILE * );
+
+    InputReader( const InputReader & ) = delete;
+    InputReader & operator = ( const InputReader & ) = delete;
+
+    // Next decimal integer after whitespace; false at the end of input or
+    // if something else stands there
+    bool readInt( long long & );
+
+    // Next count bytes, false if the input ends before
+    bool readBytes( unsigned char *, size_t );
+
+
+private:
+
+    // Class fields
+    FILE * file_;
+    std::vector <unsigned char> buffer_;
+    size_t position_;
+    size_t size_;
+
+
+    // Secondary functions
+
+    // Next byte without taking it, -1 at the end of input
+    int peek();
+};
+
+InputReader::InputReader( FILE * file ) : file_( file ), buffer_( IO_BUFFER_SIZE ), position_( 0 ), size_( 0 )
+{
+}
+
+int InputReader::peek()
+{
+    if ( position_ == size_ ) {
+        size_ = fread( buffer_.data(), 1, buffer_.size(), file_ );
+        position_ = 0;
+        if ( size_ == 0 ) {
+            return -1;
+        }
+    }
+    return buffer_[position_];
+}
+
+bool InputReader::readInt( long long & value )
+{
+    int c = peek();
+    while ( c == ' ' || c == '\n' || c == '\r' || c == '\t' ) {
+        position_++;
+        c = peek();
+    }
+
+    bool negative = ( c == '-' );
+    if ( c == '-' || c == '+' ) {
+        position_++;
+        c = peek();
+    }
+    if ( c < '0' || c > '9' ) {
+        return false;
+    }
+
+    unsigned long long result = 0;
+    while ( c >= '0' && c <= '9' ) {
+        result = result * 10 + static_cast <unsigned> ( c - '0' );
+        position_++;
+        c = peek();
+    }
+    value = static_cast <long long> ( negative ? 0 - result : result );
+    return true;
+}
+
+bool InputReader::readBytes( unsigned char * data, size_t count )
+{
+    while ( count > 0 ) {
+        if ( peek() < 0 ) {
+            return false;
+        }
+        size_t part = std::min( count, size_ - position_ );
+        std::copy( buffer_.begin() + position_, buffer_.begin() + position_ + part, data );
+        position_ += part;
+        data += part;
+        count -= part;
+    }
+    return true;
+}
+
+// Buffered writer, the buffer is flushed when it is full and on destruction
+class OutputWriter
+{
+
+public:
+
+    explicit OutputWriter( FILE * );
+    ~OutputWriter();
+
+    OutputWriter( const OutputWriter & ) = delete;
+    OutputWriter & operator = ( const OutputWriter & ) = delete;
+
+    void writeInt( long long );
+    void writeChar( char );
+    void writeBytes( const unsigned char *, size_t );
+
+    // false if some write to the stream failed
+    bool flush();
+
+
+private:
+
+    // Class fields
+    FILE * file_;
+    std::vector <char> buffer_;
+    size_t size_;
+    bool failed_;
+};
+
+OutputWriter::OutputWriter( FILE * file ) : file_( file ), buffer_( IO_BUFFER_SIZE ), size_( 0 ), failed_( false )
+{
+}
+
+OutputWriter::~OutputWriter()
+{
+    flush();
+}
+
+bool OutputWriter::flush()
+{
+    if ( size_ > 0 && fwrite( buffer_.data(), 1, size_, file_ ) != size_ ) {
+        failed_ = true;
+    }
+    size_ = 0;
+    if ( fflush( file_ ) != 0 ) {
+        failed_ = true;
+    }
+    return !failed_;
+}
+
+void OutputWriter::writeChar( char c )
+{
+    if ( size_ == buffer_.size() ) {
+        flush();
+    }
+    buffer_[size_++] = c;
+}
+
+// Digits are made from the lowest one into a small buffer and copied in order
+void OutputWriter::writeInt( long long value )
+{
+    if ( size_ + 24 > buffer_.size() ) {
+        flush();
+    }
+
+    unsigned long long rest = static_cast <unsigned long long> ( value );
+    if ( value < 0 ) {
+        buffer_[size_++] = '-';
+        rest = 0 - rest;
+    }
+
+    char digits[24];
+    size_t count = 0;
+    do {
+        digits[count++] = static_cast <char> ( '0' + rest % 10 );
+        rest /= 10;
+    } while ( rest > 0 );
+
+    while ( count > 0 ) {
+        buffer_[size_++] = digits[--count];
+    }
+}
+
+void OutputWriter::writeBytes( const unsigned char * data, size_t count )
+{
+    while ( count > 0 ) {
+        if ( size_ == buffer_.size() ) {
+            flush();
+        }
+        size_t part = std::min( count, buffer_.size() - size_ );
+        std::copy( data, data + part, buffer_.begin() + size_ );
+        size_ += part;
+        data += part;
+        count -= part;
+    }
+}
+
+// Text polynomial: the number of coefficients, then the coefficients.
+// A coefficient that does not fit in int fails the read
+bool readTextPolynom( InputReader & input, std::vector <int> & a )
+{
+    long long n, value;
+    if ( !input.readInt( n ) || n < 0 ) {
+        return false;
+    }
+    a.resize( static_cast <size_t> ( n ) );
+    for ( size_t i = 0; i < a.size(); i++ ) {
+        if ( !input.readInt( value ) || value < std::numeric_limits <int>::min() || value > std::numeric_limits <int>::max() ) {
+            return false;
+        }
+        a[i] = static_cast <int> ( value );
+    }
+    return true;
+}
+
+// Text output is the coefficients alone, without their number
+void writeTextPolynom( OutputWriter & output, const std::vector <int> & c )
+{
+    for ( size_t i = 0; i < c.size(); i++ ) {
+        output.writeInt( c[i] );
+        output.writeChar( ' ' );
+    }
+}
+
+// Binary polynomial: the number of coefficients, then the coefficients,
+// every number a 32-bit little-endian integer. Unlike text output, binary
+// output keeps the count, so a product can be read back as input. Bytes
+// are assembled explicitly, so the format does not depend on the byte
+// order of the machine
+bool readBinaryPolynom( InputReader & input, std::vector <int> & a )
+{
+    unsigned char bytes[IO_BUFFER_SIZE];
+    if ( !input.readBytes( bytes, 4 ) ) {
+        return false;
+    }
+    uint32_t n = bytes[0] | bytes[1] << 8 | bytes[2] << 16 | static_cast <uint32_t> ( bytes[3] ) << 24;
+
+    a.resize( n );
+    for ( size_t first = 0; first < a.size(); first += IO_BUFFER_SIZE / 4 ) {
+        size_t count = std::min( IO_BUFFER_SIZE / 4, a.size() - first );
+        if ( !input.readBytes( bytes, 4 * count ) ) {
+            return false;
+        }
+        for ( size_t i = 0; i < count; i++ ) {
+            const unsigned char * b = bytes + 4 * i;
+            a[first + i] = static_cast <int32_t> ( b[0] | b[1] << 8 | b[2] << 16 | static_cast <uint32_t> ( b[3] ) << 24 );
+        }
+    }
+    return true;
+}
+
+void writeBinaryPolynom( OutputWriter & output, const std::vector <int> & c )
+{
+    unsigned char bytes[IO_BUFFER_SIZE];
+    for ( size_t first = 0; first <= c.size(); first += IO_BUFFER_SIZE / 4 ) {
+        size_t count = std::min( IO_BUFFER_SIZE / 4, c.size() + 1 - first );
+        for ( size_t i = 0; i < count; i++ ) {
+            size_t index = first + i;
+            uint32_t value = static_cast <uint32_t> ( index == 0 ? c.size() : c[index - 1] );
+            for ( size_t k = 0; k < 4; k++ ) {
+                bytes[4 * i + k] = static_cast <unsigned char> ( value >> 8 * k );
+            }
+        }
+        output.writeBytes( bytes, 4 * count );
+    }
+}
+
+#endif /* fft_io_h */
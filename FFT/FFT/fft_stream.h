@@ -0,0 +1,241 @@
+#ifndef fft_stream_h
+#define fft_stream_h
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <stdint.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "fft.h"
+
+//
+// Out-of-core multiplication of polynomials stored in files
+//
+
+// Upper bound for the memory one block coefficient costs: both input
+// blocks, packed transform buffers of the split path, the plan for twice
+// the block, product parts, the accumulator and four-step scratch
+const size_t STREAM_BYTES_PER_COEFFICIENT = 256;
+
+// Read-only view of a whole file through mmap, pages are read by the
+// system on first access and may be dropped again under memory pressure
+class MappedFile
+{
+
+public:
+
+    explicit MappedFile( const std::string & );
+    ~MappedFile();
+
+    MappedFile( const MappedFile & ) = delete;
+    MappedFile & operator = ( const MappedFile & ) = delete;
+
+    bool isOpen() const;
+    const char * data() const;
+    size_t size() const;
+
+
+private:
+
+    // Class fields
+    int descriptor_;
+    void * data_;
+    size_t size_;
+};
+
+MappedFile::MappedFile( const std::string & path ) : descriptor_( -1 ), data_( nullptr ), size_( 0 )
+{
+    descriptor_ = open( path.c_str(), O_RDONLY );
+    if ( descriptor_ < 0 ) {
+        return;
+    }
+
+    struct stat info;
+    if ( fstat( descriptor_, &info ) != 0 ) {
+        close( descriptor_ );
+        descriptor_ = -1;
+        return;
+    }
+
+    size_ = static_cast <size_t> ( info.st_size );
+    if ( size_ == 0 ) {
+        return;
+    }
+
+    data_ = mmap( nullptr, size_, PROT_READ, MAP_PRIVATE, descriptor_, 0 );
+    if ( data_ == MAP_FAILED ) {
+        data_ = nullptr;
+        close( descriptor_ );
+        descriptor_ = -1;
+        return;
+    }
+}
+
+MappedFile::~MappedFile()
+{
+    if ( data_ != nullptr ) {
+        munmap( data_, size_ );
+    }
+    if ( descriptor_ >= 0 ) {
+        close( descriptor_ );
+    }
+}
+
+bool MappedFile::isOpen() const
+{
+    return descriptor_ >= 0;
+}
+
+const char * MappedFile::data() const
+{
+    return static_cast <const char *> ( data_ );
+}
+
+size_t MappedFile::size() const
+{
+    return size_;
+}
+
+// 32-bit little-endian integer at data
+uint32_t readLittleEndian32( const char * data )
+{
+    const unsigned char * b = reinterpret_cast <const unsigned char *> ( data );
+    return b[0] | b[1] << 8 | b[2] << 16 | static_cast <uint32_t> ( b[3] ) << 24;
+}
+
+// Number of coefficients of a polynomial file: the 32-bit little-endian
+// count that starts it, as in readBinaryPolynom. false if the file is too
+// short for the header or for the coefficients it announces
+bool readStreamSize( const MappedFile & file, size_t & count )
+{
+    if ( file.size() < sizeof( uint32_t ) ) {
+        return false;
+    }
+    count = readLittleEndian32( file.data() );
+    return file.size() >= sizeof( uint32_t ) * ( count + 1 );
+}
+
+// Block number index of length block (shorter at the end) of the count
+// coefficients stored in file after its header
+void readBlock( const MappedFile & file, size_t count, size_t block, size_t index, std::vector <int> & result )
+{
+    size_t begin = std::min( count, index * block );
+    size_t end = std::min( count, begin + block );
+
+    result.resize( end - begin );
+    const char * source = file.data() + ( begin + 1 ) * sizeof( uint32_t );
+    for ( size_t i = 0; i < result.size(); i++ ) {
+        result[i] = static_cast <int32_t> ( readLittleEndian32( source + i * sizeof( uint32_t ) ) );
+    }
+}
+
+// Writes count values as 64-bit little-endian integers
+void writeLittleEndian64( std::ostream & output, const unsigned long long * values, size_t count )
+{
+    std::vector <unsigned char> bytes( 8 * count );
+    for ( size_t i = 0; i < count; i++ ) {
+        for ( size_t k = 0; k < 8; k++ ) {
+            bytes[8 * i + k] = static_cast <unsigned char> ( values[i] >> 8 * k );
+        }
+    }
+    output.write( reinterpret_cast <const char *> ( bytes.data() ), static_cast <std::streamsize> ( bytes.size() ) );
+}
+
+// Largest block length whose working set fits into memory_mb megabytes
+size_t findStreamBlockSize( size_t memory_mb )
+{
+    size_t budget = memory_mb * ( size_t( 1 ) << 20 ) / STREAM_BYTES_PER_COEFFICIENT;
+    size_t block = 1;
+    while ( 2 * block <= budget ) {
+        block *= 2;
+    }
+    return block;
+}
+
+// Product of polynomials from files a_path and b_path written to c_path,
+// modulo 2^64 like makeConvolution. Inputs have the layout of --binary:
+// a 32-bit little-endian count, then that many 32-bit little-endian
+// coefficients, lowest degree first. The output is a 64-bit little-endian
+// count, then the coefficients as 64-bit little-endian integers. Overlap-add by blocks of length L:
+// output block s is the first half of sum over i + j = s of a_i * b_j
+// plus the second half of the same sum for s - 1, so it is written as
+// soon as s is done. Memory stays within about memory_mb megabytes
+// (plus pages of the mapped inputs, which the system may evict);
+// returns false if some file cannot be opened, read or written
+bool multiplicatePolynomFiles( const std::string & a_path, const std::string & b_path, const std::string & c_path, size_t memory_mb )
+{
+    MappedFile a_file( a_path ), b_file( b_path );
+    if ( !a_file.isOpen() || !b_file.isOpen() ) {
+        std::cerr << "Can't open input files!";
+        return false;
+    }
+
+    std::ofstream output( c_path, std::ios::binary );
+    if ( !output ) {
+        std::cerr << "Can't open output file!";
+        return false;
+    }
+
+    size_t a_size, b_size;
+    if ( !readStreamSize( a_file, a_size ) || !readStreamSize( b_file, b_size ) ) {
+        std::cerr << "Input files are shorter than their headers!";
+        return false;
+    }
+
+    unsigned long long c_count = ( a_size == 0 || b_size == 0 ? 0 : a_size + b_size - 1 );
+    writeLittleEndian64( output, &c_count, 1 );
+    if ( c_count == 0 ) {
+        return static_cast <bool> ( output );
+    }
+
+    size_t block = std::min( findStreamBlockSize( memory_mb ), findUpperDegreeOfTwo( std::max( a_size, b_size ) ) );
+    size_t a_blocks = ( a_size + block - 1 ) / block;
+    size_t b_blocks = ( b_size + block - 1 ) / block;
+    size_t c_size = a_size + b_size - 1;
+    size_t written = 0;
+
+    std::vector <int> a_block, b_block;
+    std::vector <unsigned long long> sum( 2 * block ), carry( block, 0 );
+
+    for ( size_t s = 0; s + 1 < a_blocks + b_blocks; s++ ) {
+        std::fill( sum.begin(), sum.end(), 0 );
+
+        size_t first = ( s >= b_blocks ? s - b_blocks + 1 : 0 );
+        size_t last = std::min( s, a_blocks - 1 );
+        for ( size_t i = first; i <= last; i++ ) {
+            readBlock( a_file, a_size, block, i, a_block );
+            readBlock( b_file, b_size, block, s - i, b_block );
+
+            std::vector <long long> product = makeConvolution( a_block, b_block, 2 * block );
+            for ( size_t k = 0; k < 2 * block; k++ ) {
+                sum[k] += static_cast <unsigned long long> ( product[k] );
+            }
+        }
+
+        for ( size_t k = 0; k < block; k++ ) {
+            sum[k] += carry[k];
+            carry[k] = sum[block + k];
+        }
+
+        size_t count = std::min( block, c_size - written );
+        writeLittleEndian64( output, sum.data(), count );
+        written += count;
+    }
+
+    // Second half of the last sum
+    size_t count = std::min( block, c_size - written );
+    writeLittleEndian64( output, carry.data(), count );
+
+    if ( !output ) {
+        std::cerr << "Can't write output file!";
+        return false;
+    }
+    return true;
+}
+
+#endif /* fft_stream_h */
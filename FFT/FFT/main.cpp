@@ -1,121 +1,74 @@
 #include <iostream>
-#include <complex>
 #include <vector>
-#include <algorithm>
-#include <math.h>
+#include <string>
+#include <chrono>
+#include <cstdlib>
+#include "fft.h"
+#include "fft_io.h"
+#include "fft_stream.h"
 
-using cld = std::complex <long double>;
-const long double PI = acosl(-1.0);
-
-inline size_t findUpperDegreeOfTwo( size_t v )
-{
-    size_t n = 1;
-    while ( n < v ) {
-        n *= 2;
-    }
-    return n;
-}
-
-std::vector <cld> makeComplexVector( const std::vector<int> & a, size_t n )
-{
-    std::vector <cld> ca( n, cld( 0.0, 0.0 ) );
-    for ( size_t i = 0; i < a.size(); i++ ) {
-        ca[i] = cld( a[i], 0.0 );
-    }
-    return ca;
-}
-
-std::vector <cld> makeGeneralFFT(std::vector <cld> a, cld q)
-{
-    if (a.size() == 1)
-        return a;
-    std::vector <cld> a0, a1;
-    for (size_t i = 0; i < a.size(); i += 2) {
-        a0.push_back(a[i]);
-        a1.push_back(a[i + 1]);
-    }
+// Usage: FFT [--binary] [--time]       - both polynoms from standard input
+//        FFT a.bin b.bin c.bin [MB]    - out-of-core product of binary files,
+//                                        within MB megabytes (256 by default)
+// Text input is "n a0 ... a(n-1)" for each polynom, text output is
+// "c0 ... c(m-1)" without the count. --binary reads "n a0 ... a(n-1)" as
+// 32-bit little-endian integers and writes "m c0 ... c(m-1)" the same way,
+// count included. --time prints parse, transform and emit times to
+// standard error. a.bin and b.bin hold one polynom each in the --binary
+// input layout; c.bin gets the product as a 64-bit little-endian count
+// and 64-bit little-endian coefficients (modulo 2^64)
+int main(int argc, char ** argv) {
     
-    a0 = makeGeneralFFT(a0, q * q);
-    a1 = makeGeneralFFT(a1, q * q);
-
-    cld w (1.0, 0.0);
-    
-    for (size_t i = 0; i < a.size() / 2; i++) {
-        cld u = a0[i];
-        cld v = w * a1[i];
-        a[i] = u + v;
-        a[i + a.size() / 2] = u - v;
-        w *= q;
+    bool binary = false, timings = false;
+    std::vector <std::string> files;
+    for (int i = 1; i < argc; i++) {
+        std::string argument = argv[i];
+        if (argument == "--binary") {
+            binary = true;
+        } else if (argument == "--time") {
+            timings = true;
+        } else {
+            files.push_back(argument);
+        }
     }
     
-    return a;
-}
-
-std::vector <cld> makeFFT(const std::vector <cld> & a)
-{
-    long double ang = 2.0 * PI / a.size();
-    return makeGeneralFFT(a, cld(std::cosl(ang), std::sinl(ang)));
-}
-
-std::vector <cld> makeInverseFFT(std::vector <cld> a)
-{
-    long double ang = 2.0 * PI / a.size();
-    a = makeGeneralFFT(a, cld(std::cosl(ang), -std::sinl(ang)));
-    for (size_t i = 0; i < a.size(); i++) {
-        a[i] /= a.size();
+    if (files.size() >= 3) {
+        size_t memory_mb = (files.size() > 3 ? std::strtoul(files[3].c_str(), nullptr, 10) : 256);
+        return multiplicatePolynomFiles(files[0], files[1], files[2], memory_mb) ? 0 : 1;
     }
-    return a;
-}
-
-std::vector <int> makeIntVector(const std::vector<cld> & a)
-{
-    std::vector <int> ans(a.size());
-    for (size_t i = 0; i < a.size(); i++) {
-        ans[i] = floorl(a[i].real() + 0.5);
-    }
-    return ans;
-}
-
-std::vector <int>  multiplicatePolynoms( const std::vector <int> & a, const std::vector <int> & b )
-{
-    size_t n = findUpperDegreeOfTwo( std::max(a.size(), b.size()) );
-    n *= 2;
     
-    std::vector <cld> ca = makeComplexVector(a, n);
-    std::vector <cld> cb = makeComplexVector(b, n);
+    using namespace std::chrono;
+    auto start = high_resolution_clock::now();
     
-    ca = makeFFT(ca);
-    cb = makeFFT(cb);
-    
-    for ( size_t i = 0; i < n; i++ ) {
-        ca[i] *= cb[i];
+    InputReader input(stdin);
+    std::vector <int> a, b;
+    bool read = (binary ? readBinaryPolynom(input, a) && readBinaryPolynom(input, b)
+                        : readTextPolynom(input, a) && readTextPolynom(input, b));
+    if (!read) {
+        std::cerr << "Can't read input polynoms!";
+        return 1;
     }
+    auto parsed = high_resolution_clock::now();
     
-    std::vector <cld> cc = makeInverseFFT(ca);
+    std::vector <int> c = multiplicatePolynoms(a, b);
+    auto transformed = high_resolution_clock::now();
     
-    return makeIntVector(cc);
-}
-
-std::vector <int> readVector()
-{
-    int n;
-    std::cin >> n;
-    std::vector <int> a(n);
-    for (int i = 0; i < n; i++) {
-        std::cin >> a[i];
+    OutputWriter output(stdout);
+    if (binary) {
+        writeBinaryPolynom(output, c);
+    } else {
+        writeTextPolynom(output, c);
     }
-    return a;
-}
-
-int main() {
-    
-    std::vector <int> a = readVector();
-    std::vector <int> b = readVector();
-    
-    std::vector <int> c = multiplicatePolynoms(a, b);
+    if (!output.flush()) {
+        std::cerr << "Can't write output!";
+        return 1;
+    }
+    auto emitted = high_resolution_clock::now();
     
-    for (size_t i = 0; i < c.size(); i++) {
-        std::cout << c[i] << ' ';
+    if (timings) {
+        std::cerr << "parse: " << duration_cast<milliseconds>(parsed - start).count() << " ms, "
+                  << "transform: " << duration_cast<milliseconds>(transformed - parsed).count() << " ms, "
+                  << "emit: " << duration_cast<milliseconds>(emitted - transformed).count() << " ms\n";
     }
     
     return 0;
@@ -0,0 +1,408 @@
+#ifndef ntt_h
+#define ntt_h
+
+#include <vector>
+#include <algorithm>
+#include <iostream>
+#include <stdint.h>
+
+#include "fft.h"
+
+//
+// Number theoretic transform
+//
+
+// Primes of the form c * 2^k + 1 with primitive root 3. The first one
+// alone gives products modulo 998244353, all three are combined by the
+// Chinese remainder theorem into exact 64-bit products
+const uint32_t NTT_MODULI[3] = { 998244353, 167772161, 469762049 };
+const uint32_t NTT_ROOT = 3;
+
+// Largest transform size supported by all three moduli
+const size_t NTT_MAX_SIZE = size_t( 1 ) << 23;
+
+// Arithmetic modulo an odd mod < 2^30 in Montgomery form: x is stored
+// as x * 2^32 mod mod, so a product needs two multiplications and a
+// shift instead of a division. All stored values are in [0, mod)
+struct Montgomery
+{
+    uint32_t mod;
+    uint32_t inv; // mod^-1 modulo 2^32
+    uint32_t r2;  // 2^64 modulo mod
+
+    explicit Montgomery( uint32_t mod );
+
+    uint32_t multiply( uint32_t a, uint32_t b ) const;
+    uint32_t add( uint32_t a, uint32_t b ) const;
+    uint32_t subtract( uint32_t a, uint32_t b ) const;
+    uint32_t power( uint32_t a, uint64_t degree ) const;
+
+    uint32_t toMontgomery( long long a ) const;
+    uint32_t fromMontgomery( uint32_t a ) const;
+};
+
+Montgomery::Montgomery( uint32_t mod ) : mod( mod )
+{
+    // Newton iteration, every step doubles the number of correct bits
+    inv = mod;
+    for ( int i = 0; i < 4; i++ ) {
+        inv *= 2 - mod * inv;
+    }
+    r2 = static_cast <uint32_t> ( ( static_cast <unsigned __int128> ( 1 ) << 64 ) % mod );
+}
+
+// (a * b - m * mod) / 2^32 where m makes the low half vanish, the
+// difference of high halves lies in (-mod, mod)
+inline uint32_t Montgomery::multiply( uint32_t a, uint32_t b ) const
+{
+    uint64_t t = static_cast <uint64_t> ( a ) * b;
+    uint32_t m = static_cast <uint32_t> ( t ) * inv;
+    int64_t r = static_cast <int64_t> ( t >> 32 ) - static_cast <int64_t> ( ( static_cast <uint64_t> ( m ) * mod ) >> 32 );
+    return static_cast <uint32_t> ( r < 0 ? r + mod : r );
+}
+
+inline uint32_t Montgomery::add( uint32_t a, uint32_t b ) const
+{
+    uint32_t r = a + b;
+    return ( r >= mod ? r - mod : r );
+}
+
+inline uint32_t Montgomery::subtract( uint32_t a, uint32_t b ) const
+{
+    return ( a >= b ? a - b : a + mod - b );
+}
+
+uint32_t Montgomery::power( uint32_t a, uint64_t degree ) const
+{
+    uint32_t result = toMontgomery( 1 );
+    for ( ; degree > 0; degree >>= 1 ) {
+        if ( degree & 1 ) {
+            result = multiply( result, a );
+        }
+        a = multiply( a, a );
+    }
+    return result;
+}
+
+inline uint32_t Montgomery::toMontgomery( long long a ) const
+{
+    long long r = a % static_cast <long long> ( mod );
+    return multiply( static_cast <uint32_t> ( r < 0 ? r + mod : r ), r2 );
+}
+
+inline uint32_t Montgomery::fromMontgomery( uint32_t a ) const
+{
+    return multiply( a, 1 );
+}
+
+// a^-1 modulo a prime mod by Fermat's little theorem, in plain form
+uint32_t findModularInverse( uint64_t a, uint32_t mod )
+{
+    Montgomery field( mod );
+    return field.fromMontgomery( field.power( field.toMontgomery( static_cast <long long> ( a % mod ) ), mod - 2 ) );
+}
+
+void makeBitReversal( std::vector <uint32_t> & a )
+{
+    size_t n = a.size();
+    for ( size_t i = 1, j = 0; i < n; i++ ) {
+        size_t bit = n >> 1;
+        for ( ; j & bit; bit >>= 1 ) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if ( i < j ) {
+            std::swap( a[i], a[j] );
+        }
+    }
+}
+
+// Same layout as makeTwiddles: w[len + j] = g^(j * (mod - 1) / (2 * len)),
+// g a primitive root, everything in Montgomery form
+std::vector <uint32_t> makeModularTwiddles( size_t n, const Montgomery & field )
+{
+    std::vector <uint32_t> w( std::max( n, size_t( 2 ) ) );
+    size_t top = n / 2;
+    if ( top == 0 ) {
+        return w;
+    }
+
+    uint32_t step = field.power( field.toMontgomery( NTT_ROOT ), ( field.mod - 1 ) / n );
+    w[top] = field.toMontgomery( 1 );
+    for ( size_t j = 1; j < top; j++ ) {
+        w[top + j] = field.multiply( w[top + j - 1], step );
+    }
+
+    for ( size_t len = top / 2; len >= 1; len /= 2 ) {
+        for ( size_t j = 0; j < len; j++ ) {
+            w[len + j] = w[2 * len + 2 * j];
+        }
+    }
+    return w;
+}
+
+// One pass of butterflies with half-length len over arrays of size n
+void makeModularButterfliesScalar( uint32_t * a, const uint32_t * w, size_t n, size_t len, const Montgomery & field )
+{
+    for ( size_t i = 0; i < n; i += 2 * len ) {
+        for ( size_t j = 0; j < len; j++ ) {
+            uint32_t u = a[i + j];
+            uint32_t v = field.multiply( a[i + j + len], w[len + j] );
+            a[i + j] = field.add( u, v );
+            a[i + j + len] = field.subtract( u, v );
+        }
+    }
+}
+
+#if FFT_X86_KERNELS
+
+// Montgomery product of eight pairs. _mm256_mul_epu32 multiplies only even
+// 32-bit lanes, so odd lanes are shifted down and the high halves of both
+// products are blended back together
+__attribute__(( target( "avx2" ) ))
+inline __m256i multiplyMontgomeryAVX2( __m256i a, __m256i b, __m256i mod, __m256i inv )
+{
+    __m256i t_even = _mm256_mul_epu32( a, b );
+    __m256i t_odd = _mm256_mul_epu32( _mm256_srli_epi64( a, 32 ), _mm256_srli_epi64( b, 32 ) );
+    __m256i m_even = _mm256_mul_epu32( _mm256_mul_epu32( t_even, inv ), mod );
+    __m256i m_odd = _mm256_mul_epu32( _mm256_mul_epu32( t_odd, inv ), mod );
+
+    __m256i t = _mm256_blend_epi32( _mm256_srli_epi64( t_even, 32 ), t_odd, 0xAA );
+    __m256i m = _mm256_blend_epi32( _mm256_srli_epi64( m_even, 32 ), m_odd, 0xAA );
+
+    // Negative differences wrap above 2^31, adding mod brings them back
+    __m256i r = _mm256_sub_epi32( t, m );
+    return _mm256_min_epu32( r, _mm256_add_epi32( r, mod ) );
+}
+
+// Same pass eight butterflies at a time, len >= 8
+__attribute__(( target( "avx2" ) ))
+void makeModularButterfliesAVX2( uint32_t * a, const uint32_t * w, size_t n, size_t len, const Montgomery & field )
+{
+    const __m256i mod = _mm256_set1_epi32( static_cast <int> ( field.mod ) );
+    const __m256i inv = _mm256_set1_epi32( static_cast <int> ( field.inv ) );
+
+    for ( size_t i = 0; i < n; i += 2 * len ) {
+        for ( size_t j = 0; j < len; j += 8 ) {
+            __m256i * low = reinterpret_cast <__m256i *> ( a + i + j );
+            __m256i * high = reinterpret_cast <__m256i *> ( a + i + j + len );
+            __m256i u = _mm256_loadu_si256( low );
+            __m256i root = _mm256_loadu_si256( reinterpret_cast <const __m256i *> ( w + len + j ) );
+            __m256i v = multiplyMontgomeryAVX2( _mm256_loadu_si256( high ), root, mod, inv );
+
+            __m256i sum = _mm256_add_epi32( u, v );
+            __m256i difference = _mm256_sub_epi32( u, v );
+            _mm256_storeu_si256( low, _mm256_min_epu32( sum, _mm256_sub_epi32( sum, mod ) ) );
+            _mm256_storeu_si256( high, _mm256_min_epu32( difference, _mm256_add_epi32( difference, mod ) ) );
+        }
+    }
+}
+
+// GCC's own AVX-512 intrinsics start from _mm512_undefined_epi32 and
+// set off -Wmaybe-uninitialized in every caller
+#if defined( __GNUC__ ) && !defined( __clang__ )
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+__attribute__(( target( "avx512f" ) ))
+inline __m512i multiplyMontgomeryAVX512( __m512i a, __m512i b, __m512i mod, __m512i inv )
+{
+    __m512i t_even = _mm512_mul_epu32( a, b );
+    __m512i t_odd = _mm512_mul_epu32( _mm512_srli_epi64( a, 32 ), _mm512_srli_epi64( b, 32 ) );
+    __m512i m_even = _mm512_mul_epu32( _mm512_mul_epu32( t_even, inv ), mod );
+    __m512i m_odd = _mm512_mul_epu32( _mm512_mul_epu32( t_odd, inv ), mod );
+
+    __m512i t = _mm512_mask_blend_epi32( 0xAAAA, _mm512_srli_epi64( t_even, 32 ), t_odd );
+    __m512i m = _mm512_mask_blend_epi32( 0xAAAA, _mm512_srli_epi64( m_even, 32 ), m_odd );
+
+    __m512i r = _mm512_sub_epi32( t, m );
+    return _mm512_min_epu32( r, _mm512_add_epi32( r, mod ) );
+}
+
+// Same pass sixteen butterflies at a time, len >= 16
+__attribute__(( target( "avx512f" ) ))
+void makeModularButterfliesAVX512( uint32_t * a, const uint32_t * w, size_t n, size_t len, const Montgomery & field )
+{
+    const __m512i mod = _mm512_set1_epi32( static_cast <int> ( field.mod ) );
+    const __m512i inv = _mm512_set1_epi32( static_cast <int> ( field.inv ) );
+
+    for ( size_t i = 0; i < n; i += 2 * len ) {
+        for ( size_t j = 0; j < len; j += 16 ) {
+            uint32_t * low = a + i + j;
+            uint32_t * high = a + i + j + len;
+            __m512i u = _mm512_loadu_si512( low );
+            __m512i v = multiplyMontgomeryAVX512( _mm512_loadu_si512( high ), _mm512_loadu_si512( w + len + j ), mod, inv );
+
+            __m512i sum = _mm512_add_epi32( u, v );
+            __m512i difference = _mm512_sub_epi32( u, v );
+            _mm512_storeu_si512( low, _mm512_min_epu32( sum, _mm512_sub_epi32( sum, mod ) ) );
+            _mm512_storeu_si512( high, _mm512_min_epu32( difference, _mm512_add_epi32( difference, mod ) ) );
+        }
+    }
+}
+
+#if defined( __GNUC__ ) && !defined( __clang__ )
+#pragma GCC diagnostic pop
+#endif
+
+#endif
+
+// Passes with half-length len over n elements starting from offset,
+// done by the widest kernel that fits len
+void makeModularButterflies( std::vector <uint32_t> & a, const std::vector <uint32_t> & w, size_t offset, size_t n, size_t len,
+                             const Montgomery & field, FFTKernel kernel )
+{
+    uint32_t * data = a.data() + offset;
+#if FFT_X86_KERNELS
+    if ( kernel == AVX512_KERNEL && len >= 16 ) {
+        makeModularButterfliesAVX512( data, w.data(), n, len, field );
+        return;
+    }
+    if ( kernel != SCALAR_KERNEL && len >= 8 ) {
+        makeModularButterfliesAVX2( data, w.data(), n, len, field );
+        return;
+    }
+#else
+    (void) kernel;
+#endif
+    makeModularButterfliesScalar( data, w.data(), n, len, field );
+}
+
+// Iterative in-place transform modulo field.mod with roots from
+// makeModularTwiddles, blocked the same way as makeButterflyPasses
+void makeNTT( std::vector <uint32_t> & a, const std::vector <uint32_t> & w, const Montgomery & field )
+{
+    const size_t block = 1 << 13;
+
+    size_t n = a.size();
+    size_t first = std::min( n, block );
+    FFTKernel kernel = currentFFTKernel();
+
+    makeBitReversal( a );
+
+    for ( size_t offset = 0; offset < n; offset += first ) {
+        for ( size_t len = 1; len < first; len *= 2 ) {
+            makeModularButterflies( a, w, offset, first, len, field, kernel );
+        }
+    }
+    for ( size_t len = first; len < n; len *= 2 ) {
+        makeModularButterflies( a, w, 0, n, len, field, kernel );
+    }
+}
+
+// Division by n is merged with the conversion out of Montgomery form
+// by the caller, here only the order of a[1..n-1] is reversed
+void makeInverseNTT( std::vector <uint32_t> & a, const std::vector <uint32_t> & w, const Montgomery & field )
+{
+    makeNTT( a, w, field );
+    std::reverse( a.begin() + 1, a.end() );
+}
+
+// Cyclic convolution of a and b modulo field.mod with transform size n,
+// returns plain (not Montgomery) residues
+std::vector <uint32_t> makeModularConvolution( const std::vector<int> & a, const std::vector<int> & b, size_t n, const Montgomery & field )
+{
+    std::vector <uint32_t> ma( n, 0 ), mb( n, 0 );
+    for ( size_t i = 0; i < a.size(); i++ ) {
+        ma[i] = field.toMontgomery( a[i] );
+    }
+    for ( size_t i = 0; i < b.size(); i++ ) {
+        mb[i] = field.toMontgomery( b[i] );
+    }
+
+    std::vector <uint32_t> w = makeModularTwiddles( n, field );
+    makeNTT( ma, w, field );
+    makeNTT( mb, w, field );
+
+    for ( size_t i = 0; i < n; i++ ) {
+        ma[i] = field.multiply( ma[i], mb[i] );
+    }
+
+    makeInverseNTT( ma, w, field );
+
+    // Multiplication by plain n^-1 also leaves Montgomery form:
+    // (x * R) * n^-1 / R = x / n
+    uint32_t scale = findModularInverse( n, field.mod );
+    for ( size_t i = 0; i < n; i++ ) {
+        ma[i] = field.multiply( ma[i], scale );
+    }
+    return ma;
+}
+
+// Garner's algorithm for residues r modulo NTT_MODULI: x = r0 + p0 * (t1 + p1 * t2)
+// is the unique value in [0, p0 * p1 * p2). Values above half of the
+// product are negative, the result is reduced modulo 2^64
+long long restoreFromResidues( uint32_t r0, uint32_t r1, uint32_t r2 )
+{
+    const uint64_t p0 = NTT_MODULI[0], p1 = NTT_MODULI[1], p2 = NTT_MODULI[2];
+    static const uint64_t inv01 = findModularInverse( p0, NTT_MODULI[1] );
+    static const uint64_t inv012 = findModularInverse( p0 * p1, NTT_MODULI[2] );
+
+    uint64_t t1 = ( r1 + p1 - r0 % p1 ) % p1 * inv01 % p1;
+    uint64_t x01 = r0 + p0 * t1;
+    uint64_t t2 = ( r2 + p2 - x01 % p2 ) % p2 * inv012 % p2;
+
+    unsigned __int128 product = static_cast <unsigned __int128> ( p0 * p1 ) * p2;
+    unsigned __int128 x = x01 + static_cast <unsigned __int128> ( p0 * p1 ) * t2;
+    if ( x > product / 2 ) {
+        return static_cast <long long> ( static_cast <uint64_t> ( x - product ) );
+    }
+    return static_cast <long long> ( static_cast <uint64_t> ( x ) );
+}
+
+// Transform size for the product, as in multiplicatePolynoms; 0 if it is
+// larger than the moduli allow
+size_t findModularTransformSize( const std::vector <int> & a, const std::vector <int> & b )
+{
+    size_t n = 2 * findUpperDegreeOfTwo( std::max( a.size(), b.size() ) );
+    if ( n > NTT_MAX_SIZE ) {
+        std::cerr << "Polynoms are too long for the number theoretic transform!";
+        return 0;
+    }
+    return n;
+}
+
+// Product modulo 998244353, coefficients are in [0, 998244353)
+std::vector <int> multiplicatePolynomsModulo( const std::vector <int> & a, const std::vector <int> & b )
+{
+    size_t n = findModularTransformSize( a, b );
+    if ( n == 0 ) {
+        return std::vector <int> ();
+    }
+
+    std::vector <uint32_t> c = makeModularConvolution( a, b, n, Montgomery( NTT_MODULI[0] ) );
+    return std::vector <int> ( c.begin(), c.end() );
+}
+
+// Exact product modulo 2^64 by Garner's algorithm over the three moduli:
+// |a[i] * b[j]| < 2^62 and at most 2^22 terms per coefficient, which is
+// less than half of the product of the moduli. Empty if n > NTT_MAX_SIZE
+std::vector <long long> makeExactConvolution( const std::vector<int> & a, const std::vector<int> & b, size_t n )
+{
+    if ( n > NTT_MAX_SIZE ) {
+        return std::vector <long long> ();
+    }
+
+    std::vector <uint32_t> residues[3];
+    for ( int k = 0; k < 3; k++ ) {
+        residues[k] = makeModularConvolution( a, b, n, Montgomery( NTT_MODULI[k] ) );
+    }
+
+    std::vector <long long> c( n );
+    for ( size_t i = 0; i < n; i++ ) {
+        c[i] = restoreFromResidues( residues[0][i], residues[1][i], residues[2][i] );
+    }
+    return c;
+}
+
+std::vector <long long> multiplicatePolynomsExact( const std::vector <int> & a, const std::vector <int> & b )
+{
+    size_t n = findModularTransformSize( a, b );
+    if ( n == 0 ) {
+        return std::vector <long long> ();
+    }
+    return makeExactConvolution( a, b, n );
+}
+
+#endif /* ntt_h */
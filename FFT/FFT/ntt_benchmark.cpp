@@ -0,0 +1,128 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "ntt.h"
+
+template <class Function>
+long long measure(Function function)
+{
+    using namespace std::chrono;
+
+    auto start = high_resolution_clock::now();
+    function();
+    auto finish = high_resolution_clock::now();
+    return duration_cast<milliseconds>(finish - start).count();
+}
+
+std::vector <int> randomPolynom(size_t size, int max_value, std::mt19937 & gen)
+{
+    std::vector <int> a(size);
+    for (size_t i = 0; i < size; i++) {
+        a[i] = static_cast<int>(gen() % (2u * max_value + 1)) - max_value;
+    }
+    return a;
+}
+
+// Exact values (modulo 2^64 and modulo the first NTT modulus) of some
+// product coefficients
+struct Samples
+{
+    std::vector <size_t> index;
+    std::vector <long long> value;
+    std::vector <long long> residue;
+
+    Samples(const std::vector <int> & a, const std::vector <int> & b, std::mt19937 & gen)
+    {
+        for (int k = 0; k < 32; k++) {
+            size_t i = gen() % (a.size() + b.size() - 1);
+            const long long mod = NTT_MODULI[0];
+            unsigned long long sum = 0;
+            long long sum_modulo = 0;
+            for (size_t j = 0; j < a.size(); j++) {
+                if (i >= j && i - j < b.size()) {
+                    long long product = static_cast<long long>(a[j]) * b[i - j];
+                    sum += static_cast<unsigned long long>(product);
+                    sum_modulo = ((sum_modulo + product % mod) % mod + mod) % mod;
+                }
+            }
+            index.push_back(i);
+            value.push_back(static_cast<long long>(sum));
+            residue.push_back(sum_modulo);
+        }
+    }
+
+    // Complex FFT results are compared modulo 2^32, exact ones modulo 2^64
+    template <class Vector>
+    bool check(const Vector & c, bool modular = false) const
+    {
+        for (size_t k = 0; k < index.size(); k++) {
+            long long expected = (modular ? residue[k] : value[k]);
+            if (!modular && sizeof(c[0]) == sizeof(int)) {
+                expected = static_cast<int>(value[k]);
+            }
+            if (c[index[k]] != expected) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+void printTime(long long time, bool correct)
+{
+    std::cout << "\t" << time << (correct ? "" : "(wrong)");
+}
+
+// Usage: ntt_benchmark [max degree], sizes go from 2^16 up to 2^max degree
+int main(int argc, char ** argv)
+{
+    int max_degree = (argc > 1 ? std::atoi(argv[1]) : 22);
+
+    const char * names[] = {"scalar", "avx2", "avx512"};
+    FFTKernel best = detectFFTKernel();
+
+    std::mt19937 gen(2019);
+
+    // Complex FFT is exact (modulo 2^32) only while its error estimate
+    // allows, modular transforms are exact for any input
+    for (int max_value : {1000, 1 << 30}) {
+        std::cout << "\n|coefficients| <= " << max_value << ", time in ms\nsize\tcomplex";
+        for (int kernel = best; kernel >= SCALAR_KERNEL; kernel--) {
+            std::cout << "\tmodulo " << names[kernel];
+        }
+        for (int kernel = best; kernel >= SCALAR_KERNEL; kernel--) {
+            std::cout << "\texact " << names[kernel];
+        }
+        std::cout << "\n";
+
+        for (int degree = 16; degree <= max_degree; degree++) {
+            std::vector <int> a = randomPolynom(size_t(1) << degree, max_value, gen);
+            std::vector <int> b = randomPolynom(size_t(1) << degree, max_value, gen);
+            Samples samples(a, b, gen);
+            std::vector <int> c;
+            std::vector <long long> exact;
+
+            std::cout << "2^" << degree;
+            long long time = measure([&]() { c = multiplicatePolynoms(a, b); });
+            printTime(time, samples.check(c));
+
+            for (int kernel = best; kernel >= SCALAR_KERNEL; kernel--) {
+                currentFFTKernel() = static_cast<FFTKernel>(kernel);
+                time = measure([&]() { c = multiplicatePolynomsModulo(a, b); });
+                printTime(time, samples.check(c, true));
+            }
+            for (int kernel = best; kernel >= SCALAR_KERNEL; kernel--) {
+                currentFFTKernel() = static_cast<FFTKernel>(kernel);
+                time = measure([&]() { exact = multiplicatePolynomsExact(a, b); });
+                printTime(time, samples.check(exact));
+            }
+            currentFFTKernel() = best;
+            std::cout << "\n";
+        }
+    }
+
+    return 0;
+}
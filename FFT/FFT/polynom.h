@@ -0,0 +1,614 @@
+#ifndef polynom_h
+#define polynom_h
+
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <iostream>
+#include <algorithm>
+#include <stdint.h>
+
+#include "ntt.h"
+
+//
+// Polynomials and power series modulo 998244353 on top of the number
+// theoretic transform
+//
+
+const uint32_t POLYNOM_MODULUS = NTT_MODULI[0];
+
+// Products, divisions and subproduct tree leaves with a side of at most
+// this many terms are done directly
+const size_t POLYNOM_NAIVE_SIZE = 32;
+
+const Montgomery & findPolynomField()
+{
+    static const Montgomery field( POLYNOM_MODULUS );
+    return field;
+}
+
+// Roots for transforms of size n, built once per size
+const std::vector <uint32_t> & findPolynomTwiddles( size_t n )
+{
+    static std::mutex mutex;
+    static std::map <size_t, std::unique_ptr <std::vector <uint32_t>>> twiddles;
+
+    std::lock_guard <std::mutex> lock( mutex );
+    std::unique_ptr <std::vector <uint32_t>> & w = twiddles[n];
+    if ( !w ) {
+        w.reset( new std::vector <uint32_t> ( makeModularTwiddles( n, findPolynomField() ) ) );
+    }
+    return *w;
+}
+
+// Transform of size n of a[0..size) padded with zeros, size <= n
+std::vector <uint32_t> makePolynomTransform( const uint32_t * a, size_t size, size_t n )
+{
+    std::vector <uint32_t> result( n, 0 );
+    std::copy( a, a + size, result.begin() );
+    makeNTT( result, findPolynomTwiddles( n ), findPolynomField() );
+    return result;
+}
+
+// Inverse of makePolynomTransform, values stay in Montgomery form
+void makePolynomInverseTransform( std::vector <uint32_t> & a )
+{
+    const Montgomery & field = findPolynomField();
+    makeInverseNTT( a, findPolynomTwiddles( a.size() ), field );
+
+    uint32_t scale = field.toMontgomery( findModularInverse( a.size(), field.mod ) );
+    for ( size_t i = 0; i < a.size(); i++ ) {
+        a[i] = field.multiply( a[i], scale );
+    }
+}
+
+// Coefficients (lowest degree first) in Montgomery form, together with
+// the transforms of them that were already needed: an operand used in
+// many products is transformed once per size
+class ModularPolynom
+{
+
+public:
+
+    ModularPolynom();
+
+    // Plain coefficients, they are reduced modulo POLYNOM_MODULUS
+    explicit ModularPolynom( const std::vector <long long> & );
+
+    static ModularPolynom fromMontgomery( std::vector <uint32_t> );
+
+    size_t size() const;
+
+    // Coefficients in Montgomery form
+    const std::vector <uint32_t> & coefficients() const;
+
+    // Coefficients in plain form, in [0, POLYNOM_MODULUS)
+    std::vector <long long> values() const;
+
+    // The series modulo x^m: first m coefficients, padded with zeros
+    ModularPolynom truncate( size_t ) const;
+
+    // Transform of size n >= size(), made on the first request and kept;
+    // the first request must not come from several threads at once
+    const std::vector <uint32_t> & spectrum( size_t ) const;
+
+
+private:
+
+    // Class fields
+    std::vector <uint32_t> a_;
+    mutable std::map <size_t, std::vector <uint32_t>> spectra_;
+};
+
+ModularPolynom::ModularPolynom()
+{
+}
+
+ModularPolynom::ModularPolynom( const std::vector <long long> & a ) : a_( a.size() )
+{
+    const Montgomery & field = findPolynomField();
+    for ( size_t i = 0; i < a.size(); i++ ) {
+        a_[i] = field.toMontgomery( a[i] );
+    }
+}
+
+ModularPolynom ModularPolynom::fromMontgomery( std::vector <uint32_t> a )
+{
+    ModularPolynom result;
+    result.a_.swap( a );
+    return result;
+}
+
+size_t ModularPolynom::size() const
+{
+    return a_.size();
+}
+
+const std::vector <uint32_t> & ModularPolynom::coefficients() const
+{
+    return a_;
+}
+
+std::vector <long long> ModularPolynom::values() const
+{
+    const Montgomery & field = findPolynomField();
+    std::vector <long long> result( a_.size() );
+    for ( size_t i = 0; i < a_.size(); i++ ) {
+        result[i] = field.fromMontgomery( a_[i] );
+    }
+    return result;
+}
+
+ModularPolynom ModularPolynom::truncate( size_t m ) const
+{
+    std::vector <uint32_t> result( m, 0 );
+    std::copy( a_.begin(), a_.begin() + std::min( m, a_.size() ), result.begin() );
+    return fromMontgomery( result );
+}
+
+const std::vector <uint32_t> & ModularPolynom::spectrum( size_t n ) const
+{
+    std::vector <uint32_t> & result = spectra_[n];
+    if ( result.empty() ) {
+        result = makePolynomTransform( a_.data(), a_.size(), n );
+    }
+    return result;
+}
+
+std::vector <uint32_t> multiplyNaive( const uint32_t * a, size_t a_size, const uint32_t * b, size_t b_size )
+{
+    const Montgomery & field = findPolynomField();
+    std::vector <uint32_t> c( a_size + b_size - 1, 0 );
+    for ( size_t i = 0; i < a_size; i++ ) {
+        for ( size_t j = 0; j < b_size; j++ ) {
+            c[i + j] = field.add( c[i + j], field.multiply( a[i], b[j] ) );
+        }
+    }
+    return c;
+}
+
+ModularPolynom multiplyModular( const ModularPolynom & a, const ModularPolynom & b )
+{
+    if ( a.size() == 0 || b.size() == 0 ) {
+        return ModularPolynom();
+    }
+    if ( std::min( a.size(), b.size() ) <= POLYNOM_NAIVE_SIZE ) {
+        const std::vector <uint32_t> & x = a.coefficients(), & y = b.coefficients();
+        return ModularPolynom::fromMontgomery( multiplyNaive( x.data(), x.size(), y.data(), y.size() ) );
+    }
+
+    const Montgomery & field = findPolynomField();
+    size_t size = a.size() + b.size() - 1;
+    size_t n = findUpperDegreeOfTwo( size );
+    const std::vector <uint32_t> & fa = a.spectrum( n );
+    const std::vector <uint32_t> & fb = b.spectrum( n );
+
+    std::vector <uint32_t> c( n );
+    for ( size_t i = 0; i < n; i++ ) {
+        c[i] = field.multiply( fa[i], fb[i] );
+    }
+    makePolynomInverseTransform( c );
+    c.resize( size );
+    return ModularPolynom::fromMontgomery( c );
+}
+
+// 1 / a modulo x^m by Newton iteration: g = g (2 - a g) doubles the
+// number of correct terms, a needs a nonzero constant term
+ModularPolynom findInverseSeries( const ModularPolynom & a, size_t m )
+{
+    const Montgomery & field = findPolynomField();
+    const std::vector <uint32_t> & f = a.coefficients();
+    if ( f.empty() || f[0] == 0 ) {
+        std::cerr << "Series has no inverse!";
+        return ModularPolynom();
+    }
+
+    uint32_t two = field.toMontgomery( 2 );
+    std::vector <uint32_t> g( 1, field.power( f[0], field.mod - 2 ) );
+
+    // a mod x^2k times g squared has less than 4k terms
+    for ( size_t k = 1; k < m; k *= 2 ) {
+        size_t n = 4 * k;
+        std::vector <uint32_t> ff = makePolynomTransform( f.data(), std::min( f.size(), 2 * k ), n );
+        std::vector <uint32_t> gg = makePolynomTransform( g.data(), k, n );
+        for ( size_t i = 0; i < n; i++ ) {
+            gg[i] = field.multiply( gg[i], field.subtract( two, field.multiply( ff[i], gg[i] ) ) );
+        }
+        makePolynomInverseTransform( gg );
+        gg.resize( 2 * k );
+        g.swap( gg );
+    }
+
+    return ModularPolynom::fromMontgomery( g ).truncate( m );
+}
+
+ModularPolynom findDerivative( const ModularPolynom & a )
+{
+    const Montgomery & field = findPolynomField();
+    const std::vector <uint32_t> & f = a.coefficients();
+
+    std::vector <uint32_t> result( f.empty() ? 0 : f.size() - 1 );
+    for ( size_t i = 0; i < result.size(); i++ ) {
+        result[i] = field.multiply( f[i + 1], field.toMontgomery( i + 1 ) );
+    }
+    return ModularPolynom::fromMontgomery( result );
+}
+
+// Antiderivative with zero constant term. Inverses of 1..n come from
+// 1 / i = -(mod / i) / (mod % i), each one from a smaller one
+ModularPolynom findIntegral( const ModularPolynom & a )
+{
+    const Montgomery & field = findPolynomField();
+    const std::vector <uint32_t> & f = a.coefficients();
+    const uint64_t mod = field.mod;
+
+    std::vector <uint64_t> inverse( f.size() + 1, 1 );
+    for ( size_t i = 2; i <= f.size(); i++ ) {
+        inverse[i] = ( mod - mod / i ) * inverse[mod % i] % mod;
+    }
+
+    std::vector <uint32_t> result( f.size() + 1, 0 );
+    for ( size_t i = 0; i < f.size(); i++ ) {
+        result[i + 1] = field.multiply( f[i], field.toMontgomery( static_cast <long long> ( inverse[i + 1] ) ) );
+    }
+    return ModularPolynom::fromMontgomery( result );
+}
+
+// log a modulo x^m as the integral of a' / a, a needs constant term 1
+ModularPolynom findLogarithm( const ModularPolynom & a, size_t m )
+{
+    const Montgomery & field = findPolynomField();
+    if ( a.size() == 0 || a.coefficients()[0] != field.toMontgomery( 1 ) ) {
+        std::cerr << "Logarithm needs a series with constant term 1!";
+        return ModularPolynom();
+    }
+    if ( m == 0 ) {
+        return ModularPolynom();
+    }
+
+    ModularPolynom quotient = multiplyModular( findDerivative( a.truncate( m ) ), findInverseSeries( a, m ) );
+    return findIntegral( quotient.truncate( m - 1 ) );
+}
+
+// exp a modulo x^m by Newton iteration: g = g (1 - log g + a) doubles the
+// number of correct terms, a needs constant term 0
+ModularPolynom findExponent( const ModularPolynom & a, size_t m )
+{
+    const Montgomery & field = findPolynomField();
+    if ( a.size() > 0 && a.coefficients()[0] != 0 ) {
+        std::cerr << "Exponent needs a series with constant term 0!";
+        return ModularPolynom();
+    }
+
+    uint32_t one = field.toMontgomery( 1 );
+    ModularPolynom g = ModularPolynom::fromMontgomery( std::vector <uint32_t> ( 1, one ) );
+
+    for ( size_t k = 1; k < m; k *= 2 ) {
+        std::vector <uint32_t> h = a.truncate( 2 * k ).coefficients();
+        ModularPolynom l = findLogarithm( g, 2 * k );
+        for ( size_t i = 0; i < h.size(); i++ ) {
+            h[i] = field.subtract( h[i], l.coefficients()[i] );
+        }
+        h[0] = field.add( h[0], one );
+        g = multiplyModular( g, ModularPolynom::fromMontgomery( h ) ).truncate( 2 * k );
+    }
+
+    return g.truncate( m );
+}
+
+// Repeated division by one polynomial b: the quotient is the reversed
+// dividend times the inverse series of reversed b, and the remainder
+// a - b q is computed cyclically at the size of b. Inverse series and
+// transforms of b are kept between divisions
+class ModularDivisor
+{
+
+public:
+
+    // Leading coefficient of b must not be zero
+    explicit ModularDivisor( const ModularPolynom & );
+
+    const ModularPolynom & divisor() const;
+
+    // a = b * quotient + remainder, remainder has b.size() - 1 coefficients
+    void divide( const ModularPolynom &, ModularPolynom &, ModularPolynom & ) const;
+
+    ModularPolynom findRemainder( const ModularPolynom & ) const;
+
+
+private:
+
+    // Class fields
+    ModularPolynom b_;
+
+    // Inverse series of reversed b modulo x^m, by m
+    mutable std::map <size_t, ModularPolynom> inverses_;
+
+
+    // Secondary functions
+    const ModularPolynom & findReversedInverse( size_t ) const;
+    void divideNaive( const ModularPolynom &, ModularPolynom &, ModularPolynom & ) const;
+};
+
+ModularDivisor::ModularDivisor( const ModularPolynom & b ) : b_( b )
+{
+    if ( b.size() == 0 || b.coefficients().back() == 0 ) {
+        std::cerr << "Divisor must have a nonzero leading coefficient!";
+    }
+}
+
+const ModularPolynom & ModularDivisor::divisor() const
+{
+    return b_;
+}
+
+const ModularPolynom & ModularDivisor::findReversedInverse( size_t m ) const
+{
+    std::map <size_t, ModularPolynom>::iterator it = inverses_.find( m );
+    if ( it == inverses_.end() ) {
+        std::vector <uint32_t> reversed( b_.coefficients().rbegin(), b_.coefficients().rend() );
+        it = inverses_.insert( std::make_pair( m, findInverseSeries( ModularPolynom::fromMontgomery( reversed ), m ) ) ).first;
+    }
+    return it->second;
+}
+
+// Long division, for short quotients or divisors
+void ModularDivisor::divideNaive( const ModularPolynom & a, ModularPolynom & quotient, ModularPolynom & remainder ) const
+{
+    const Montgomery & field = findPolynomField();
+    const std::vector <uint32_t> & b = b_.coefficients();
+    size_t t = b.size(), m = a.size() - t + 1;
+
+    std::vector <uint32_t> r = a.coefficients(), q( m );
+    uint32_t lead = field.power( b.back(), field.mod - 2 );
+    for ( size_t i = m; i-- > 0; ) {
+        q[i] = field.multiply( r[i + t - 1], lead );
+        for ( size_t j = 0; j < t; j++ ) {
+            r[i + j] = field.subtract( r[i + j], field.multiply( q[i], b[j] ) );
+        }
+    }
+    r.resize( t - 1 );
+
+    quotient = ModularPolynom::fromMontgomery( q );
+    remainder = ModularPolynom::fromMontgomery( r );
+}
+
+void ModularDivisor::divide( const ModularPolynom & a, ModularPolynom & quotient, ModularPolynom & remainder ) const
+{
+    size_t s = a.size(), t = b_.size();
+    if ( s < t ) {
+        quotient = ModularPolynom();
+        remainder = a.truncate( t - 1 );
+        return;
+    }
+
+    size_t m = s - t + 1;
+    if ( std::min( m, t ) <= POLYNOM_NAIVE_SIZE ) {
+        divideNaive( a, quotient, remainder );
+        return;
+    }
+
+    const Montgomery & field = findPolynomField();
+    const std::vector <uint32_t> & f = a.coefficients();
+
+    // rev(a) = rev(b) rev(q) modulo x^m
+    std::vector <uint32_t> reversed( f.rbegin(), f.rbegin() + m );
+    ModularPolynom product = multiplyModular( ModularPolynom::fromMontgomery( reversed ), findReversedInverse( m ) );
+    std::vector <uint32_t> q( product.coefficients().begin(), product.coefficients().begin() + m );
+    std::reverse( q.begin(), q.end() );
+
+    // The remainder has less than n terms, so it is the same modulo x^n - 1:
+    // a and q are folded to size n, and b q is a cyclic product
+    size_t n = findUpperDegreeOfTwo( t );
+    std::vector <uint32_t> folded_a( n, 0 ), folded_q( n, 0 );
+    for ( size_t i = 0; i < s; i++ ) {
+        folded_a[i & ( n - 1 )] = field.add( folded_a[i & ( n - 1 )], f[i] );
+    }
+    for ( size_t i = 0; i < m; i++ ) {
+        folded_q[i & ( n - 1 )] = field.add( folded_q[i & ( n - 1 )], q[i] );
+    }
+
+    const std::vector <uint32_t> & fb = b_.spectrum( n );
+    std::vector <uint32_t> bq = makePolynomTransform( folded_q.data(), n, n );
+    for ( size_t i = 0; i < n; i++ ) {
+        bq[i] = field.multiply( bq[i], fb[i] );
+    }
+    makePolynomInverseTransform( bq );
+
+    std::vector <uint32_t> r( t - 1 );
+    for ( size_t i = 0; i < r.size(); i++ ) {
+        r[i] = field.subtract( folded_a[i], bq[i] );
+    }
+
+    quotient = ModularPolynom::fromMontgomery( q );
+    remainder = ModularPolynom::fromMontgomery( r );
+}
+
+ModularPolynom ModularDivisor::findRemainder( const ModularPolynom & a ) const
+{
+    ModularPolynom quotient, remainder;
+    divide( a, quotient, remainder );
+    return remainder;
+}
+
+void divideModular( const ModularPolynom & a, const ModularPolynom & b, ModularPolynom & quotient, ModularPolynom & remainder )
+{
+    ModularDivisor( b ).divide( a, quotient, remainder );
+}
+
+// Products (x - x_i) over halves of the points, halved again down to
+// leaves of at most POLYNOM_NAIVE_SIZE points. Evaluation divides by the
+// nodes from the root down, interpolation multiplies back up; both keep
+// transforms of the nodes, so the tree is cheaper on the next use
+class SubproductTree
+{
+
+public:
+
+    // Points in plain form, they are reduced modulo POLYNOM_MODULUS
+    explicit SubproductTree( const std::vector <long long> & );
+
+    size_t size() const;
+
+    // Plain values of a at the points
+    std::vector <long long> evaluate( const ModularPolynom & ) const;
+
+    // Polynomial with less than size() terms taking the given values at
+    // the points, which must be distinct
+    ModularPolynom interpolate( const std::vector <long long> & ) const;
+
+
+private:
+
+    // Class fields
+    std::vector <uint32_t> points_;
+
+    // Node i has children 2i + 1 and 2i + 2, down to the leaves
+    std::vector <std::unique_ptr <ModularDivisor>> nodes_;
+
+
+    // Secondary functions
+    void build( size_t, size_t, size_t );
+    void evaluateNode( size_t, size_t, size_t, const ModularPolynom &, std::vector <long long> & ) const;
+    ModularPolynom interpolateNode( size_t, size_t, size_t, const std::vector <uint32_t> & ) const;
+};
+
+SubproductTree::SubproductTree( const std::vector <long long> & points ) : points_( points.size() )
+{
+    const Montgomery & field = findPolynomField();
+    for ( size_t i = 0; i < points.size(); i++ ) {
+        points_[i] = field.toMontgomery( points[i] );
+    }
+    if ( !points_.empty() ) {
+        build( 0, 0, points_.size() );
+    }
+}
+
+size_t SubproductTree::size() const
+{
+    return points_.size();
+}
+
+void SubproductTree::build( size_t index, size_t begin, size_t end )
+{
+    const Montgomery & field = findPolynomField();
+    if ( nodes_.size() <= index ) {
+        nodes_.resize( index + 1 );
+    }
+
+    ModularPolynom product;
+    if ( end - begin <= POLYNOM_NAIVE_SIZE ) {
+        std::vector <uint32_t> p( 1, field.toMontgomery( 1 ) );
+        for ( size_t i = begin; i < end; i++ ) {
+            p.push_back( 0 );
+            for ( size_t j = p.size() - 1; j > 0; j-- ) {
+                p[j] = field.subtract( p[j - 1], field.multiply( p[j], points_[i] ) );
+            }
+            p[0] = field.subtract( 0, field.multiply( p[0], points_[i] ) );
+        }
+        product = ModularPolynom::fromMontgomery( p );
+    } else {
+        size_t middle = ( begin + end ) / 2;
+        build( 2 * index + 1, begin, middle );
+        build( 2 * index + 2, middle, end );
+        product = multiplyModular( nodes_[2 * index + 1]->divisor(), nodes_[2 * index + 2]->divisor() );
+    }
+    nodes_[index].reset( new ModularDivisor( product ) );
+}
+
+std::vector <long long> SubproductTree::evaluate( const ModularPolynom & a ) const
+{
+    std::vector <long long> result( points_.size() );
+    if ( !points_.empty() ) {
+        evaluateNode( 0, 0, points_.size(), nodes_[0]->findRemainder( a ), result );
+    }
+    return result;
+}
+
+// r is the remainder of the polynomial by the product of the node
+void SubproductTree::evaluateNode( size_t index, size_t begin, size_t end, const ModularPolynom & r, std::vector <long long> & result ) const
+{
+    const Montgomery & field = findPolynomField();
+
+    if ( end - begin <= POLYNOM_NAIVE_SIZE ) {
+        const std::vector <uint32_t> & f = r.coefficients();
+        for ( size_t i = begin; i < end; i++ ) {
+            uint32_t value = 0;
+            for ( size_t j = f.size(); j-- > 0; ) {
+                value = field.add( field.multiply( value, points_[i] ), f[j] );
+            }
+            result[i] = field.fromMontgomery( value );
+        }
+        return;
+    }
+
+    size_t middle = ( begin + end ) / 2;
+    evaluateNode( 2 * index + 1, begin, middle, nodes_[2 * index + 1]->findRemainder( r ), result );
+    evaluateNode( 2 * index + 2, middle, end, nodes_[2 * index + 2]->findRemainder( r ), result );
+}
+
+// Lagrange form: the result is sum of c_i * M / (x - x_i) with
+// c_i = y_i / M'(x_i), M the product at the root
+ModularPolynom SubproductTree::interpolate( const std::vector <long long> & values ) const
+{
+    const Montgomery & field = findPolynomField();
+    if ( points_.empty() ) {
+        return ModularPolynom();
+    }
+
+    std::vector <long long> derivative = evaluate( findDerivative( nodes_[0]->divisor() ) );
+    std::vector <uint32_t> weights( points_.size() );
+    for ( size_t i = 0; i < points_.size(); i++ ) {
+        if ( derivative[i] == 0 ) {
+            std::cerr << "Interpolation points must be distinct!";
+            return ModularPolynom();
+        }
+        uint32_t inverse = field.power( field.toMontgomery( derivative[i] ), field.mod - 2 );
+        weights[i] = field.multiply( field.toMontgomery( values[i] ), inverse );
+    }
+    return interpolateNode( 0, 0, points_.size(), weights );
+}
+
+// Sum of c_i * M / (x - x_i) over the points of the node, M its product:
+// for an inner node it is left sum * right M + right sum * left M, done
+// with one inverse transform at the size the node was built with
+ModularPolynom SubproductTree::interpolateNode( size_t index, size_t begin, size_t end, const std::vector <uint32_t> & weights ) const
+{
+    const Montgomery & field = findPolynomField();
+
+    if ( end - begin <= POLYNOM_NAIVE_SIZE ) {
+        const std::vector <uint32_t> & p = nodes_[index]->divisor().coefficients();
+        std::vector <uint32_t> result( end - begin, 0 );
+        for ( size_t i = begin; i < end; i++ ) {
+            // Synthetic division of p by x - x_i
+            uint32_t q = p.back();
+            for ( size_t j = result.size(); j-- > 0; ) {
+                result[j] = field.add( result[j], field.multiply( weights[i], q ) );
+                q = field.add( p[j], field.multiply( q, points_[i] ) );
+            }
+        }
+        return ModularPolynom::fromMontgomery( result );
+    }
+
+    size_t middle = ( begin + end ) / 2;
+    ModularPolynom left = interpolateNode( 2 * index + 1, begin, middle, weights );
+    ModularPolynom right = interpolateNode( 2 * index + 2, middle, end, weights );
+
+    const ModularPolynom & left_product = nodes_[2 * index + 1]->divisor();
+    const ModularPolynom & right_product = nodes_[2 * index + 2]->divisor();
+    size_t n = findUpperDegreeOfTwo( left_product.size() + right_product.size() - 1 );
+
+    const std::vector <uint32_t> & fl = left_product.spectrum( n );
+    const std::vector <uint32_t> & fr = right_product.spectrum( n );
+    std::vector <uint32_t> sum = makePolynomTransform( left.coefficients().data(), left.size(), n );
+    std::vector <uint32_t> other = makePolynomTransform( right.coefficients().data(), right.size(), n );
+    for ( size_t i = 0; i < n; i++ ) {
+        sum[i] = field.add( field.multiply( sum[i], fr[i] ), field.multiply( other[i], fl[i] ) );
+    }
+    makePolynomInverseTransform( sum );
+    sum.resize( end - begin );
+    return ModularPolynom::fromMontgomery( sum );
+}
+
+#endif /* polynom_h */
@@ -0,0 +1,241 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "polynom.h"
+
+template <class Function>
+long long measure(Function function)
+{
+    using namespace std::chrono;
+
+    auto start = high_resolution_clock::now();
+    function();
+    auto finish = high_resolution_clock::now();
+    return duration_cast<milliseconds>(finish - start).count();
+}
+
+// Quadratic baselines in plain arithmetic modulo POLYNOM_MODULUS
+namespace naive
+{
+
+const uint64_t mod = POLYNOM_MODULUS;
+
+uint64_t power(uint64_t a, uint64_t degree)
+{
+    uint64_t result = 1;
+    for (a %= mod; degree > 0; degree >>= 1) {
+        if (degree & 1) {
+            result = result * a % mod;
+        }
+        a = a * a % mod;
+    }
+    return result;
+}
+
+uint64_t inverse(uint64_t a)
+{
+    return power(a, mod - 2);
+}
+
+// g[i] = -(a[1] g[i - 1] + ... + a[i] g[0]) / a[0]
+std::vector <long long> findInverseSeries(const std::vector <long long> & a, size_t m)
+{
+    std::vector <long long> g(m, 0);
+    uint64_t first = inverse(a[0]);
+    g[0] = first;
+    for (size_t i = 1; i < m; i++) {
+        uint64_t sum = 0;
+        for (size_t j = 1; j <= i && j < a.size(); j++) {
+            sum = (sum + a[j] * static_cast<uint64_t>(g[i - j])) % mod;
+        }
+        g[i] = (mod - sum) % mod * first % mod;
+    }
+    return g;
+}
+
+void divide(const std::vector <long long> & a, const std::vector <long long> & b, std::vector <long long> & q, std::vector <long long> & r)
+{
+    size_t t = b.size(), m = a.size() - t + 1;
+    r = a;
+    q.assign(m, 0);
+    uint64_t lead = inverse(b.back());
+    for (size_t i = m; i-- > 0; ) {
+        q[i] = r[i + t - 1] * lead % mod;
+        for (size_t j = 0; j < t; j++) {
+            r[i + j] = (r[i + j] + (mod - q[i] * static_cast<uint64_t>(b[j]) % mod)) % mod;
+        }
+    }
+    r.resize(t - 1);
+}
+
+// From a' = a l': k l[k] = k a[k] - sum of j l[j] a[k - j], a[0] = 1
+std::vector <long long> findLogarithm(const std::vector <long long> & a, size_t m)
+{
+    std::vector <long long> l(m, 0);
+    for (size_t k = 1; k < m; k++) {
+        uint64_t sum = (k < a.size() ? k * static_cast<uint64_t>(a[k]) % mod : 0);
+        for (size_t j = 1; j < k; j++) {
+            if (k - j < a.size()) {
+                sum = (sum + mod - j * static_cast<uint64_t>(l[j]) % mod * a[k - j] % mod) % mod;
+            }
+        }
+        l[k] = sum * inverse(k) % mod;
+    }
+    return l;
+}
+
+// From g' = a' g: k g[k] = sum of j a[j] g[k - j]
+std::vector <long long> findExponent(const std::vector <long long> & a, size_t m)
+{
+    std::vector <long long> g(m, 0);
+    g[0] = 1;
+    for (size_t k = 1; k < m; k++) {
+        uint64_t sum = 0;
+        for (size_t j = 1; j <= k && j < a.size(); j++) {
+            sum = (sum + j * static_cast<uint64_t>(a[j]) % mod * g[k - j]) % mod;
+        }
+        g[k] = sum * inverse(k) % mod;
+    }
+    return g;
+}
+
+std::vector <long long> evaluate(const std::vector <long long> & a, const std::vector <long long> & points)
+{
+    std::vector <long long> result(points.size());
+    for (size_t i = 0; i < points.size(); i++) {
+        uint64_t value = 0;
+        for (size_t j = a.size(); j-- > 0; ) {
+            value = (value * points[i] + a[j]) % mod;
+        }
+        result[i] = value;
+    }
+    return result;
+}
+
+// Lagrange: M / (x - x_i) by synthetic division, weights y_i / M'(x_i)
+std::vector <long long> interpolate(const std::vector <long long> & points, const std::vector <long long> & values)
+{
+    size_t n = points.size();
+    std::vector <long long> product(1, 1);
+    for (size_t i = 0; i < n; i++) {
+        product.push_back(0);
+        for (size_t j = product.size() - 1; j > 0; j--) {
+            product[j] = (product[j - 1] + mod - product[j] * static_cast<uint64_t>(points[i]) % mod) % mod;
+        }
+        product[0] = (mod - product[0] * static_cast<uint64_t>(points[i]) % mod) % mod;
+    }
+
+    std::vector <long long> result(n, 0), quotient(n);
+    for (size_t i = 0; i < n; i++) {
+        uint64_t q = product[n];
+        for (size_t j = n; j-- > 0; ) {
+            quotient[j] = q;
+            q = (product[j] + q * points[i]) % mod;
+        }
+        uint64_t denominator = evaluate(quotient, std::vector <long long> (1, points[i]))[0];
+        uint64_t weight = values[i] * inverse(denominator) % mod;
+        for (size_t j = 0; j < n; j++) {
+            result[j] = (result[j] + weight * quotient[j]) % mod;
+        }
+    }
+    return result;
+}
+
+}
+
+std::vector <long long> randomPolynom(size_t size, std::mt19937 & gen)
+{
+    std::vector <long long> a(size);
+    for (size_t i = 0; i < size; i++) {
+        a[i] = gen() % POLYNOM_MODULUS;
+    }
+    return a;
+}
+
+void printTime(long long time, bool correct)
+{
+    std::cout << "\t" << time << (correct ? "" : "(wrong)");
+}
+
+// Usage: polynom_benchmark [max degree] [max naive degree], sizes go
+// from 2^10; quadratic baselines run up to 2^max naive degree
+int main(int argc, char ** argv)
+{
+    int max_degree = (argc > 1 ? std::atoi(argv[1]) : 18);
+    int max_naive_degree = (argc > 2 ? std::atoi(argv[2]) : 14);
+
+    std::mt19937 gen(2019);
+
+    // Fast and quadratic times of each operation; evaluation is also
+    // repeated on the same tree, which then has all node transforms
+    std::cout << "\ntime in ms, fast / naive (evaluation: new tree / same tree / naive)\n";
+    std::cout << "size\tinverse\tdivision\tlog\texp\tevaluation\tinterpolation\n";
+    for (int degree = 10; degree <= max_degree; degree++) {
+        size_t n = size_t(1) << degree;
+        bool naive = (degree <= max_naive_degree);
+
+        std::vector <long long> a = randomPolynom(n, gen);
+        std::vector <long long> b = randomPolynom(n / 2, gen);
+        a[0] = 1;
+        ModularPolynom pa(a), pb(b);
+
+        std::cout << "2^" << degree;
+
+        ModularPolynom inverse;
+        long long time = measure([&]() { inverse = findInverseSeries(pa, n); });
+        std::vector <long long> expected;
+        long long naive_time = measure([&]() { if (naive) expected = naive::findInverseSeries(a, n); });
+        printTime(time, !naive || inverse.values() == expected);
+        std::cout << " / " << (naive ? std::to_string(naive_time) : "-");
+
+        ModularPolynom quotient, remainder;
+        time = measure([&]() { divideModular(pa, pb, quotient, remainder); });
+        std::vector <long long> q, r;
+        naive_time = measure([&]() { if (naive) naive::divide(a, b, q, r); });
+        printTime(time, !naive || (quotient.values() == q && remainder.values() == r));
+        std::cout << " / " << (naive ? std::to_string(naive_time) : "-");
+
+        ModularPolynom logarithm;
+        time = measure([&]() { logarithm = findLogarithm(pa, n); });
+        naive_time = measure([&]() { if (naive) expected = naive::findLogarithm(a, n); });
+        printTime(time, !naive || logarithm.values() == expected);
+        std::cout << " / " << (naive ? std::to_string(naive_time) : "-");
+
+        std::vector <long long> e = a;
+        e[0] = 0;
+        ModularPolynom exponent;
+        time = measure([&]() { exponent = findExponent(ModularPolynom(e), n); });
+        naive_time = measure([&]() { if (naive) expected = naive::findExponent(e, n); });
+        printTime(time, !naive || exponent.values() == expected);
+        std::cout << " / " << (naive ? std::to_string(naive_time) : "-");
+
+        // n distinct points: 0, 1, ..., n - 1 shifted by a random value
+        std::vector <long long> points(n);
+        long long shift = gen() % POLYNOM_MODULUS;
+        for (size_t i = 0; i < n; i++) {
+            points[i] = (shift + static_cast<long long>(i)) % POLYNOM_MODULUS;
+        }
+
+        std::vector <long long> values;
+        std::unique_ptr <SubproductTree> tree;
+        time = measure([&]() {
+            tree.reset(new SubproductTree(points));
+            values = tree->evaluate(pa);
+        });
+        long long cached_time = measure([&]() { values = tree->evaluate(pa); });
+        naive_time = measure([&]() { if (naive) expected = naive::evaluate(a, points); });
+        printTime(time, !naive || values == expected);
+        std::cout << " / " << cached_time << " / " << (naive ? std::to_string(naive_time) : "-");
+
+        ModularPolynom restored;
+        time = measure([&]() { restored = tree->interpolate(values); });
+        naive_time = measure([&]() { if (naive) expected = naive::interpolate(points, values); });
+        printTime(time, restored.values() == a);
+        std::cout << " / " << (naive ? std::to_string(naive_time) : "-") << "\n";
+    }
+
+    return 0;
+}
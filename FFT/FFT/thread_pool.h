@@ -0,0 +1,154 @@
+#ifndef thread_pool_h
+#define thread_pool_h
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//
+// Fixed set of worker threads for data parallel loops
+//
+
+class ThreadPool
+{
+
+public:
+
+    // Total number of threads, the one calling parallelFor included
+    explicit ThreadPool( size_t );
+    ~ThreadPool();
+
+    ThreadPool( const ThreadPool & ) = delete;
+    ThreadPool & operator = ( const ThreadPool & ) = delete;
+
+    size_t size() const;
+
+    // Calls function(i) for every i < count, indices are handed out one by
+    // one to the workers and to the calling thread. Returns when all calls
+    // are done. Loops started from different threads run one after another
+    template <class Function>
+    void parallelFor( size_t, const Function & );
+
+
+private:
+
+    // Class fields
+    std::vector <std::thread> workers_;
+    std::mutex loop_mutex_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+
+    // Current loop, a type-erased pointer to the function, so that
+    // starting a loop never allocates
+    void ( *call_ )( const void *, size_t );
+    const void * function_;
+    size_t count_;
+    std::atomic <size_t> next_;
+
+    size_t busy_;
+    size_t generation_;
+    bool stop_;
+
+
+    // Secondary functions
+    void work();
+    void runLoop();
+
+    template <class Function>
+    static void callFunction( const void *, size_t );
+};
+
+ThreadPool::ThreadPool( size_t threads ) : call_( nullptr ), function_( nullptr ), count_( 0 ), next_( 0 ),
+                                           busy_( 0 ), generation_( 0 ), stop_( false )
+{
+    for ( size_t i = 1; i < threads; i++ ) {
+        workers_.emplace_back( &ThreadPool::work, this );
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard <std::mutex> lock( mutex_ );
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for ( size_t i = 0; i < workers_.size(); i++ ) {
+        workers_[i].join();
+    }
+}
+
+size_t ThreadPool::size() const
+{
+    return workers_.size() + 1;
+}
+
+template <class Function>
+void ThreadPool::callFunction( const void * function, size_t i )
+{
+    ( *static_cast <const Function *> ( function ) )( i );
+}
+
+template <class Function>
+void ThreadPool::parallelFor( size_t count, const Function & function )
+{
+    if ( workers_.empty() || count <= 1 ) {
+        for ( size_t i = 0; i < count; i++ ) {
+            function( i );
+        }
+        return;
+    }
+
+    std::lock_guard <std::mutex> loop_lock( loop_mutex_ );
+    {
+        std::lock_guard <std::mutex> lock( mutex_ );
+        call_ = &callFunction <Function>;
+        function_ = &function;
+        count_ = count;
+        next_ = 0;
+        busy_ = workers_.size();
+        generation_++;
+    }
+    wake_.notify_all();
+
+    runLoop();
+
+    std::unique_lock <std::mutex> lock( mutex_ );
+    done_.wait( lock, [this]() { return busy_ == 0; } );
+}
+
+void ThreadPool::runLoop()
+{
+    for ( size_t i = next_++; i < count_; i = next_++ ) {
+        call_( function_, i );
+    }
+}
+
+// Every worker takes part in every loop: it waits for a new generation,
+// runs the loop and reports back
+void ThreadPool::work()
+{
+    size_t seen = 0;
+    while ( true ) {
+        {
+            std::unique_lock <std::mutex> lock( mutex_ );
+            wake_.wait( lock, [this, seen]() { return stop_ || generation_ != seen; } );
+            if ( stop_ ) {
+                return;
+            }
+            seen = generation_;
+        }
+
+        runLoop();
+
+        std::lock_guard <std::mutex> lock( mutex_ );
+        if ( --busy_ == 0 ) {
+            done_.notify_one();
+        }
+    }
+}
+
+#endif /* thread_pool_h */
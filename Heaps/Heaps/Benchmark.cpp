@@ -0,0 +1,475 @@
+//
+//  Benchmark.cpp
+//  Heaps
+//
+
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "BinomialHeap.h"
+#include "DaryHeap.h"
+#include "FibonacciHeap.h"
+#include "HeapAdaptor.h"
+#include "LeftistHeap.h"
+#include "MultiQueue.h"
+#include "NodePool.h"
+#include "PairingHeap.h"
+#include "RadixHeap.h"
+#include "SkewHeap.h"
+#include "StlHeap.h"
+
+using KeyType = int;
+using HeapCompare = std::less<KeyType>;
+
+template <typename Function>
+long long Measure(Function function)
+{
+    auto start = std::chrono::steady_clock::now();
+    function();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+}
+
+// Inserts all keys, then extracts them all; extracted keys must come sorted
+template <typename Heap>
+bool TimeInsertExtract(Heap& heap, const std::vector<KeyType>& keys, const std::vector<KeyType>& sorted,
+                       long long& insertTime, long long& extractTime)
+{
+    std::vector<KeyType> extracted(keys.size());
+
+    insertTime = Measure([&]() {
+        for (const KeyType& key : keys) {
+            heap.Insert(key);
+        }
+    });
+    extractTime = Measure([&]() {
+        for (size_t i = 0; i < keys.size(); i++) {
+            extracted[i] = heap.ExtractMin();
+        }
+    });
+
+    return extracted == sorted;
+}
+
+template <typename Heap>
+void BenchmarkInsertExtract(const std::string& name, const std::vector<KeyType>& keys, const std::vector<KeyType>& sorted)
+{
+    Heap heap;
+    long long insertTime, extractTime;
+    bool correct = TimeInsertExtract(heap, keys, sorted, insertTime, extractTime);
+
+    std::cout << name << "\t" << insertTime << "\t" << extractTime << (correct ? "" : "\t(wrong)") << "\n";
+}
+
+// The same heap called directly and through IHeap, nanoseconds per operation
+template <typename Heap>
+void BenchmarkStaticVirtual(const std::string& name, const std::vector<KeyType>& keys, const std::vector<KeyType>& sorted)
+{
+    long long insertTime[2], extractTime[2];
+    bool correct[2];
+
+    Heap heap;
+    correct[0] = TimeInsertExtract(heap, keys, sorted, insertTime[0], extractTime[0]);
+
+    std::unique_ptr<IHeap<KeyType, HeapCompare>> adaptor(new HeapAdaptor<Heap>());
+    correct[1] = TimeInsertExtract(*adaptor, keys, sorted, insertTime[1], extractTime[1]);
+
+    double scale = 1e6 / keys.size();
+    std::cout << name;
+    for (int k = 0; k < 2; k++) {
+        std::cout << "\t" << insertTime[k] * scale << "\t" << extractTime[k] * scale << (correct[k] ? "" : "(wrong)");
+    }
+    std::cout << "\n";
+}
+
+// Building a heap of the keys by Insert one by one and at once, checked
+// by the size and the minimum. An untimed build goes first, so that both
+// timed ones get memory already mapped
+template <typename Heap>
+void BenchmarkBuild(const std::string& name, const std::vector<KeyType>& keys, KeyType minimum)
+{
+    long long insertTime, buildTime;
+    bool correct = true;
+
+    {
+        Heap heap(keys.begin(), keys.end());
+    }
+    {
+        Heap heap;
+        insertTime = Measure([&]() {
+            for (const KeyType& key : keys) {
+                heap.Insert(key);
+            }
+        });
+        correct = correct && heap.Size() == keys.size() && heap.GetMin() == minimum;
+    }
+    {
+        Heap heap;
+        buildTime = Measure([&]() { heap.InsertBatch(keys.begin(), keys.end()); });
+        correct = correct && heap.Size() == keys.size() && heap.GetMin() == minimum;
+    }
+
+    std::cout << name << "\t" << insertTime << "\t" << buildTime << (correct ? "" : "\t(wrong)") << "\n";
+}
+
+// Meld of a heap of ascending insertions with one of descending ones, then
+// a copy of the result: the long paths of skew and leftist heaps, time in
+// microseconds and milliseconds
+template <typename Heap>
+void BenchmarkLongPaths(const std::string& name, KeyType size)
+{
+    Heap lhs, rhs;
+    for (KeyType i = 0; i < size; i++) {
+        lhs.Insert(2 * i);
+        rhs.Insert(2 * (size - i) - 1);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    lhs.Meld(rhs);
+    auto middle = std::chrono::steady_clock::now();
+    Heap copy(lhs);
+    auto end = std::chrono::steady_clock::now();
+
+    std::cout << name << "\t" << std::chrono::duration_cast<std::chrono::microseconds>(middle - start).count()
+              << "\t" << std::chrono::duration_cast<std::chrono::milliseconds>(end - middle).count()
+              << (lhs.Size() == copy.Size() && copy.GetMin() == 0 ? "" : "\t(wrong)") << "\n";
+}
+
+// One heap under one lock, the baseline for MultiQueue
+template <typename Heap>
+class LockedHeap {
+
+private:
+    std::mutex _mutex;
+    Heap _heap;
+
+public:
+    explicit LockedHeap(size_t) {}
+
+    void Insert(const KeyType& key)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _heap.Insert(key);
+    }
+
+    bool TryExtractMin(KeyType& key)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_heap.Empty()) {
+            return false;
+        }
+        key = _heap.ExtractMin();
+        return true;
+    }
+};
+
+// Every thread alternates Insert and ExtractMin on a queue prefilled with
+// keys; millions of operations per second over all threads
+template <typename Queue>
+double MeasureThroughput(size_t numberOfThreads, const std::vector<KeyType>& keys, size_t operations)
+{
+    Queue queue(2 * numberOfThreads);
+    for (const KeyType& key : keys) {
+        queue.Insert(key);
+    }
+
+    std::vector<std::thread> threads;
+    long long time = Measure([&]() {
+        for (size_t t = 0; t < numberOfThreads; t++) {
+            threads.emplace_back([&queue, &keys, operations, numberOfThreads, t]() {
+                KeyType key = 0;
+                for (size_t i = t; i < operations; i += numberOfThreads) {
+                    if (i % 2 == 0) {
+                        queue.Insert(key + keys[i % keys.size()] % 1024);
+                    } else {
+                        queue.TryExtractMin(key);
+                    }
+                }
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+    });
+
+    return operations / (1000.0 * std::max<long long>(time, 1));
+}
+
+// Random directed graph in adjacency arrays: edges of vertex v are
+// [offsets[v], offsets[v + 1])
+struct Graph {
+    std::vector<size_t> offsets;
+    std::vector<unsigned> targets;
+    std::vector<unsigned> weights;
+};
+
+Graph RandomGraph(size_t vertices, size_t degree, std::mt19937& gen)
+{
+    Graph graph;
+    graph.offsets.resize(vertices + 1);
+    for (size_t v = 0; v <= vertices; v++) {
+        graph.offsets[v] = v * degree;
+    }
+    graph.targets.resize(vertices * degree);
+    graph.weights.resize(vertices * degree);
+    for (size_t e = 0; e < vertices * degree; e++) {
+        graph.targets[e] = gen() % vertices;
+        graph.weights[e] = gen() % 1000000 + 1;
+    }
+    return graph;
+}
+
+using PathKey = std::pair<long long, unsigned>; // Distance and vertex
+const long long Unreachable = std::numeric_limits<long long>::max();
+
+// Dijkstra that inserts a vertex again on every improvement and skips
+// stale entries; maxSize gets the largest size of the heap
+template <typename Heap>
+std::vector<long long> FindDistancesLazy(const Graph& graph, size_t& maxSize)
+{
+    std::vector<long long> distances(graph.offsets.size() - 1, Unreachable);
+    Heap heap;
+    distances[0] = 0;
+    heap.Insert(PathKey(0, 0));
+    maxSize = 1;
+
+    while (!heap.Empty()) {
+        PathKey top = heap.ExtractMin();
+        if (top.first > distances[top.second]) {
+            continue;
+        }
+        for (size_t e = graph.offsets[top.second]; e < graph.offsets[top.second + 1]; e++) {
+            long long distance = top.first + graph.weights[e];
+            unsigned target = graph.targets[e];
+            if (distance < distances[target]) {
+                distances[target] = distance;
+                heap.Insert(PathKey(distance, target));
+            }
+        }
+        maxSize = std::max(maxSize, heap.Size());
+    }
+    return distances;
+}
+
+// Dijkstra that keeps every vertex in the heap at most once and decreases
+// its key through the handle
+template <typename Heap>
+std::vector<long long> FindDistancesWithHandles(const Graph& graph, size_t& maxSize)
+{
+    std::vector<long long> distances(graph.offsets.size() - 1, Unreachable);
+    std::vector<typename Heap::Handle> handles(distances.size());
+    std::vector<bool> done(distances.size(), false);
+    Heap heap;
+    distances[0] = 0;
+    handles[0] = heap.Insert(PathKey(0, 0));
+    maxSize = 1;
+
+    while (!heap.Empty()) {
+        PathKey top = heap.ExtractMin();
+        done[top.second] = true;
+        for (size_t e = graph.offsets[top.second]; e < graph.offsets[top.second + 1]; e++) {
+            long long distance = top.first + graph.weights[e];
+            unsigned target = graph.targets[e];
+            if (done[target] || distance >= distances[target]) {
+                continue;
+            }
+            if (distances[target] == Unreachable) {
+                handles[target] = heap.Insert(PathKey(distance, target));
+            } else {
+                heap.DecreaseKey(handles[target], PathKey(distance, target));
+            }
+            distances[target] = distance;
+        }
+        maxSize = std::max(maxSize, heap.Size());
+    }
+    return distances;
+}
+
+// Lazy Dijkstra on one integer key per entry, the distance above the
+// vertex bits, for heaps of unsigned keys. Extracted keys never decrease
+template <typename Heap>
+std::vector<long long> FindDistancesPacked(const Graph& graph, size_t& maxSize)
+{
+    using PackedKey = unsigned long long;
+
+    std::vector<long long> distances(graph.offsets.size() - 1, Unreachable);
+    size_t shift = 0;
+    while ((size_t(1) << shift) < distances.size()) {
+        shift++;
+    }
+    const PackedKey vertexMask = (PackedKey(1) << shift) - 1;
+
+    Heap heap;
+    distances[0] = 0;
+    heap.Insert(PackedKey(0));
+    maxSize = 1;
+
+    while (!heap.Empty()) {
+        PackedKey top = heap.ExtractMin();
+        long long distance = static_cast<long long>(top >> shift);
+        unsigned vertex = static_cast<unsigned>(top & vertexMask);
+        if (distance > distances[vertex]) {
+            continue;
+        }
+        for (size_t e = graph.offsets[vertex]; e < graph.offsets[vertex + 1]; e++) {
+            long long next = distance + graph.weights[e];
+            unsigned target = graph.targets[e];
+            if (next < distances[target]) {
+                distances[target] = next;
+                heap.Insert((PackedKey(next) << shift) | target);
+            }
+        }
+        maxSize = std::max(maxSize, heap.Size());
+    }
+    return distances;
+}
+
+template <typename Heap>
+void BenchmarkPackedPaths(const std::string& name, const Graph& graph, const std::vector<long long>& expected)
+{
+    std::vector<long long> distances;
+    size_t maxSize;
+
+    long long time = Measure([&]() { distances = FindDistancesPacked<Heap>(graph, maxSize); });
+
+    std::cout << name << "\t" << time << (distances == expected ? "" : "(wrong)") << "\t" << maxSize << "\n";
+}
+
+// Time in ms and the largest heap size, lazy deletion against handles
+template <typename Heap>
+void BenchmarkShortestPaths(const std::string& name, const Graph& graph, const std::vector<long long>& expected)
+{
+    std::vector<long long> distances;
+    size_t maxSize[2];
+
+    long long lazyTime = Measure([&]() { distances = FindDistancesLazy<Heap>(graph, maxSize[0]); });
+    bool lazyCorrect = (distances == expected);
+    long long handleTime = Measure([&]() { distances = FindDistancesWithHandles<Heap>(graph, maxSize[1]); });
+    bool handleCorrect = (distances == expected);
+
+    std::cout << name << "\t" << lazyTime << (lazyCorrect ? "" : "(wrong)") << "\t" << maxSize[0]
+              << "\t" << handleTime << (handleCorrect ? "" : "(wrong)") << "\t" << maxSize[1] << "\n";
+}
+
+// Usage: HeapsBenchmark [number of keys] [graph vertices] [largest batch]
+int main(int argc, char ** argv) {
+
+    size_t size = (argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000);
+    size_t vertices = (argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1000000);
+    size_t maxBatch = (argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 10000000);
+
+    std::mt19937 gen(2019);
+    std::vector<KeyType> keys(size);
+    for (KeyType& key : keys) {
+        key = static_cast<KeyType>(gen() >> 1);
+    }
+    std::vector<KeyType> sorted = keys;
+    std::sort(sorted.begin(), sorted.end());
+
+    std::cout << size << " random keys, time in ms\nheap\tinsert\textract\n";
+
+    BenchmarkInsertExtract<DaryHeap<KeyType, HeapCompare, 4>>("4-ary", keys, sorted);
+    BenchmarkInsertExtract<DaryHeap<KeyType, HeapCompare, 8>>("8-ary", keys, sorted);
+    BenchmarkInsertExtract<BinomialHeap<KeyType, HeapCompare>>("binomial", keys, sorted);
+    BenchmarkInsertExtract<LeftistHeap<KeyType, HeapCompare>>("leftist", keys, sorted);
+    BenchmarkInsertExtract<SkewHeap<KeyType, HeapCompare>>("skew", keys, sorted);
+    BenchmarkInsertExtract<PairingHeap<KeyType, HeapCompare>>("pairing", keys, sorted);
+    BenchmarkInsertExtract<FibonacciHeap<KeyType, HeapCompare>>("fibonacci", keys, sorted);
+    BenchmarkInsertExtract<StlHeap<KeyType, HeapCompare>>("stl", keys, sorted);
+
+    std::cout << "\nnodes from new and from a pool, time in ms\nheap\tinsert\textract\n";
+
+    BenchmarkInsertExtract<BinomialHeap<KeyType, HeapCompare>>("binomial", keys, sorted);
+    BenchmarkInsertExtract<BinomialHeap<KeyType, HeapCompare, PoolAllocator<KeyType>>>("pool", keys, sorted);
+    BenchmarkInsertExtract<LeftistHeap<KeyType, HeapCompare>>("leftist", keys, sorted);
+    BenchmarkInsertExtract<LeftistHeap<KeyType, HeapCompare, PoolAllocator<KeyType>>>("pool", keys, sorted);
+    BenchmarkInsertExtract<SkewHeap<KeyType, HeapCompare>>("skew", keys, sorted);
+    BenchmarkInsertExtract<SkewHeap<KeyType, HeapCompare, PoolAllocator<KeyType>>>("pool", keys, sorted);
+    BenchmarkInsertExtract<PairingHeap<KeyType, HeapCompare>>("pairing", keys, sorted);
+    BenchmarkInsertExtract<PairingHeap<KeyType, HeapCompare, PoolAllocator<KeyType>>>("pool", keys, sorted);
+    BenchmarkInsertExtract<FibonacciHeap<KeyType, HeapCompare>>("fibonacci", keys, sorted);
+    BenchmarkInsertExtract<FibonacciHeap<KeyType, HeapCompare, PoolAllocator<KeyType>>>("pool", keys, sorted);
+
+    std::cout << "\nstatic and virtual calls, ns per operation\nheap\tinsert\textract\tvirtual insert\tvirtual extract\n";
+
+    BenchmarkStaticVirtual<DaryHeap<KeyType, HeapCompare, 4>>("4-ary", keys, sorted);
+    BenchmarkStaticVirtual<DaryHeap<KeyType, HeapCompare, 8>>("8-ary", keys, sorted);
+    BenchmarkStaticVirtual<BinomialHeap<KeyType, HeapCompare>>("binomial", keys, sorted);
+    BenchmarkStaticVirtual<SkewHeap<KeyType, HeapCompare>>("skew", keys, sorted);
+
+    for (size_t batch = 1000000; batch <= maxBatch; batch *= 10) {
+        std::vector<KeyType> batchKeys(batch);
+        for (KeyType& key : batchKeys) {
+            key = static_cast<KeyType>(gen() >> 1);
+        }
+        KeyType minimum = *std::min_element(batchKeys.begin(), batchKeys.end());
+
+        std::cout << "\nbuilding of " << batch << " keys, time in ms\nheap\tinsert\tbatch\n";
+
+        BenchmarkBuild<DaryHeap<KeyType, HeapCompare, 4>>("4-ary", batchKeys, minimum);
+        BenchmarkBuild<BinomialHeap<KeyType, HeapCompare>>("binomial", batchKeys, minimum);
+        BenchmarkBuild<LeftistHeap<KeyType, HeapCompare>>("leftist", batchKeys, minimum);
+        BenchmarkBuild<SkewHeap<KeyType, HeapCompare>>("skew", batchKeys, minimum);
+        BenchmarkBuild<PairingHeap<KeyType, HeapCompare>>("pairing", batchKeys, minimum);
+        BenchmarkBuild<FibonacciHeap<KeyType, HeapCompare>>("fibonacci", batchKeys, minimum);
+        BenchmarkBuild<StlHeap<KeyType, HeapCompare>>("stl", batchKeys, minimum);
+    }
+
+    const KeyType pathLength = 1000000;
+    std::cout << "\nsorted heaps of " << pathLength << " keys each\nheap\tmeld us\tcopy ms\n";
+
+    BenchmarkLongPaths<SkewHeap<KeyType, HeapCompare>>("skew", pathLength);
+    BenchmarkLongPaths<LeftistHeap<KeyType, HeapCompare>>("leftist", pathLength);
+    BenchmarkLongPaths<SkewHeap<KeyType, HeapCompare, PoolAllocator<KeyType>>>("pool skew", pathLength);
+    BenchmarkLongPaths<LeftistHeap<KeyType, HeapCompare, PoolAllocator<KeyType>>>("pool leftist", pathLength);
+
+    const size_t operations = 4000000;
+    std::vector<KeyType> prefill(keys.begin(), keys.begin() + std::min<size_t>(keys.size(), 100000));
+
+    std::cout << "\nconcurrent queues, " << std::thread::hardware_concurrency() << " hardware threads, "
+              << operations << " operations, millions per second\nthreads\tlocked binomial\tmultiqueue\n";
+
+    for (size_t numberOfThreads : {1, 2, 4, 8, 16, 64}) {
+        double locked = MeasureThroughput<LockedHeap<BinomialHeap<KeyType, HeapCompare>>>(numberOfThreads, prefill, operations);
+        double relaxed = MeasureThroughput<MultiQueue<KeyType, HeapCompare>>(numberOfThreads, prefill, operations);
+        std::cout << numberOfThreads << "\t" << locked << "\t" << relaxed << "\n";
+    }
+
+    const size_t degree = 8;
+    Graph graph = RandomGraph(vertices, degree, gen);
+    size_t maxSize;
+    std::vector<long long> expected = FindDistancesLazy<DaryHeap<PathKey>>(graph, maxSize);
+
+    std::cout << "\nshortest paths, " << vertices << " vertices, " << vertices * degree << " edges, time in ms\n";
+    std::cout << "heap\tlazy\tmax size\thandles\tmax size\n";
+
+    BenchmarkShortestPaths<BinomialHeap<PathKey>>("binomial", graph, expected);
+    BenchmarkShortestPaths<LeftistHeap<PathKey>>("leftist", graph, expected);
+    BenchmarkShortestPaths<SkewHeap<PathKey>>("skew", graph, expected);
+    BenchmarkShortestPaths<PairingHeap<PathKey>>("pairing", graph, expected);
+    BenchmarkShortestPaths<FibonacciHeap<PathKey>>("fibonacci", graph, expected);
+    BenchmarkShortestPaths<BinomialHeap<PathKey, std::less<PathKey>, PoolAllocator<PathKey>>>("pool binomial", graph, expected);
+    BenchmarkShortestPaths<PairingHeap<PathKey, std::less<PathKey>, PoolAllocator<PathKey>>>("pool pairing", graph, expected);
+
+    long long time = Measure([&]() { FindDistancesLazy<DaryHeap<PathKey>>(graph, maxSize); });
+    std::cout << "d-ary\t" << time << "\t" << maxSize << "\t-\t-\n";
+
+    std::cout << "\nshortest paths on integer keys, time in ms\n";
+    std::cout << "heap\tlazy\tmax size\n";
+
+    BenchmarkPackedPaths<RadixHeap<unsigned long long>>("radix", graph, expected);
+    BenchmarkPackedPaths<BinomialHeap<unsigned long long>>("binomial", graph, expected);
+    BenchmarkPackedPaths<DaryHeap<unsigned long long>>("d-ary", graph, expected);
+    BenchmarkPackedPaths<StlHeap<unsigned long long>>("stl", graph, expected);
+
+    return 0;
+}
@@ -11,10 +11,14 @@
 
 #include <iostream>
 #include <algorithm>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <vector>
 #include "IHeap.h"
 
-template <typename T = int, typename Compare = std::less<T>>
-class BinomialHeap : public IHeap<T, Compare> {
+template <typename T = int, typename Compare = std::less<T>, typename Allocator = std::allocator<T>>
+class BinomialHeap : public StaticHeap<BinomialHeap<T, Compare, Allocator>, T, Compare>, private CompareHolder<Compare> {
     
 private:
 // Private functions and classes
@@ -23,54 +27,93 @@ private:
     
     using _HeapNodePtr = _HeapNode*;
     
-    static void _ClearNodes(_HeapNodePtr&);
+    using _NodeAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<_HeapNode>;
+    using _NodeTraits = std::allocator_traits<_NodeAllocator>;
+    
+    _HeapNodePtr _NewNode(const T&);
+    
+    void _DeleteNode(_HeapNodePtr);
+    
+    void _ClearNodes(_HeapNodePtr&);
     
     template <typename T2>
-    static T2 _FindMin(T2);
+    T2 _FindMin(T2) const;
+    
+    bool _Compare(const T&, const T&) const;
     
-    static std::function<bool(const T&, const T&)> _Compare;
+    void _MergeRoots(_HeapNodePtr, size_t);
     
-    static void _Merge(BinomialHeap<T, Compare>&, BinomialHeap<T, Compare>&);
+    _HeapNodePtr _LinkTrees(_HeapNodePtr, _HeapNodePtr) const;
+    
+    template <typename Iterator>
+    void _Build(Iterator, Iterator);
+    
+    static void _Merge(BinomialHeap<T, Compare, Allocator>&, BinomialHeap<T, Compare, Allocator>&);
 
-    static void _Copy(_HeapNodePtr&, const _HeapNodePtr&);
+    void _Copy(_HeapNodePtr&, const _HeapNodePtr&, _HeapNodePtr);
+    
+    _HeapNodePtr * _FindLink(_HeapNodePtr);
+    
+    void _SwapWithParent(_HeapNodePtr);
+    
+    void _SiftUp(_HeapNodePtr, bool);
+    
+    _HeapNodePtr _RemoveRoot(_HeapNodePtr&);
     
 // Struct fields
     
-    _HeapNodePtr _root; // Tree root
-    size_t _size;       // Size of tree
+    _HeapNodePtr _root;         // Tree root
+    size_t _size;               // Size of tree
+    _NodeAllocator _allocator;  // Allocator of nodes
     
 public:
 // Public methods
     
+    using Handle = HeapHandle<_HeapNode>;
+    
     BinomialHeap();
-    BinomialHeap(const T&);
+    explicit BinomialHeap(const Allocator&);
+    explicit BinomialHeap(const Compare&, const Allocator& = Allocator());
+    BinomialHeap(const T&, const Allocator& = Allocator());
+    template <typename Iterator>
+    BinomialHeap(Iterator, Iterator, const Allocator& = Allocator());
     BinomialHeap(const BinomialHeap&);
     
-    ~BinomialHeap() override;
+    ~BinomialHeap();
+    
+    Handle Insert(const T&);
+    
+    template <typename Iterator>
+    void InsertBatch(Iterator, Iterator);
+    
+    T GetMin() const;
     
-    void Insert(const T&) override;
+    T ExtractMin();
     
-    T GetMin() const override;
+    void DecreaseKey(Handle, const T&);
     
-    T ExtractMin() override;
+    void Erase(Handle);
     
-    void Meld(IHeap<T, Compare>&) override;
+    void Meld(BinomialHeap&);
     
-    bool Empty() const override;
+    bool Empty() const;
     
-    size_t Size() const override;
+    size_t Size() const;
+    
+    Allocator GetAllocator() const;
     
     BinomialHeap& operator = (const BinomialHeap&);
 };
 
-template <typename T, typename Compare>
-class BinomialHeap<T, Compare>::_HeapNode {
+template <typename T, typename Compare, typename Allocator>
+class BinomialHeap<T, Compare, Allocator>::_HeapNode {
 public:
 // Class Fields
     
     T _key_;                // Key
     _HeapNodePtr _child_;   // Left Child
     _HeapNodePtr _sibling_; // Brother
+    _HeapNodePtr _parent_;  // Parent, nullptr for roots
     size_t _degree_;        // Degree of this vertex
     
 // Constructors and Destructor
@@ -82,11 +125,34 @@ public:
     ~_HeapNode() = default;
 };
 
-template <typename T, typename Compare>
-std::function<bool(const T&, const T&)> BinomialHeap<T, Compare>::_Compare = Compare();
+template <typename T, typename Compare, typename Allocator>
+inline bool BinomialHeap<T, Compare, Allocator>::_Compare(const T& lhs, const T& rhs) const
+{
+    return this->GetCompare()(lhs, rhs);
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename BinomialHeap<T, Compare, Allocator>::_HeapNodePtr BinomialHeap<T, Compare, Allocator>::_NewNode(const T& key)
+{
+    _HeapNodePtr ptr = _NodeTraits::allocate(_allocator, 1);
+    try {
+        _NodeTraits::construct(_allocator, ptr, key);
+    } catch (...) {
+        _NodeTraits::deallocate(_allocator, ptr, 1);
+        throw;
+    }
+    return ptr;
+}
+
+template <typename T, typename Compare, typename Allocator>
+void BinomialHeap<T, Compare, Allocator>::_DeleteNode(_HeapNodePtr ptr)
+{
+    _NodeTraits::destroy(_allocator, ptr);
+    _NodeTraits::deallocate(_allocator, ptr, 1);
+}
 
-template <typename T, typename Compare>
-void BinomialHeap<T, Compare>::_ClearNodes(_HeapNodePtr& vertex)
+template <typename T, typename Compare, typename Allocator>
+void BinomialHeap<T, Compare, Allocator>::_ClearNodes(_HeapNodePtr& vertex)
 {
     if (!vertex) {
         return;
@@ -95,14 +161,14 @@ void BinomialHeap<T, Compare>::_ClearNodes(_HeapNodePtr& vertex)
     _ClearNodes(vertex->_child_);
     _ClearNodes(vertex->_sibling_);
     
-    delete vertex;
+    _DeleteNode(vertex);
     
     vertex = nullptr;
 }
 
-template <typename T, typename Compare>
+template <typename T, typename Compare, typename Allocator>
 template <typename T2>
-T2 BinomialHeap<T, Compare>::_FindMin(T2 ptr)
+T2 BinomialHeap<T, Compare, Allocator>::_FindMin(T2 ptr) const
 {
     if (!ptr->_sibling_) {
         return ptr;
@@ -115,22 +181,23 @@ T2 BinomialHeap<T, Compare>::_FindMin(T2 ptr)
     }
 }
 
-template <typename T, typename Compare>
-void BinomialHeap<T, Compare>::_Merge(BinomialHeap<T, Compare>& lhs, BinomialHeap<T, Compare>& rhs)
+// Merges the list of roots of size keys (in increasing order of degrees)
+// into the heap
+template <typename T, typename Compare, typename Allocator>
+void BinomialHeap<T, Compare, Allocator>::_MergeRoots(_HeapNodePtr roots, size_t size)
 {
-    if (lhs.Empty()) {
-        lhs._root = rhs._root;
-        lhs._size = rhs._size;
-        rhs._root = nullptr;
+    if (!roots) {
         return;
-    } else if (rhs.Empty()) {
+    } else if (!_root) {
+        _root = roots;
+        _size += size;
         return;
     }
 
     _HeapNodePtr result = nullptr;
     _HeapNodePtr * ptr = &result;
-    _HeapNodePtr l_ptr = lhs._root;
-    _HeapNodePtr r_ptr = rhs._root;
+    _HeapNodePtr l_ptr = _root;
+    _HeapNodePtr r_ptr = roots;
     
     
     while (l_ptr || r_ptr) {
@@ -159,36 +226,192 @@ void BinomialHeap<T, Compare>::_Merge(BinomialHeap<T, Compare>& lhs, BinomialHea
             _HeapNodePtr temp = (*ptr)->_sibling_;
             (*ptr)->_sibling_ = temp->_sibling_;
             temp->_sibling_ = (*ptr)->_child_;
+            temp->_parent_ = (*ptr);
             (*ptr)->_child_ = temp;
             (*ptr)->_degree_++;
         } else {
             _HeapNodePtr temp = (*ptr)->_sibling_;
             (*ptr)->_sibling_ = temp->_child_;
+            (*ptr)->_parent_ = temp;
             temp->_child_ = (*ptr);
             temp->_degree_++;
             (*ptr) = temp;
         }
     }
     
-    lhs._root = result;
-    lhs._size += rhs._size;
+    _root = result;
+    _size += size;
+}
+
+// Links two trees of equal degree, the larger root becomes the first child
+template <typename T, typename Compare, typename Allocator>
+typename BinomialHeap<T, Compare, Allocator>::_HeapNodePtr BinomialHeap<T, Compare, Allocator>::_LinkTrees(_HeapNodePtr lhs, _HeapNodePtr rhs) const
+{
+    if (_Compare(rhs->_key_, lhs->_key_)) {
+        std::swap(lhs, rhs);
+    }
+    rhs->_sibling_ = lhs->_child_;
+    rhs->_parent_ = lhs;
+    lhs->_child_ = rhs;
+    lhs->_degree_++;
+    return lhs;
+}
+
+// Adds the keys like a binary counter adds ones: trees[k] is the tree of
+// degree k, and a new node carries through the filled ones. n additions
+// carry n times in total, so the trees are built in O(n); then they are
+// merged into the heap at once
+template <typename T, typename Compare, typename Allocator>
+template <typename Iterator>
+void BinomialHeap<T, Compare, Allocator>::_Build(Iterator first, Iterator last)
+{
+    std::vector<_HeapNodePtr> trees;
+    size_t size = 0;
+    
+    for (; first != last; ++first) {
+        _HeapNodePtr tree = _NewNode(*first);
+        size++;
+        
+        size_t degree = 0;
+        while (degree < trees.size() && trees[degree]) {
+            tree = _LinkTrees(trees[degree], tree);
+            trees[degree++] = nullptr;
+        }
+        if (degree == trees.size()) {
+            trees.push_back(nullptr);
+        }
+        trees[degree] = tree;
+    }
+    
+    _HeapNodePtr roots = nullptr;
+    for (size_t degree = trees.size(); degree-- > 0; ) {
+        if (trees[degree]) {
+            trees[degree]->_sibling_ = roots;
+            roots = trees[degree];
+        }
+    }
+    
+    _MergeRoots(roots, size);
+}
+
+template <typename T, typename Compare, typename Allocator>
+void BinomialHeap<T, Compare, Allocator>::_Merge(BinomialHeap<T, Compare, Allocator>& lhs, BinomialHeap<T, Compare, Allocator>& rhs)
+{
+    if (&lhs == &rhs) {
+        return;
+    }
+    if (lhs._allocator != rhs._allocator) {
+        // Nodes of rhs can't be freed by lhs, so it gets their copies
+        BinomialHeap<T, Compare, Allocator> copy(lhs.GetAllocator());
+        copy = rhs;
+        rhs._ClearNodes(rhs._root);
+        rhs._size = 0;
+        _Merge(lhs, copy);
+        return;
+    }
+    
+    lhs._MergeRoots(rhs._root, rhs._size);
     
     rhs._root = nullptr;
+    rhs._size = 0;
 }
 
-template <typename T, typename Compare>
-void BinomialHeap<T, Compare>::_Copy(_HeapNodePtr& lhs, const _HeapNodePtr& rhs)
+template <typename T, typename Compare, typename Allocator>
+void BinomialHeap<T, Compare, Allocator>::_Copy(_HeapNodePtr& lhs, const _HeapNodePtr& rhs, _HeapNodePtr parent)
 {
     if (rhs == nullptr) {
         lhs = nullptr;
         return;
     }
     
-    lhs = new _HeapNode(rhs->_key_);
+    lhs = _NewNode(rhs->_key_);
     lhs->_degree_ = rhs->_degree_;
+    lhs->_parent_ = parent;
+    
+    _Copy(lhs->_child_, rhs->_child_, lhs);
+    _Copy(lhs->_sibling_, rhs->_sibling_, parent);
+}
+
+// The pointer to node: in the list of roots or of children of its parent
+template <typename T, typename Compare, typename Allocator>
+typename BinomialHeap<T, Compare, Allocator>::_HeapNodePtr * BinomialHeap<T, Compare, Allocator>::_FindLink(_HeapNodePtr node)
+{
+    _HeapNodePtr * link = (node->_parent_ ? &node->_parent_->_child_ : &_root);
+    while ((*link) != node) {
+        link = &(*link)->_sibling_;
+    }
+    return link;
+}
+
+// Exchanges node with its parent in the tree. Children lists are ordered
+// by decreasing degree, so the scans of them along a path to the root
+// take O(log n) in total
+template <typename T, typename Compare, typename Allocator>
+void BinomialHeap<T, Compare, Allocator>::_SwapWithParent(_HeapNodePtr node)
+{
+    _HeapNodePtr parent = node->_parent_;
+    _HeapNodePtr * parent_link = _FindLink(parent);
+    _HeapNodePtr * node_link = _FindLink(node);
+    
+    _HeapNodePtr child = node->_child_;
+    _HeapNodePtr sibling = node->_sibling_;
+    size_t degree = node->_degree_;
+    
+    // node takes the place of parent, and parent the place of node
+    (*parent_link) = node;
+    node->_parent_ = parent->_parent_;
+    node->_sibling_ = parent->_sibling_;
+    node->_degree_ = parent->_degree_;
+    (*node_link) = parent;
+    node->_child_ = parent->_child_;
+    
+    parent->_child_ = child;
+    parent->_sibling_ = sibling;
+    parent->_degree_ = degree;
+    
+    for (_HeapNodePtr ptr = node->_child_; ptr != nullptr; ptr = ptr->_sibling_) {
+        ptr->_parent_ = node;
+    }
+    for (_HeapNodePtr ptr = parent->_child_; ptr != nullptr; ptr = ptr->_sibling_) {
+        ptr->_parent_ = parent;
+    }
+}
+
+// Moves node up while it is less than its parent, or up to the root
+template <typename T, typename Compare, typename Allocator>
+void BinomialHeap<T, Compare, Allocator>::_SiftUp(_HeapNodePtr node, bool to_root)
+{
+    while (node->_parent_ && (to_root || _Compare(node->_key_, node->_parent_->_key_))) {
+        _SwapWithParent(node);
+    }
+}
+
+// Unlinks the root by the pointer to it and puts its children to the roots
+template <typename T, typename Compare, typename Allocator>
+typename BinomialHeap<T, Compare, Allocator>::_HeapNodePtr BinomialHeap<T, Compare, Allocator>::_RemoveRoot(_HeapNodePtr& root)
+{
+    // Children of the root, reversed to increasing degrees
+    _HeapNodePtr children = nullptr;
+    size_t children_size = (size_t(1) << root->_degree_) - 1;
+    _size -= children_size + 1;
+    
+    _HeapNodePtr ptr = root->_child_;
+    
+    while (ptr != nullptr) {
+        _HeapNodePtr next = ptr->_sibling_;
+        
+        ptr->_sibling_ = children;
+        ptr->_parent_ = nullptr;
+        children = ptr;
+        ptr = next;
+    }
+    
+    _HeapNodePtr result = root;
+    root = root->_sibling_;
     
-    _Copy(lhs->_child_, rhs->_child_);
-    _Copy(lhs->_sibling_, rhs->_sibling_);
+    _MergeRoots(children, children_size);
+    
+    return result;
 }
 
 
@@ -196,31 +419,51 @@ void BinomialHeap<T, Compare>::_Copy(_HeapNodePtr& lhs, const _HeapNodePtr& rhs)
 // Constructors and Destrcutor
 //
 
-template <typename T, typename Compare>
-BinomialHeap<T, Compare>::_HeapNode::_HeapNode() : _child_(nullptr), _sibling_(nullptr), _degree_(0) {}
+template <typename T, typename Compare, typename Allocator>
+BinomialHeap<T, Compare, Allocator>::_HeapNode::_HeapNode() : _child_(nullptr), _sibling_(nullptr), _parent_(nullptr), _degree_(0) {}
+
 
+template <typename T, typename Compare, typename Allocator>
+BinomialHeap<T, Compare, Allocator>::_HeapNode::_HeapNode(const T& key) : _key_(key), _child_(nullptr), _sibling_(nullptr), _parent_(nullptr), _degree_(0) {}
 
-template <typename T, typename Compare>
-BinomialHeap<T, Compare>::_HeapNode::_HeapNode(const T& key) : _key_(key), _child_(nullptr), _sibling_(nullptr), _degree_(0) {}
 
+template <typename T, typename Compare, typename Allocator>
+BinomialHeap<T, Compare, Allocator>::BinomialHeap() : _root(nullptr), _size(0) {}
 
-template <typename T, typename Compare>
-BinomialHeap<T, Compare>::BinomialHeap() : _root(nullptr), _size(0) {}
 
+template <typename T, typename Compare, typename Allocator>
+BinomialHeap<T, Compare, Allocator>::BinomialHeap(const Allocator& allocator) : _root(nullptr), _size(0), _allocator(allocator) {}
 
-template <typename T, typename Compare>
-BinomialHeap<T, Compare>::BinomialHeap(const T& key) : _root(new _HeapNode(key)), _size(1) {}
+template <typename T, typename Compare, typename Allocator>
+BinomialHeap<T, Compare, Allocator>::BinomialHeap(const Compare& compare, const Allocator& allocator) : CompareHolder<Compare>(compare),
+    _root(nullptr), _size(0), _allocator(allocator) {}
+
+
+template <typename T, typename Compare, typename Allocator>
+BinomialHeap<T, Compare, Allocator>::BinomialHeap(const T& key, const Allocator& allocator) : _root(nullptr), _size(1), _allocator(allocator)
+{
+    _root = _NewNode(key);
+}
+
+
+template <typename T, typename Compare, typename Allocator>
+template <typename Iterator>
+BinomialHeap<T, Compare, Allocator>::BinomialHeap(Iterator first, Iterator last, const Allocator& allocator) : _root(nullptr), _size(0), _allocator(allocator)
+{
+    _Build(first, last);
+}
 
 
-template <typename T, typename Compare>
-BinomialHeap<T, Compare>::BinomialHeap(const BinomialHeap<T, Compare>& rhs) : _root(nullptr), _size(0)
+template <typename T, typename Compare, typename Allocator>
+BinomialHeap<T, Compare, Allocator>::BinomialHeap(const BinomialHeap<T, Compare, Allocator>& rhs) : CompareHolder<Compare>(rhs), _root(nullptr), _size(0),
+    _allocator(_NodeTraits::select_on_container_copy_construction(rhs._allocator))
 {
     (*this) = rhs;
 }
 
 
-template <typename T, typename Compare>
-BinomialHeap<T, Compare>::~BinomialHeap()
+template <typename T, typename Compare, typename Allocator>
+BinomialHeap<T, Compare, Allocator>::~BinomialHeap()
 {
     _ClearNodes(_root);
     _size = 0;
@@ -230,90 +473,102 @@ BinomialHeap<T, Compare>::~BinomialHeap()
 // Public methods
 //
 
-template <typename T, typename Compare>
-BinomialHeap<T, Compare>& BinomialHeap<T, Compare>::operator = (const BinomialHeap<T, Compare>& rhs)
+template <typename T, typename Compare, typename Allocator>
+BinomialHeap<T, Compare, Allocator>& BinomialHeap<T, Compare, Allocator>::operator = (const BinomialHeap<T, Compare, Allocator>& rhs)
 {
     if (this == &rhs) {
         return (*this);
     }
     
     _ClearNodes(_root);
+    static_cast<CompareHolder<Compare>&>(*this) = rhs;
     _size = rhs.Size();
-    _Copy(_root, rhs._root);
+    _Copy(_root, rhs._root, nullptr);
     
     return (*this);
 }
 
-template <typename T, typename Compare>
-size_t BinomialHeap<T, Compare>::Size() const
+template <typename T, typename Compare, typename Allocator>
+size_t BinomialHeap<T, Compare, Allocator>::Size() const
 {
     return _size;
 }
 
-template <typename T, typename Compare>
-bool BinomialHeap<T, Compare>::Empty() const
+template <typename T, typename Compare, typename Allocator>
+bool BinomialHeap<T, Compare, Allocator>::Empty() const
 {
     return _size == 0;
 }
 
-template <typename T, typename Compare>
-void BinomialHeap<T, Compare>::Insert(const T& element)
+template <typename T, typename Compare, typename Allocator>
+Allocator BinomialHeap<T, Compare, Allocator>::GetAllocator() const
 {
-    BinomialHeap<T, Compare> rhs(element);
-    _Merge((*this), rhs);
+    return Allocator(_allocator);
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename BinomialHeap<T, Compare, Allocator>::Handle BinomialHeap<T, Compare, Allocator>::Insert(const T& element)
+{
+    _HeapNodePtr node = _NewNode(element);
+    _MergeRoots(node, 1);
+    return Handle(node);
+}
+
+template <typename T, typename Compare, typename Allocator>
+template <typename Iterator>
+void BinomialHeap<T, Compare, Allocator>::InsertBatch(Iterator first, Iterator last)
+{
+    _Build(first, last);
 }
 
-template <typename T, typename Compare>
-T BinomialHeap<T, Compare>::GetMin() const
+template <typename T, typename Compare, typename Allocator>
+T BinomialHeap<T, Compare, Allocator>::GetMin() const
 {
     if (!_root) {
         throw std::range_error("No elements in Heap");
     }
-    return BinomialHeap<T, Compare>::_FindMin(_root)->_key_;
+    return _FindMin(_root)->_key_;
 }
 
-template <typename T, typename Compare>
-T BinomialHeap<T, Compare>::ExtractMin()
+template <typename T, typename Compare, typename Allocator>
+T BinomialHeap<T, Compare, Allocator>::ExtractMin()
 {
     if (!_root) {
         throw std::range_error("No elements in Heap");
     }
     
-    _HeapNodePtr& minimum = BinomialHeap<T, Compare>::_FindMin<_HeapNodePtr&>(_root);
-    
-    BinomialHeap rhs;
-    rhs._size = (1 << minimum->_degree_) - 1;
-    _size -= (1 << minimum->_degree_);
-    
-    _HeapNodePtr ptr = minimum->_child_;
-    
-    while (ptr != nullptr) {
-        _HeapNodePtr next = ptr->_sibling_;
-        
-        ptr->_sibling_ = rhs._root;
-        rhs._root = ptr;
-        ptr = next;
-    }
-    
-    _HeapNodePtr result_node = minimum;
-    minimum = minimum->_sibling_;
-    
-    _Merge((*this), rhs);
+    _HeapNodePtr result_node = _RemoveRoot(_FindMin<_HeapNodePtr&>(_root));
     
     T result = result_node->_key_;
-    delete result_node;
+    _DeleteNode(result_node);
     
     return result;
 }
 
-template <typename T, typename Compare>
-void BinomialHeap<T, Compare>::Meld(IHeap<T, Compare> & rhs)
+// Sifts the node up, O(log n) comparisons
+template <typename T, typename Compare, typename Allocator>
+void BinomialHeap<T, Compare, Allocator>::DecreaseKey(Handle handle, const T& key)
 {
-    try {
-        _Merge((*this), dynamic_cast<BinomialHeap<T, Compare>&>(rhs));
-    } catch (const std::bad_cast& error) {
-        std::cerr << error.what();
-    };
+    _HeapNodePtr node = handle.GetNode();
+    if (_Compare(node->_key_, key)) {
+        throw std::invalid_argument("New key is greater than the old one");
+    }
+    node->_key_ = key;
+    _SiftUp(node, false);
+}
+
+template <typename T, typename Compare, typename Allocator>
+void BinomialHeap<T, Compare, Allocator>::Erase(Handle handle)
+{
+    _HeapNodePtr node = handle.GetNode();
+    _SiftUp(node, true);
+    _DeleteNode(_RemoveRoot(*_FindLink(node)));
+}
+
+template <typename T, typename Compare, typename Allocator>
+void BinomialHeap<T, Compare, Allocator>::Meld(BinomialHeap<T, Compare, Allocator> & rhs)
+{
+    _Merge((*this), rhs);
 }
 
 #endif /* BinomialHeap_h */
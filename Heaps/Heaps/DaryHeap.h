@@ -0,0 +1,331 @@
+//
+//  DaryHeap.h
+//  Heaps
+//
+
+#ifndef DaryHeap_h
+#define DaryHeap_h
+
+#include <iostream>
+#include <algorithm>
+#include <functional>
+#include <vector>
+#include "IHeap.h"
+
+// Default fan-out: all children of a vertex fit in one cache line, but
+// there are at least 2 and at most 8 of them
+template <typename T>
+constexpr size_t DaryHeapArity()
+{
+    return std::max<size_t>(2, std::min<size_t>(8, 64 / sizeof(T)));
+}
+
+template <typename T = int, typename Compare = std::less<T>, size_t Arity = DaryHeapArity<T>()>
+class DaryHeap : public StaticHeap<DaryHeap<T, Compare, Arity>, T, Compare>, private CompareHolder<Compare> {
+
+    static_assert(Arity >= 2, "DaryHeap needs at least two children per vertex");
+
+private:
+// Private functions and classes
+
+    // Children of one vertex, aligned so that they share a cache line
+    struct _Group;
+
+    static constexpr size_t _GroupAlignment();
+
+    bool _Compare(const T&, const T&) const;
+
+    T& _Key(size_t);
+    const T& _Key(size_t) const;
+
+    void _Reserve(size_t);
+
+    void _SiftUp(size_t);
+
+    void _SiftDown(size_t);
+
+    void _Heapify();
+
+    void _Append(size_t);
+
+    static void _Merge(DaryHeap&, DaryHeap&);
+
+// Struct fields
+
+    // Key i is stored at position i + Arity - 1, so the children of key i
+    // (keys Arity * i + 1, ..., Arity * i + Arity) are exactly group i + 1
+    std::vector<_Group> _groups;
+    size_t _size;       // Number of keys
+
+public:
+// Public methods
+
+    DaryHeap();
+    explicit DaryHeap(const Compare&);
+    DaryHeap(const T&);
+    template <typename Iterator>
+    DaryHeap(Iterator, Iterator);
+    DaryHeap(const DaryHeap&) = default;
+
+    ~DaryHeap() = default;
+
+    void Insert(const T&);
+
+    template <typename Iterator>
+    void InsertBatch(Iterator, Iterator);
+
+    T GetMin() const;
+
+    T ExtractMin();
+
+    void Meld(DaryHeap&);
+
+    bool Empty() const;
+
+    size_t Size() const;
+
+    DaryHeap& operator = (const DaryHeap&) = default;
+};
+
+template <typename T, typename Compare, size_t Arity>
+constexpr size_t DaryHeap<T, Compare, Arity>::_GroupAlignment()
+{
+    size_t bytes = Arity * sizeof(T);
+    if (bytes > 64 || (bytes & (bytes - 1)) != 0) {
+        return alignof(T);
+    }
+    return std::max(bytes, alignof(T));
+}
+
+template <typename T, typename Compare, size_t Arity>
+struct DaryHeap<T, Compare, Arity>::_Group {
+    alignas(_GroupAlignment()) T _keys_[Arity];
+};
+
+//
+// Private functions and methods
+//
+
+template <typename T, typename Compare, size_t Arity>
+inline bool DaryHeap<T, Compare, Arity>::_Compare(const T& lhs, const T& rhs) const
+{
+    return this->GetCompare()(lhs, rhs);
+}
+
+template <typename T, typename Compare, size_t Arity>
+T& DaryHeap<T, Compare, Arity>::_Key(size_t index)
+{
+    size_t position = index + Arity - 1;
+    return _groups[position / Arity]._keys_[position % Arity];
+}
+
+template <typename T, typename Compare, size_t Arity>
+const T& DaryHeap<T, Compare, Arity>::_Key(size_t index) const
+{
+    size_t position = index + Arity - 1;
+    return _groups[position / Arity]._keys_[position % Arity];
+}
+
+// Makes room for keys 0, ..., size - 1
+template <typename T, typename Compare, size_t Arity>
+void DaryHeap<T, Compare, Arity>::_Reserve(size_t size)
+{
+    size_t groups = (size + Arity - 2) / Arity + 1;
+    if (_groups.size() < groups) {
+        _groups.resize(groups);
+    }
+}
+
+template <typename T, typename Compare, size_t Arity>
+void DaryHeap<T, Compare, Arity>::_SiftUp(size_t index)
+{
+    T key = std::move(_Key(index));
+
+    while (index > 0) {
+        size_t parent = (index - 1) / Arity;
+        if (!_Compare(key, _Key(parent))) {
+            break;
+        }
+        _Key(index) = std::move(_Key(parent));
+        index = parent;
+    }
+
+    _Key(index) = std::move(key);
+}
+
+template <typename T, typename Compare, size_t Arity>
+void DaryHeap<T, Compare, Arity>::_SiftDown(size_t index)
+{
+    T key = std::move(_Key(index));
+
+    while (index * Arity + 1 < _size) {
+        size_t first = index * Arity + 1;
+        size_t count = std::min(Arity, _size - first);
+        T * children = _groups[index + 1]._keys_;
+
+        size_t best = 0;
+        for (size_t k = 1; k < count; k++) {
+            if (_Compare(children[k], children[best])) {
+                best = k;
+            }
+        }
+        if (!_Compare(children[best], key)) {
+            break;
+        }
+
+        _Key(index) = std::move(children[best]);
+        index = first + best;
+    }
+
+    _Key(index) = std::move(key);
+}
+
+// Floyd's bottom-up construction, O(size) comparisons
+template <typename T, typename Compare, size_t Arity>
+void DaryHeap<T, Compare, Arity>::_Heapify()
+{
+    if (_size <= 1) {
+        return;
+    }
+    for (size_t index = (_size - 2) / Arity + 1; index-- > 0; ) {
+        _SiftDown(index);
+    }
+}
+
+// Restores the order after keys from index first on were appended. Few of
+// them are sifted up one by one, many of them make rebuilding the whole
+// heap cheaper
+template <typename T, typename Compare, size_t Arity>
+void DaryHeap<T, Compare, Arity>::_Append(size_t first)
+{
+    size_t depth = 1;
+    for (size_t level = 1; level < _size; level *= Arity) {
+        depth++;
+    }
+
+    if ((_size - first) * depth > _size) {
+        _Heapify();
+    } else {
+        for (size_t index = first; index < _size; index++) {
+            _SiftUp(index);
+        }
+    }
+}
+
+// Keys of the smaller heap are appended to the larger one
+template <typename T, typename Compare, size_t Arity>
+void DaryHeap<T, Compare, Arity>::_Merge(DaryHeap& lhs, DaryHeap& rhs)
+{
+    if (&lhs == &rhs) {
+        return;
+    }
+    if (lhs._size < rhs._size) {
+        std::swap(lhs._groups, rhs._groups);
+        std::swap(lhs._size, rhs._size);
+    }
+
+    size_t first = lhs._size;
+    lhs._Reserve(lhs._size + rhs._size);
+    for (size_t i = 0; i < rhs._size; i++) {
+        lhs._Key(lhs._size++) = std::move(rhs._Key(i));
+    }
+    lhs._Append(first);
+
+    rhs._groups.clear();
+    rhs._size = 0;
+}
+
+//
+// Constructors
+//
+
+template <typename T, typename Compare, size_t Arity>
+DaryHeap<T, Compare, Arity>::DaryHeap() : _size(0) {}
+
+template <typename T, typename Compare, size_t Arity>
+DaryHeap<T, Compare, Arity>::DaryHeap(const Compare& compare) : CompareHolder<Compare>(compare), _size(0) {}
+
+template <typename T, typename Compare, size_t Arity>
+DaryHeap<T, Compare, Arity>::DaryHeap(const T& key) : _size(0)
+{
+    Insert(key);
+}
+
+// Floyd's construction, O(n)
+template <typename T, typename Compare, size_t Arity>
+template <typename Iterator>
+DaryHeap<T, Compare, Arity>::DaryHeap(Iterator first, Iterator last) : _size(0)
+{
+    InsertBatch(first, last);
+}
+
+//
+// Public methods
+//
+
+template <typename T, typename Compare, size_t Arity>
+size_t DaryHeap<T, Compare, Arity>::Size() const
+{
+    return _size;
+}
+
+template <typename T, typename Compare, size_t Arity>
+bool DaryHeap<T, Compare, Arity>::Empty() const
+{
+    return _size == 0;
+}
+
+template <typename T, typename Compare, size_t Arity>
+void DaryHeap<T, Compare, Arity>::Insert(const T& key)
+{
+    _Reserve(_size + 1);
+    _Key(_size) = key;
+    _SiftUp(_size);
+    _size++;
+}
+
+template <typename T, typename Compare, size_t Arity>
+template <typename Iterator>
+void DaryHeap<T, Compare, Arity>::InsertBatch(Iterator first, Iterator last)
+{
+    size_t begin = _size;
+    for (; first != last; ++first) {
+        _Reserve(_size + 1);
+        _Key(_size++) = (*first);
+    }
+    _Append(begin);
+}
+
+template <typename T, typename Compare, size_t Arity>
+T DaryHeap<T, Compare, Arity>::GetMin() const
+{
+    if (_size == 0) {
+        throw std::range_error("No elements in Heap");
+    }
+    return _Key(0);
+}
+
+template <typename T, typename Compare, size_t Arity>
+T DaryHeap<T, Compare, Arity>::ExtractMin()
+{
+    if (_size == 0) {
+        throw std::range_error("No elements in Heap");
+    }
+
+    T result = std::move(_Key(0));
+    _size--;
+    if (_size > 0) {
+        _Key(0) = std::move(_Key(_size));
+        _SiftDown(0);
+    }
+
+    return result;
+}
+
+template <typename T, typename Compare, size_t Arity>
+void DaryHeap<T, Compare, Arity>::Meld(DaryHeap<T, Compare, Arity> & rhs)
+{
+    _Merge((*this), rhs);
+}
+
+#endif /* DaryHeap_h */
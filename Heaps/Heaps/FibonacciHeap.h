@@ -0,0 +1,552 @@
+//
+//  FibonacciHeap.h
+//  Heaps
+//
+
+#ifndef FibonacciHeap_h
+#define FibonacciHeap_h
+
+#include <iostream>
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "IHeap.h"
+
+// Lazy list of heap-ordered trees. Insert, Meld and DecreaseKey are O(1)
+// amortized; ExtractMin links the trees of equal degree, O(log n) amortized
+template <typename T = int, typename Compare = std::less<T>, typename Allocator = std::allocator<T>>
+class FibonacciHeap : public StaticHeap<FibonacciHeap<T, Compare, Allocator>, T, Compare>, private CompareHolder<Compare> {
+
+private:
+// Private functions and classes
+
+    class _HeapNode;
+
+    using _HeapNodePtr = _HeapNode*;
+
+    using _NodeAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<_HeapNode>;
+    using _NodeTraits = std::allocator_traits<_NodeAllocator>;
+
+    // Degrees are at most log of the size by the golden ratio
+    static const size_t _MaxDegree = 96;
+
+    bool _Compare(const T&, const T&) const;
+
+    _HeapNodePtr _NewNode(const T&);
+
+    void _DeleteNode(_HeapNodePtr);
+
+    static void _Splice(_HeapNodePtr, _HeapNodePtr);
+
+    static void _Unlink(_HeapNodePtr);
+
+    void _AddRoot(_HeapNodePtr);
+
+    void _Cut(_HeapNodePtr);
+
+    void _Consolidate();
+
+    void _RemoveRoot(_HeapNodePtr);
+
+    static void _Merge(FibonacciHeap&, FibonacciHeap&);
+
+    _HeapNodePtr _CopyList(_HeapNodePtr, _HeapNodePtr, std::vector<std::pair<_HeapNodePtr, _HeapNodePtr>>&);
+
+    void _CopyTrees(_HeapNodePtr&, _HeapNodePtr);
+
+    void _ClearTrees(_HeapNodePtr&);
+
+// Struct fields
+
+    _HeapNodePtr _min;          // Root with the minimal key, any root of the list
+    size_t _size;               // Number of keys
+    _NodeAllocator _allocator;  // Allocator of nodes
+
+public:
+// Public methods
+
+    using Handle = HeapHandle<_HeapNode>;
+
+    FibonacciHeap();
+    explicit FibonacciHeap(const Allocator&);
+    explicit FibonacciHeap(const Compare&, const Allocator& = Allocator());
+    FibonacciHeap(const T&, const Allocator& = Allocator());
+    template <typename Iterator>
+    FibonacciHeap(Iterator, Iterator, const Allocator& = Allocator());
+    FibonacciHeap(const FibonacciHeap&);
+
+    ~FibonacciHeap();
+
+    Handle Insert(const T&);
+
+    template <typename Iterator>
+    void InsertBatch(Iterator, Iterator);
+
+    T GetMin() const;
+
+    T ExtractMin();
+
+    void DecreaseKey(Handle, const T&);
+
+    void Erase(Handle);
+
+    void Meld(FibonacciHeap&);
+
+    bool Empty() const;
+
+    size_t Size() const;
+
+    Allocator GetAllocator() const;
+
+    FibonacciHeap& operator = (const FibonacciHeap&);
+};
+
+template <typename T, typename Compare, typename Allocator>
+class FibonacciHeap<T, Compare, Allocator>::_HeapNode {
+public:
+// Struct fields
+
+    T _key_;                // Key
+    _HeapNodePtr _parent_;  // Parent, nullptr for roots
+    _HeapNodePtr _child_;   // Any child
+    _HeapNodePtr _left_;    // Brothers, in a cyclic list
+    _HeapNodePtr _right_;
+    size_t _degree_;        // Number of children
+    bool _marked_;          // Lost a child since it became a child itself
+
+// Constructors and Destructor
+
+    _HeapNode(const T&);
+
+    ~_HeapNode() = default;
+};
+
+//
+// Constructors and Destructor
+//
+
+template <typename T, typename Compare, typename Allocator>
+FibonacciHeap<T, Compare, Allocator>::_HeapNode::_HeapNode(const T& key) : _key_(key), _parent_(nullptr), _child_(nullptr),
+    _left_(this), _right_(this), _degree_(0), _marked_(false) {}
+
+template <typename T, typename Compare, typename Allocator>
+FibonacciHeap<T, Compare, Allocator>::FibonacciHeap() : _min(nullptr), _size(0) {}
+
+template <typename T, typename Compare, typename Allocator>
+FibonacciHeap<T, Compare, Allocator>::FibonacciHeap(const Allocator& allocator) : _min(nullptr), _size(0), _allocator(allocator) {}
+
+template <typename T, typename Compare, typename Allocator>
+FibonacciHeap<T, Compare, Allocator>::FibonacciHeap(const Compare& compare, const Allocator& allocator) : CompareHolder<Compare>(compare),
+    _min(nullptr), _size(0), _allocator(allocator) {}
+
+template <typename T, typename Compare, typename Allocator>
+FibonacciHeap<T, Compare, Allocator>::FibonacciHeap(const T& key, const Allocator& allocator) : _min(nullptr), _size(1), _allocator(allocator)
+{
+    _min = _NewNode(key);
+}
+
+template <typename T, typename Compare, typename Allocator>
+template <typename Iterator>
+FibonacciHeap<T, Compare, Allocator>::FibonacciHeap(Iterator first, Iterator last, const Allocator& allocator) : _min(nullptr), _size(0), _allocator(allocator)
+{
+    InsertBatch(first, last);
+}
+
+template <typename T, typename Compare, typename Allocator>
+FibonacciHeap<T, Compare, Allocator>::FibonacciHeap(const FibonacciHeap& rhs) : CompareHolder<Compare>(rhs), _min(nullptr), _size(0),
+    _allocator(_NodeTraits::select_on_container_copy_construction(rhs._allocator))
+{
+    (*this) = rhs;
+}
+
+template <typename T, typename Compare, typename Allocator>
+FibonacciHeap<T, Compare, Allocator>::~FibonacciHeap()
+{
+    _ClearTrees(_min);
+    _size = 0;
+}
+
+//
+// Private functions and methods
+//
+
+template <typename T, typename Compare, typename Allocator>
+inline bool FibonacciHeap<T, Compare, Allocator>::_Compare(const T& lhs, const T& rhs) const
+{
+    return this->GetCompare()(lhs, rhs);
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename FibonacciHeap<T, Compare, Allocator>::_HeapNodePtr FibonacciHeap<T, Compare, Allocator>::_NewNode(const T& key)
+{
+    _HeapNodePtr ptr = _NodeTraits::allocate(_allocator, 1);
+    try {
+        _NodeTraits::construct(_allocator, ptr, key);
+    } catch (...) {
+        _NodeTraits::deallocate(_allocator, ptr, 1);
+        throw;
+    }
+    return ptr;
+}
+
+template <typename T, typename Compare, typename Allocator>
+void FibonacciHeap<T, Compare, Allocator>::_DeleteNode(_HeapNodePtr ptr)
+{
+    _NodeTraits::destroy(_allocator, ptr);
+    _NodeTraits::deallocate(_allocator, ptr, 1);
+}
+
+// Joins two cyclic lists into one
+template <typename T, typename Compare, typename Allocator>
+void FibonacciHeap<T, Compare, Allocator>::_Splice(_HeapNodePtr lhs, _HeapNodePtr rhs)
+{
+    _HeapNodePtr lhs_right = lhs->_right_;
+    _HeapNodePtr rhs_left = rhs->_left_;
+
+    lhs->_right_ = rhs;
+    rhs->_left_ = lhs;
+    rhs_left->_right_ = lhs_right;
+    lhs_right->_left_ = rhs_left;
+}
+
+// Takes the node out of its list, leaving it alone in a list of its own
+template <typename T, typename Compare, typename Allocator>
+void FibonacciHeap<T, Compare, Allocator>::_Unlink(_HeapNodePtr node)
+{
+    node->_left_->_right_ = node->_right_;
+    node->_right_->_left_ = node->_left_;
+    node->_left_ = node;
+    node->_right_ = node;
+}
+
+// Puts an unlinked node to the list of roots
+template <typename T, typename Compare, typename Allocator>
+void FibonacciHeap<T, Compare, Allocator>::_AddRoot(_HeapNodePtr node)
+{
+    node->_parent_ = nullptr;
+    node->_marked_ = false;
+
+    if (!_min) {
+        _min = node;
+        return;
+    }
+    _Splice(_min, node);
+    if (_Compare(node->_key_, _min->_key_)) {
+        _min = node;
+    }
+}
+
+// Moves the node to the roots, then cuts its ancestors that lose
+// a second child (cascading cut)
+template <typename T, typename Compare, typename Allocator>
+void FibonacciHeap<T, Compare, Allocator>::_Cut(_HeapNodePtr node)
+{
+    while (node->_parent_) {
+        _HeapNodePtr parent = node->_parent_;
+
+        parent->_child_ = (node->_right_ == node ? nullptr : node->_right_);
+        parent->_degree_--;
+        _Unlink(node);
+        _AddRoot(node);
+
+        if (!parent->_marked_) {
+            // Roots are never marked
+            parent->_marked_ = (parent->_parent_ != nullptr);
+            break;
+        }
+        node = parent;
+    }
+}
+
+// Links roots of equal degree until all degrees differ, and finds the
+// minimum among what remains
+template <typename T, typename Compare, typename Allocator>
+void FibonacciHeap<T, Compare, Allocator>::_Consolidate()
+{
+    _HeapNodePtr trees[_MaxDegree] = {};
+    size_t max_degree = 0;
+
+    _HeapNodePtr node = _min;
+    _min->_left_->_right_ = nullptr;
+
+    while (node) {
+        _HeapNodePtr next = node->_right_;
+        node->_left_ = node;
+        node->_right_ = node;
+
+        while (trees[node->_degree_]) {
+            _HeapNodePtr other = trees[node->_degree_];
+            trees[node->_degree_] = nullptr;
+
+            if (_Compare(other->_key_, node->_key_)) {
+                std::swap(node, other);
+            }
+            other->_parent_ = node;
+            other->_marked_ = false;
+            if (node->_child_) {
+                _Splice(node->_child_, other);
+            } else {
+                node->_child_ = other;
+            }
+            node->_degree_++;
+        }
+        trees[node->_degree_] = node;
+        max_degree = std::max(max_degree, node->_degree_);
+
+        node = next;
+    }
+
+    _min = nullptr;
+    for (size_t degree = 0; degree <= max_degree; degree++) {
+        if (trees[degree]) {
+            _AddRoot(trees[degree]);
+        }
+    }
+}
+
+// Deletes a root: its children become roots, then the trees are
+// consolidated
+template <typename T, typename Compare, typename Allocator>
+void FibonacciHeap<T, Compare, Allocator>::_RemoveRoot(_HeapNodePtr root)
+{
+    _HeapNodePtr children = root->_child_;
+    if (children) {
+        _HeapNodePtr child = children;
+        do {
+            child->_parent_ = nullptr;
+            child->_marked_ = false;
+            child = child->_right_;
+        } while (child != children);
+        _Splice(root, children);
+    }
+
+    _min = (root->_right_ == root ? nullptr : root->_right_);
+    _Unlink(root);
+    _DeleteNode(root);
+    _size--;
+
+    if (_min) {
+        _Consolidate();
+    }
+}
+
+// Nodes of rhs stay as they are when both heaps allocate from the same
+// place, otherwise lhs gets their copies
+template <typename T, typename Compare, typename Allocator>
+void FibonacciHeap<T, Compare, Allocator>::_Merge(FibonacciHeap& lhs, FibonacciHeap& rhs)
+{
+    if (&lhs == &rhs || !rhs._min) {
+        return;
+    }
+
+    _HeapNodePtr roots = rhs._min;
+    if (lhs._allocator != rhs._allocator) {
+        lhs._CopyTrees(roots, rhs._min);
+        rhs._ClearTrees(rhs._min);
+    }
+
+    if (!lhs._min) {
+        lhs._min = roots;
+    } else {
+        _Splice(lhs._min, roots);
+        if (lhs._Compare(roots->_key_, lhs._min->_key_)) {
+            lhs._min = roots;
+        }
+    }
+    lhs._size += rhs._size;
+
+    rhs._min = nullptr;
+    rhs._size = 0;
+}
+
+// Copies the list of brothers with parent as their parent; copied nodes
+// with children go to the stack together with their originals
+template <typename T, typename Compare, typename Allocator>
+typename FibonacciHeap<T, Compare, Allocator>::_HeapNodePtr FibonacciHeap<T, Compare, Allocator>::_CopyList(_HeapNodePtr list, _HeapNodePtr parent,
+    std::vector<std::pair<_HeapNodePtr, _HeapNodePtr>>& stack)
+{
+    _HeapNodePtr result = nullptr;
+    _HeapNodePtr node = list;
+
+    do {
+        _HeapNodePtr copy = _NewNode(node->_key_);
+        copy->_parent_ = parent;
+        copy->_degree_ = node->_degree_;
+        copy->_marked_ = node->_marked_;
+
+        if (result) {
+            _Splice(result->_left_, copy);
+        } else {
+            result = copy;
+        }
+        if (node->_child_) {
+            stack.emplace_back(copy, node);
+        }
+        node = node->_right_;
+    } while (node != list);
+
+    return result;
+}
+
+// Trees may be as deep as the heap is large, so they are copied with an
+// explicit stack instead of recursion
+template <typename T, typename Compare, typename Allocator>
+void FibonacciHeap<T, Compare, Allocator>::_CopyTrees(_HeapNodePtr& lhs, _HeapNodePtr rhs)
+{
+    lhs = nullptr;
+    if (!rhs) {
+        return;
+    }
+
+    std::vector<std::pair<_HeapNodePtr, _HeapNodePtr>> stack;
+    lhs = _CopyList(rhs, nullptr, stack);
+
+    while (!stack.empty()) {
+        std::pair<_HeapNodePtr, _HeapNodePtr> top = stack.back();
+        stack.pop_back();
+        top.first->_child_ = _CopyList(top.second->_child_, top.first, stack);
+    }
+}
+
+// Splices the children of every root into the list of roots before
+// deleting it
+template <typename T, typename Compare, typename Allocator>
+void FibonacciHeap<T, Compare, Allocator>::_ClearTrees(_HeapNodePtr& ptr)
+{
+    if (!ptr) {
+        return;
+    }
+
+    _HeapNodePtr node = ptr;
+    while (node) {
+        if (node->_child_) {
+            _Splice(node, node->_child_);
+            node->_child_ = nullptr;
+        }
+        _HeapNodePtr next = (node->_right_ == node ? nullptr : node->_right_);
+        _Unlink(node);
+        _DeleteNode(node);
+        node = next;
+    }
+
+    ptr = nullptr;
+}
+
+//
+// Public methods
+//
+
+template <typename T, typename Compare, typename Allocator>
+FibonacciHeap<T, Compare, Allocator>& FibonacciHeap<T, Compare, Allocator>::operator = (const FibonacciHeap& rhs)
+{
+    if (this == &rhs) {
+        return (*this);
+    }
+
+    _ClearTrees(_min);
+    static_cast<CompareHolder<Compare>&>(*this) = rhs;
+    _size = rhs.Size();
+    _CopyTrees(_min, rhs._min);
+
+    return (*this);
+}
+
+template <typename T, typename Compare, typename Allocator>
+size_t FibonacciHeap<T, Compare, Allocator>::Size() const
+{
+    return _size;
+}
+
+template <typename T, typename Compare, typename Allocator>
+bool FibonacciHeap<T, Compare, Allocator>::Empty() const
+{
+    return _size == 0;
+}
+
+template <typename T, typename Compare, typename Allocator>
+Allocator FibonacciHeap<T, Compare, Allocator>::GetAllocator() const
+{
+    return Allocator(_allocator);
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename FibonacciHeap<T, Compare, Allocator>::Handle FibonacciHeap<T, Compare, Allocator>::Insert(const T& key)
+{
+    _HeapNodePtr node = _NewNode(key);
+    _AddRoot(node);
+    _size++;
+    return Handle(node);
+}
+
+// Keys just join the list of roots, the first ExtractMin links them
+template <typename T, typename Compare, typename Allocator>
+template <typename Iterator>
+void FibonacciHeap<T, Compare, Allocator>::InsertBatch(Iterator first, Iterator last)
+{
+    for (; first != last; ++first) {
+        _AddRoot(_NewNode(*first));
+        _size++;
+    }
+}
+
+template <typename T, typename Compare, typename Allocator>
+T FibonacciHeap<T, Compare, Allocator>::GetMin() const
+{
+    if (!_min) {
+        throw std::range_error("No elements in Heap");
+    }
+    return _min->_key_;
+}
+
+template <typename T, typename Compare, typename Allocator>
+T FibonacciHeap<T, Compare, Allocator>::ExtractMin()
+{
+    if (!_min) {
+        throw std::range_error("No elements in Heap");
+    }
+
+    T result = _min->_key_;
+    _RemoveRoot(_min);
+
+    return result;
+}
+
+// Cuts the node from its parent if the order breaks, O(1) amortized
+template <typename T, typename Compare, typename Allocator>
+void FibonacciHeap<T, Compare, Allocator>::DecreaseKey(Handle handle, const T& key)
+{
+    _HeapNodePtr node = handle.GetNode();
+    if (_Compare(node->_key_, key)) {
+        throw std::invalid_argument("New key is greater than the old one");
+    }
+    node->_key_ = key;
+
+    if (node->_parent_ && _Compare(key, node->_parent_->_key_)) {
+        _Cut(node);
+    } else if (!node->_parent_ && _Compare(key, _min->_key_)) {
+        _min = node;
+    }
+}
+
+// Cuts the node to the roots and removes it as if it were the minimum
+template <typename T, typename Compare, typename Allocator>
+void FibonacciHeap<T, Compare, Allocator>::Erase(Handle handle)
+{
+    _HeapNodePtr node = handle.GetNode();
+    if (node->_parent_) {
+        _Cut(node);
+    }
+    _min = node;
+    _RemoveRoot(node);
+}
+
+template <typename T, typename Compare, typename Allocator>
+void FibonacciHeap<T, Compare, Allocator>::Meld(FibonacciHeap& rhs)
+{
+    _Merge((*this), rhs);
+}
+
+#endif /* FibonacciHeap_h */
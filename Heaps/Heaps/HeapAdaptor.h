@@ -0,0 +1,124 @@
+//
+//  HeapAdaptor.h
+//  Heaps
+//
+
+#ifndef HeapAdaptor_h
+#define HeapAdaptor_h
+
+#include <iostream>
+#include <algorithm>
+#include "IHeap.h"
+
+// IHeap over a heap bound at compile time, for code that chooses the heap
+// at run time. Meld accepts only adaptors of the same heap
+template <typename Heap>
+class HeapAdaptor : public IHeap<typename Heap::KeyType, typename Heap::KeyCompare> {
+    
+    using T = typename Heap::KeyType;
+    using Compare = typename Heap::KeyCompare;
+    
+    static_assert(IsStaticHeap<Heap, T>::value, "HeapAdaptor needs a heap");
+    
+private:
+// Struct fields
+    
+    Heap _heap; // Adapted heap
+    
+public:
+// Public methods
+    
+    HeapAdaptor() = default;
+    HeapAdaptor(const T&);
+    template <typename Iterator>
+    HeapAdaptor(Iterator, Iterator);
+    HeapAdaptor(const HeapAdaptor&) = default;
+    
+    ~HeapAdaptor() override = default;
+    
+    void Insert(const T&) override;
+    
+    void InsertBatch(const T *, const T *) override;
+    
+    T GetMin() const override;
+    
+    T ExtractMin() override;
+    
+    void Meld(IHeap<T, Compare>&) override;
+    
+    bool Empty() const override;
+    
+    size_t Size() const override;
+    
+    HeapAdaptor& operator = (const HeapAdaptor&) = default;
+    
+    Heap& Get();
+    const Heap& Get() const;
+};
+
+template <typename Heap>
+HeapAdaptor<Heap>::HeapAdaptor(const T& key) : _heap(key) {}
+
+template <typename Heap>
+template <typename Iterator>
+HeapAdaptor<Heap>::HeapAdaptor(Iterator first, Iterator last) : _heap(first, last) {}
+
+template <typename Heap>
+void HeapAdaptor<Heap>::Insert(const T& key)
+{
+    _heap.Insert(key);
+}
+
+template <typename Heap>
+void HeapAdaptor<Heap>::InsertBatch(const T * first, const T * last)
+{
+    _heap.InsertBatch(first, last);
+}
+
+template <typename Heap>
+typename HeapAdaptor<Heap>::T HeapAdaptor<Heap>::GetMin() const
+{
+    return _heap.GetMin();
+}
+
+template <typename Heap>
+typename HeapAdaptor<Heap>::T HeapAdaptor<Heap>::ExtractMin()
+{
+    return _heap.ExtractMin();
+}
+
+template <typename Heap>
+void HeapAdaptor<Heap>::Meld(IHeap<T, Compare>& rhs)
+{
+    try {
+        _heap.Meld(dynamic_cast<HeapAdaptor<Heap>&>(rhs)._heap);
+    } catch (const std::bad_cast& error) {
+        std::cerr << error.what();
+    };
+}
+
+template <typename Heap>
+bool HeapAdaptor<Heap>::Empty() const
+{
+    return _heap.Empty();
+}
+
+template <typename Heap>
+size_t HeapAdaptor<Heap>::Size() const
+{
+    return _heap.Size();
+}
+
+template <typename Heap>
+Heap& HeapAdaptor<Heap>::Get()
+{
+    return _heap;
+}
+
+template <typename Heap>
+const Heap& HeapAdaptor<Heap>::Get() const
+{
+    return _heap;
+}
+
+#endif /* HeapAdaptor_h */
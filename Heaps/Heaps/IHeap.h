@@ -11,6 +11,95 @@
 
 #include <iostream>
 #include <algorithm>
+#include <functional>
+#include <type_traits>
+
+// Comparator of heap keys. Heaps derive from it, so an empty comparator
+// (like std::less) takes no space, and its calls are inlined
+template <typename Compare, bool = std::is_empty<Compare>::value && !std::is_final<Compare>::value>
+class CompareHolder : private Compare {
+    
+public:
+    
+    CompareHolder(const Compare& compare = Compare()) : Compare(compare) {}
+    
+    const Compare& GetCompare() const { return (*this); }
+};
+
+template <typename Compare>
+class CompareHolder<Compare, false> {
+    
+private:
+    
+    Compare _compare;
+    
+public:
+    
+    CompareHolder(const Compare& compare = Compare()) : _compare(compare) {}
+    
+    const Compare& GetCompare() const { return _compare; }
+};
+
+// Checks that Heap has the operations of a heap with keys T:
+// Insert, GetMin, ExtractMin, Meld with a heap of the same type, Empty, Size
+template <typename Heap, typename T, typename = void>
+struct IsStaticHeap : std::false_type {};
+
+template <typename Heap, typename T>
+struct IsStaticHeap<Heap, T, std::void_t<
+    decltype(std::declval<Heap&>().Insert(std::declval<const T&>())),
+    decltype(std::declval<const Heap&>().GetMin()),
+    decltype(std::declval<Heap&>().ExtractMin()),
+    decltype(std::declval<Heap&>().Meld(std::declval<Heap&>())),
+    decltype(std::declval<const Heap&>().Empty()),
+    decltype(std::declval<const Heap&>().Size())>> :
+    std::integral_constant<bool, std::is_convertible<decltype(std::declval<Heap&>().ExtractMin()), T>::value &&
+                                 std::is_convertible<decltype(std::declval<const Heap&>().GetMin()), T>::value> {};
+
+// Base of heaps bound at compile time (CRTP): their operations are not
+// virtual, so calls through the concrete type are direct and inlined.
+// HeapAdaptor makes an IHeap out of any of them
+template <typename Derived, typename T, typename Compare>
+class StaticHeap {
+    
+public:
+    
+    using KeyType = T;
+    using KeyCompare = Compare;
+    
+protected:
+    
+    StaticHeap() = default;
+    
+    ~StaticHeap();
+};
+
+template <typename Derived, typename T, typename Compare>
+StaticHeap<Derived, T, Compare>::~StaticHeap()
+{
+    static_assert(IsStaticHeap<Derived, T>::value, "Heap operations are missing");
+}
+
+// Stable reference to a key of a heap, returned by Insert. It stays valid
+// until the key is extracted or erased, also after melding into a heap
+// with the same allocator
+template <typename Node>
+class HeapHandle {
+    
+private:
+    
+    Node * _node;
+    
+public:
+    
+    HeapHandle() : _node(nullptr) {}
+    explicit HeapHandle(Node * node) : _node(node) {}
+    
+    Node * GetNode() const { return _node; }
+    
+    bool operator == (const HeapHandle& rhs) const { return _node == rhs._node; }
+    bool operator != (const HeapHandle& rhs) const { return _node != rhs._node; }
+};
 
 template <typename T = int, typename Compare = std::less<T>>
 class IHeap {
@@ -23,6 +112,10 @@ public:
     
     virtual void Insert(const T&) = 0;
     
+    // Inserts the keys of [first, last) at once, in O(n) where the heap
+    // allows it
+    virtual void InsertBatch(const T *, const T *) = 0;
+    
     virtual T GetMin() const = 0;
     
     virtual T ExtractMin() = 0;
@@ -10,193 +10,217 @@
 #define LeftistHeap_h
 
 #include <iostream>
+#include <memory>
 #include "IHeap.h"
 #include "SkewHeap.h"
 
-template <typename T = int, typename Compare = std::less<T> >
-class LeftistHeap : public SkewHeap<T, Compare>
+template <typename T = int, typename Compare = std::less<T>, typename Allocator = std::allocator<T> >
+class LeftistHeap : public SkewHeap<T, Compare, Allocator>
 {
 
 protected:
 
-    class _HeapNode : public SkewHeap<T, Compare>::_HeapNode
-    {
-    public:
-    // Struct fields
+    using _HeapNodePtr = typename SkewHeap<T, Compare, Allocator>::_HeapNodePtr;
 
-        size_t _rank_;
-
-    // Constructors and Destructor
-
-        _HeapNode();
-
-        _HeapNode(const T&);
-
-        ~_HeapNode() = default;
-    };
-
-    // static void _ClearTree(_HeapNode* &);
-
-    static void _CopyTree(typename SkewHeap<T, Compare>::_HeapNode* &, const typename SkewHeap<T, Compare>::_HeapNode*);
-
-    static size_t _GetRank(typename SkewHeap<T, Compare>::_HeapNode*);
+    static size_t _GetRank(_HeapNodePtr);
     
-    static void _Update(typename SkewHeap<T, Compare>::_HeapNode* ptr);
+    static void _FixRanks(_HeapNodePtr);
 
-    static typename SkewHeap<T, Compare>::_HeapNode* _Merge(typename SkewHeap<T, Compare>::_HeapNode*, typename SkewHeap<T, Compare>::_HeapNode*);
+    _HeapNodePtr _Merge(_HeapNodePtr, _HeapNodePtr) const;
 
     static void _Merge(LeftistHeap&, LeftistHeap&);
 
 public:
 
+    using Handle = typename SkewHeap<T, Compare, Allocator>::Handle;
+
     LeftistHeap();
-    LeftistHeap(const T&);
-    LeftistHeap(const LeftistHeap&);
+    explicit LeftistHeap(const Allocator&);
+    explicit LeftistHeap(const Compare&, const Allocator& = Allocator());
+    LeftistHeap(const T&, const Allocator& = Allocator());
+    template <typename Iterator>
+    LeftistHeap(Iterator, Iterator, const Allocator& = Allocator());
+    LeftistHeap(const LeftistHeap&) = default;
     
 
-    LeftistHeap& operator = (const LeftistHeap&);
+    LeftistHeap& operator = (const LeftistHeap&) = default;
 
-    T ExtractMin() override;
+    T ExtractMin();
+    
+    void DecreaseKey(Handle, const T&);
     
-    void Meld(IHeap<T, Compare>&) override;
+    void Erase(Handle);
+    
+    void Meld(LeftistHeap&);
+
+    Handle Insert(const T&);
 
-    void Insert(const T&) override;
+    template <typename Iterator>
+    void InsertBatch(Iterator, Iterator);
 };
 
-template <typename T, typename Compare>
-LeftistHeap<T, Compare>::_HeapNode::_HeapNode() : SkewHeap<T, Compare>::_HeapNode(), _rank_(1) {}
+template <typename T, typename Compare, typename Allocator>
+LeftistHeap<T, Compare, Allocator>::LeftistHeap() : SkewHeap<T, Compare, Allocator>::SkewHeap() {}
 
-template <typename T, typename Compare>
-LeftistHeap<T, Compare>::_HeapNode::_HeapNode(const T& key) : SkewHeap<T, Compare>::_HeapNode(key), _rank_(1) {}
+template <typename T, typename Compare, typename Allocator>
+LeftistHeap<T, Compare, Allocator>::LeftistHeap(const Allocator& allocator) : SkewHeap<T, Compare, Allocator>::SkewHeap(allocator) {}
 
-template <typename T, typename Compare>
-LeftistHeap<T, Compare>::LeftistHeap() : SkewHeap<T, Compare>::SkewHeap() {}
+template <typename T, typename Compare, typename Allocator>
+LeftistHeap<T, Compare, Allocator>::LeftistHeap(const Compare& compare, const Allocator& allocator) :
+    SkewHeap<T, Compare, Allocator>::SkewHeap(compare, allocator) {}
 
-template <typename T, typename Compare>
-LeftistHeap<T, Compare>::LeftistHeap(const T& element) : SkewHeap<T, Compare>::SkewHeap(element)
-{
-    this->_root = dynamic_cast<typename SkewHeap<T, Compare>::_HeapNode*> (new LeftistHeap<T, Compare>::_HeapNode(element));
-}
-
-template <typename T, typename Compare>
-LeftistHeap<T, Compare>::LeftistHeap(const LeftistHeap& rhs)
-{
-    this->_root = nullptr;
-    (*this) = rhs;
-}
+template <typename T, typename Compare, typename Allocator>
+LeftistHeap<T, Compare, Allocator>::LeftistHeap(const T& element, const Allocator& allocator) :
+    SkewHeap<T, Compare, Allocator>::SkewHeap(element, allocator) {}
 
-template <typename T, typename Compare>
-size_t LeftistHeap<T, Compare>::_GetRank(typename SkewHeap<T, Compare>::_HeapNode* ptr)
+template <typename T, typename Compare, typename Allocator>
+template <typename Iterator>
+LeftistHeap<T, Compare, Allocator>::LeftistHeap(Iterator first, Iterator last, const Allocator& allocator) :
+    SkewHeap<T, Compare, Allocator>::SkewHeap(allocator)
 {
-    return ptr ? dynamic_cast<typename LeftistHeap<T, Compare>::_HeapNode*> (ptr)->_rank_ : 0;
+    this->_root = this->_Build(first, last, [this](_HeapNodePtr lhs, _HeapNodePtr rhs) { return _Merge(lhs, rhs); });
 }
 
-template <typename T, typename Compare>
-void LeftistHeap<T, Compare>::_Update(typename SkewHeap<T, Compare>::_HeapNode* ptr)
+template <typename T, typename Compare, typename Allocator>
+size_t LeftistHeap<T, Compare, Allocator>::_GetRank(_HeapNodePtr ptr)
 {
-    if (!ptr) { return; }
-    
-    dynamic_cast<typename LeftistHeap<T, Compare>::_HeapNode*> (ptr)->_rank_ = std::min(_GetRank(ptr->_left_),
-                                                                                        _GetRank(ptr->_right_), 
-                                                                                        SkewHeap<T, Compare>::_Compare) + 1;
+    return ptr ? ptr->_rank_ : 0;
 }
 
-template <typename T, typename Compare>
-typename SkewHeap<T, Compare>::_HeapNode* LeftistHeap<T, Compare>::_Merge(typename SkewHeap<T, Compare>::_HeapNode* lhs, typename SkewHeap<T, Compare>::_HeapNode* rhs)
+// Restores ranks and the order of sons from ptr up, after its subtree
+// changed; stops where the rank stays the same
+template <typename T, typename Compare, typename Allocator>
+void LeftistHeap<T, Compare, Allocator>::_FixRanks(_HeapNodePtr ptr)
 {
-    if (!lhs) {
-        return rhs;
-    } else if (!rhs) {
-        return lhs;
-    }
-    
-    if (SkewHeap<T, Compare>::_Compare(lhs->_key_, rhs->_key_)) {
-        lhs->_right_ = _Merge(lhs->_right_, rhs);
-        _Update(lhs);
-        
-        if (_GetRank(lhs->_left_) < _GetRank(lhs->_right_)) {
-            std::swap(lhs->_left_, lhs->_right_);
+    while (ptr) {
+        if (_GetRank(ptr->_left_) < _GetRank(ptr->_right_)) {
+            std::swap(ptr->_left_, ptr->_right_);
         }
-        
-        return lhs;
-    } else {
-        rhs->_left_ = _Merge(lhs, rhs->_left_);
-        _Update(rhs);
-        
-        if (_GetRank(rhs->_right_) < _GetRank(rhs->_left_)) {
-            std::swap(rhs->_right_, rhs->_left_);
+        size_t rank = _GetRank(ptr->_right_) + 1;
+        if (rank == ptr->_rank_) {
+            return;
         }
-        
-        return rhs;
+        ptr->_rank_ = rank;
+        ptr = ptr->_parent_;
     }
 }
 
-template <typename T, typename Compare>
-void LeftistHeap<T, Compare>::_CopyTree(typename SkewHeap<T, Compare>::_HeapNode* & lhs, const typename SkewHeap<T, Compare>::_HeapNode* rhs)
+// Top-down along the right paths, taking the smaller root each time, then
+// bottom-up along the merged path restoring ranks and the order of sons.
+// Right paths are O(log n) long, so is the whole meld
+template <typename T, typename Compare, typename Allocator>
+typename LeftistHeap<T, Compare, Allocator>::_HeapNodePtr LeftistHeap<T, Compare, Allocator>::_Merge(_HeapNodePtr lhs, _HeapNodePtr rhs) const
 {
-    if (rhs == nullptr) {
-        lhs = nullptr;
-        return;
+    _HeapNodePtr result = nullptr;
+    _HeapNodePtr * link = &result;
+    _HeapNodePtr parent = nullptr;
+    
+    while (lhs && rhs) {
+        if (this->_Compare(rhs->_key_, lhs->_key_)) {
+            std::swap(lhs, rhs);
+        }
+        (*link) = lhs;
+        lhs->_parent_ = parent;
+        parent = lhs;
+        
+        link = &lhs->_right_;
+        lhs = lhs->_right_;
     }
     
-    lhs = dynamic_cast<typename SkewHeap<T, Compare>::_HeapNode*> (new LeftistHeap<T, Compare>::_HeapNode(rhs->_key_));
+    (*link) = (lhs ? lhs : rhs);
+    if (*link) {
+        (*link)->_parent_ = parent;
+    }
     
-    LeftistHeap<T, Compare>::_CopyTree(lhs->_left_, rhs->_left_);
-    LeftistHeap<T, Compare>::_CopyTree(lhs->_right_, rhs->_right_);
-}
-
-template <typename T, typename Compare>
-LeftistHeap<T, Compare>& LeftistHeap<T, Compare>::operator = (const LeftistHeap<T, Compare>& rhs)
-{
-    if (this == &rhs) {
-        return (*this);
+    for (; parent; parent = parent->_parent_) {
+        if (_GetRank(parent->_left_) < _GetRank(parent->_right_)) {
+            std::swap(parent->_left_, parent->_right_);
+        }
+        parent->_rank_ = _GetRank(parent->_right_) + 1;
     }
     
-    this->_ClearTree(this->_root);
-    this->_size = rhs.Size();
-    LeftistHeap<T, Compare>::_CopyTree(this->_root, rhs._root);
-    return (*this);
+    return result;
 }
 
-template <typename T, typename Compare>
-void LeftistHeap<T, Compare>::_Merge(LeftistHeap& lhs, LeftistHeap& rhs)
+template <typename T, typename Compare, typename Allocator>
+void LeftistHeap<T, Compare, Allocator>::_Merge(LeftistHeap& lhs, LeftistHeap& rhs)
 {
-    lhs._root = _Merge(lhs._root, rhs._root);
-    lhs._size += rhs._size;
-    rhs._root = nullptr;
+    if (&lhs == &rhs) {
+        return;
+    }
+    size_t size = rhs._size;
+    lhs._Replace(nullptr, lhs._Merge(lhs._root, lhs._Take(rhs)));
+    lhs._size += size;
 }
 
-template <typename T, typename Compare>
-T LeftistHeap<T, Compare>::ExtractMin()
+template <typename T, typename Compare, typename Allocator>
+T LeftistHeap<T, Compare, Allocator>::ExtractMin()
 {
     if (!this->_root) {
         throw std::range_error("No elements in Heap");
     }
-    typename SkewHeap<T, Compare>::_HeapNode* result = this->_root;
+    _HeapNodePtr result = this->_root;
     
-    this->_root = _Merge(this->_root->_left_, this->_root->_right_);
+    this->_Replace(nullptr, _Merge(this->_root->_left_, this->_root->_right_));
+    this->_size--;
     T answer = result->_key_;
     
-    delete result;
+    this->_DeleteNode(result);
     
     return answer;
 }
 
-template <typename T, typename Compare>
-void LeftistHeap<T, Compare>::Meld(IHeap<T, Compare>& rhs)
+// Cuts the subtree of the node and melds it with the rest
+template <typename T, typename Compare, typename Allocator>
+void LeftistHeap<T, Compare, Allocator>::DecreaseKey(Handle handle, const T& key)
 {
-    try {
-        _Merge((*this), dynamic_cast<LeftistHeap<T, Compare>&>(rhs));
-    } catch (const std::bad_cast& error) {
-        std::cerr << error.what();
-    };
+    _HeapNodePtr node = handle.GetNode();
+    if (this->_Compare(node->_key_, key)) {
+        throw std::invalid_argument("New key is greater than the old one");
+    }
+    node->_key_ = key;
+    
+    _HeapNodePtr parent = node->_parent_;
+    if (parent && this->_Compare(key, parent->_key_)) {
+        this->_Replace(node, nullptr);
+        _FixRanks(parent);
+        this->_Replace(nullptr, _Merge(this->_root, node));
+    }
+}
+
+// Puts the meld of the children in place of the node
+template <typename T, typename Compare, typename Allocator>
+void LeftistHeap<T, Compare, Allocator>::Erase(Handle handle)
+{
+    _HeapNodePtr node = handle.GetNode();
+    _HeapNodePtr parent = node->_parent_;
+    this->_Replace(node, _Merge(node->_left_, node->_right_));
+    _FixRanks(parent);
+    this->_size--;
+    this->_DeleteNode(node);
 }
 
-template <typename T, typename Compare>
-void LeftistHeap<T, Compare>::Insert(const T& element)
+template <typename T, typename Compare, typename Allocator>
+void LeftistHeap<T, Compare, Allocator>::Meld(LeftistHeap<T, Compare, Allocator>& rhs)
 {
-    LeftistHeap<T, Compare> rhs(element);
     _Merge((*this), rhs);
 }
 
+template <typename T, typename Compare, typename Allocator>
+typename LeftistHeap<T, Compare, Allocator>::Handle LeftistHeap<T, Compare, Allocator>::Insert(const T& element)
+{
+    _HeapNodePtr node = this->_NewNode(element);
+    this->_Replace(nullptr, _Merge(this->_root, node));
+    this->_size++;
+    return Handle(node);
+}
+
+template <typename T, typename Compare, typename Allocator>
+template <typename Iterator>
+void LeftistHeap<T, Compare, Allocator>::InsertBatch(Iterator first, Iterator last)
+{
+    _HeapNodePtr tree = this->_Build(first, last, [this](_HeapNodePtr lhs, _HeapNodePtr rhs) { return _Merge(lhs, rhs); });
+    this->_Replace(nullptr, _Merge(this->_root, tree));
+}
+
 #endif /* LeftistHeap_h */
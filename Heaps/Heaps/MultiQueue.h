@@ -0,0 +1,278 @@
+//
+//  MultiQueue.h
+//  Heaps
+//
+
+#ifndef MultiQueue_h
+#define MultiQueue_h
+
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "IHeap.h"
+#include "PairingHeap.h"
+
+// Concurrent priority queue with relaxed order (MultiQueue of Rihani,
+// Sanders and Dementiev). Keys are spread over several heaps, each under
+// its own lock. Insert puts a key to a random heap; ExtractMin looks at
+// the minima of two random heaps and extracts the smaller one. Locks are
+// tried first, a busy heap makes a thread pick others, so with more heaps
+// than threads they rarely wait for each other. A thread that keeps
+// failing yields and then waits for a lock, so one heap or more threads
+// than cores do not turn into spinning.
+//
+// The price is the order: ExtractMin returns a key close to the minimum,
+// not the minimum itself. With q heaps the rank of the extracted key
+// (the number of smaller keys left) is O(q) in expectation and
+// O(q log q) with high probability (Alistarh et al., 2017). With one
+// heap the order is exact. ExtractMin fails only when all heaps are seen
+// empty; Size and Empty are exact only when no other thread is working.
+// Heap needs Insert, GetMin, ExtractMin, Empty and a constructor from
+// Compare
+template <typename T = int, typename Compare = std::less<T>, typename Heap = PairingHeap<T, Compare>>
+class MultiQueue : private CompareHolder<Compare> {
+
+private:
+// Private functions and classes
+
+    // Heap with its lock, on cache lines of its own
+    struct alignas(64) _Queue {
+        std::mutex _mutex_;
+        Heap _heap_;
+        std::atomic<size_t> _size_;     // Size of the heap, read without the lock
+
+        explicit _Queue(const Compare& compare) : _heap_(compare), _size_(0) {}
+    };
+
+    // Failed lock rounds in a row after which a thread yields, and twice
+    // as many after which it waits for a lock
+    static constexpr size_t _Spins = 8;
+
+    bool _Compare(const T&, const T&) const;
+
+    size_t _RandomQueue() const;
+
+    static std::unique_lock<std::mutex> _Lock(_Queue&, size_t&);
+
+// Struct fields
+
+    std::vector<std::unique_ptr<_Queue>> _queues;
+    size_t _count;                      // Number of heaps
+
+public:
+// Public methods
+
+    using KeyType = T;
+    using KeyCompare = Compare;
+
+    // Twice the hardware threads
+    static size_t DefaultQueues();
+
+    explicit MultiQueue(size_t = DefaultQueues(), const Compare& = Compare());
+    MultiQueue(const MultiQueue&) = delete;
+
+    ~MultiQueue() = default;
+
+    void Insert(const T&);
+
+    // Extracts a key close to the minimum, false if all heaps are empty
+    bool TryExtractMin(T&);
+
+    T ExtractMin();
+
+    bool Empty() const;
+
+    size_t Size() const;
+
+    size_t Queues() const;
+
+    MultiQueue& operator = (const MultiQueue&) = delete;
+};
+
+//
+// Private functions and methods
+//
+
+template <typename T, typename Compare, typename Heap>
+inline bool MultiQueue<T, Compare, Heap>::_Compare(const T& lhs, const T& rhs) const
+{
+    return this->GetCompare()(lhs, rhs);
+}
+
+// Xorshift generator of every thread, seeded by its id
+template <typename T, typename Compare, typename Heap>
+size_t MultiQueue<T, Compare, Heap>::_RandomQueue() const
+{
+    thread_local uint64_t state = std::hash<std::thread::id>()(std::this_thread::get_id()) | 1;
+
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+
+    return static_cast<size_t>(state % _count);
+}
+
+// Tries the lock of a queue while few rounds failed, waits for it after
+// many of them. A failed try counts a round and yields once the thread
+// keeps losing, so that with one queue or more threads than cores the
+// holder of the lock gets to run
+template <typename T, typename Compare, typename Heap>
+std::unique_lock<std::mutex> MultiQueue<T, Compare, Heap>::_Lock(_Queue& queue, size_t& failures)
+{
+    if (failures >= 2 * _Spins) {
+        failures = 0;
+        return std::unique_lock<std::mutex>(queue._mutex_);
+    }
+
+    std::unique_lock<std::mutex> lock(queue._mutex_, std::try_to_lock);
+    if (!lock && ++failures >= _Spins) {
+        std::this_thread::yield();
+    }
+    return lock;
+}
+
+//
+// Constructors
+//
+
+template <typename T, typename Compare, typename Heap>
+size_t MultiQueue<T, Compare, Heap>::DefaultQueues()
+{
+    return std::max<size_t>(2, 2 * std::thread::hardware_concurrency());
+}
+
+template <typename T, typename Compare, typename Heap>
+MultiQueue<T, Compare, Heap>::MultiQueue(size_t count, const Compare& compare) : CompareHolder<Compare>(compare),
+    _count(std::max<size_t>(count, 1))
+{
+    _queues.reserve(_count);
+    for (size_t i = 0; i < _count; i++) {
+        _queues.emplace_back(new _Queue(this->GetCompare()));
+    }
+}
+
+//
+// Public methods
+//
+
+template <typename T, typename Compare, typename Heap>
+void MultiQueue<T, Compare, Heap>::Insert(const T& key)
+{
+    size_t failures = 0;
+    while (true) {
+        _Queue& queue = *_queues[_RandomQueue()];
+
+        std::unique_lock<std::mutex> lock = _Lock(queue, failures);
+        if (!lock) {
+            continue;
+        }
+        queue._heap_.Insert(key);
+        queue._size_.store(queue._size_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        return;
+    }
+}
+
+template <typename T, typename Compare, typename Heap>
+bool MultiQueue<T, Compare, Heap>::TryExtractMin(T& result)
+{
+    size_t failures = 0;
+    while (true) {
+        _Queue * first = _queues[_RandomQueue()].get();
+        _Queue * second = _queues[_RandomQueue()].get();
+
+        // The sizes are only hints, the heaps are checked again under the locks
+        size_t first_size = first->_size_.load(std::memory_order_acquire);
+        size_t second_size = second->_size_.load(std::memory_order_acquire);
+        if (first_size == 0 && second_size == 0) {
+            if (Empty()) {
+                return false;
+            }
+            continue;
+        }
+        if (first_size == 0 || first == second) {
+            first = second;
+            second = nullptr;
+        } else if (second_size == 0) {
+            second = nullptr;
+        }
+
+        // After waiting for the first lock the second one is only tried,
+        // and a busy second heap is left out
+        bool waited = (failures >= 2 * _Spins);
+        std::unique_lock<std::mutex> first_lock = _Lock(*first, failures);
+        if (!first_lock) {
+            continue;
+        }
+        std::unique_lock<std::mutex> second_lock;
+        if (second) {
+            second_lock = std::unique_lock<std::mutex>(second->_mutex_, std::try_to_lock);
+            if (!second_lock && waited) {
+                second = nullptr;
+            } else if (!second_lock) {
+                if (++failures >= _Spins) {
+                    std::this_thread::yield();
+                }
+                continue;
+            }
+        }
+
+        _Queue * queue = first;
+        if (first->_heap_.Empty() || (second && !second->_heap_.Empty() &&
+                                      _Compare(second->_heap_.GetMin(), first->_heap_.GetMin()))) {
+            queue = second;
+        }
+        if (!queue || queue->_heap_.Empty()) {
+            continue;
+        }
+
+        result = queue->_heap_.ExtractMin();
+        queue->_size_.store(queue->_size_.load(std::memory_order_relaxed) - 1, std::memory_order_release);
+        return true;
+    }
+}
+
+template <typename T, typename Compare, typename Heap>
+T MultiQueue<T, Compare, Heap>::ExtractMin()
+{
+    T result;
+    if (!TryExtractMin(result)) {
+        throw std::range_error("No elements in Heap");
+    }
+    return result;
+}
+
+template <typename T, typename Compare, typename Heap>
+bool MultiQueue<T, Compare, Heap>::Empty() const
+{
+    for (size_t i = 0; i < _count; i++) {
+        if (_queues[i]->_size_.load(std::memory_order_acquire) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename T, typename Compare, typename Heap>
+size_t MultiQueue<T, Compare, Heap>::Size() const
+{
+    size_t size = 0;
+    for (size_t i = 0; i < _count; i++) {
+        size += _queues[i]->_size_.load(std::memory_order_acquire);
+    }
+    return size;
+}
+
+template <typename T, typename Compare, typename Heap>
+size_t MultiQueue<T, Compare, Heap>::Queues() const
+{
+    return _count;
+}
+
+#endif /* MultiQueue_h */
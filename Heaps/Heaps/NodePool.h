@@ -0,0 +1,196 @@
+//
+//  NodePool.h
+//  Heaps
+//
+
+#ifndef NodePool_h
+#define NodePool_h
+
+#include <iostream>
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <vector>
+
+// Slab pool of small blocks. Blocks are cut from slabs that grow
+// geometrically, freed blocks go to a free list of their size and are
+// reused; the memory is returned to the system only with the pool.
+// Not thread safe
+class NodePool {
+
+private:
+// Private functions and classes
+
+    struct _FreeBlock {
+        _FreeBlock * _next_;
+    };
+
+    static size_t _SizeClass(size_t);
+
+    void _NewSlab(size_t);
+
+// Struct fields
+
+    std::vector<_FreeBlock*> _free;                 // Free lists by size class
+    std::vector<std::unique_ptr<char[]>> _slabs;    // All slabs
+    char * _current;                                // Free part of the last slab
+    char * _end;
+    size_t _slabSize;                               // Size of the next slab
+
+public:
+// Public methods
+
+    // Larger blocks go to operator new
+    static const size_t MaxBlockSize = 256;
+    static const size_t Granularity = alignof(std::max_align_t);
+
+    NodePool();
+    NodePool(const NodePool&) = delete;
+
+    ~NodePool() = default;
+
+    void * Allocate(size_t);
+
+    void Deallocate(void *, size_t);
+
+    NodePool& operator = (const NodePool&) = delete;
+};
+
+inline size_t NodePool::_SizeClass(size_t size)
+{
+    return (std::max<size_t>(size, sizeof(_FreeBlock)) + Granularity - 1) / Granularity;
+}
+
+inline void NodePool::_NewSlab(size_t size)
+{
+    _slabSize = std::max(_slabSize * 2, size);
+    _slabs.emplace_back(new char[_slabSize]);
+    _current = _slabs.back().get();
+    _end = _current + _slabSize;
+}
+
+inline NodePool::NodePool() : _current(nullptr), _end(nullptr), _slabSize(2048) {}
+
+inline void * NodePool::Allocate(size_t size)
+{
+    if (size > MaxBlockSize) {
+        return ::operator new(size);
+    }
+
+    size_t sizeClass = _SizeClass(size);
+    if (sizeClass < _free.size() && _free[sizeClass]) {
+        _FreeBlock * block = _free[sizeClass];
+        _free[sizeClass] = block->_next_;
+        return block;
+    }
+
+    size = sizeClass * Granularity;
+    if (static_cast<size_t>(_end - _current) < size) {
+        _NewSlab(size);
+    }
+    void * block = _current;
+    _current += size;
+    return block;
+}
+
+inline void NodePool::Deallocate(void * ptr, size_t size)
+{
+    if (size > MaxBlockSize) {
+        ::operator delete(ptr);
+        return;
+    }
+
+    size_t sizeClass = _SizeClass(size);
+    if (_free.size() <= sizeClass) {
+        _free.resize(sizeClass + 1, nullptr);
+    }
+    _FreeBlock * block = static_cast<_FreeBlock*>(ptr);
+    block->_next_ = _free[sizeClass];
+    _free[sizeClass] = block;
+}
+
+// Standard allocator over a NodePool. A default constructed allocator
+// makes a new pool, copies (rebound ones too) share it, so a heap and
+// everything it allocates use one pool. Heaps built from copies of one
+// allocator share the pool and meld in O(1); heaps with different pools
+// copy nodes when melded
+template <typename T>
+class PoolAllocator {
+
+private:
+// Struct fields
+
+    std::shared_ptr<NodePool> _pool;
+
+    template <typename U>
+    friend class PoolAllocator;
+
+public:
+// Public methods
+
+    using value_type = T;
+
+    PoolAllocator();
+    PoolAllocator(const std::shared_ptr<NodePool>&);
+
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U>&);
+
+    T * allocate(size_t);
+
+    void deallocate(T *, size_t);
+
+    const std::shared_ptr<NodePool>& GetPool() const;
+
+    template <typename U>
+    bool operator == (const PoolAllocator<U>&) const;
+
+    template <typename U>
+    bool operator != (const PoolAllocator<U>&) const;
+};
+
+template <typename T>
+PoolAllocator<T>::PoolAllocator() : _pool(std::make_shared<NodePool>()) {}
+
+template <typename T>
+PoolAllocator<T>::PoolAllocator(const std::shared_ptr<NodePool>& pool) : _pool(pool) {}
+
+template <typename T>
+template <typename U>
+PoolAllocator<T>::PoolAllocator(const PoolAllocator<U>& rhs) : _pool(rhs._pool) {}
+
+template <typename T>
+T * PoolAllocator<T>::allocate(size_t count)
+{
+    static_assert(alignof(T) <= NodePool::Granularity, "PoolAllocator can't align blocks stricter than max_align_t");
+    return static_cast<T*>(_pool->Allocate(count * sizeof(T)));
+}
+
+template <typename T>
+void PoolAllocator<T>::deallocate(T * ptr, size_t count)
+{
+    _pool->Deallocate(ptr, count * sizeof(T));
+}
+
+template <typename T>
+const std::shared_ptr<NodePool>& PoolAllocator<T>::GetPool() const
+{
+    return _pool;
+}
+
+template <typename T>
+template <typename U>
+bool PoolAllocator<T>::operator == (const PoolAllocator<U>& rhs) const
+{
+    return _pool == rhs._pool;
+}
+
+template <typename T>
+template <typename U>
+bool PoolAllocator<T>::operator != (const PoolAllocator<U>& rhs) const
+{
+    return _pool != rhs._pool;
+}
+
+#endif /* NodePool_h */
@@ -0,0 +1,502 @@
+//
+//  PairingHeap.h
+//  Heaps
+//
+
+#ifndef PairingHeap_h
+#define PairingHeap_h
+
+#include <iostream>
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "IHeap.h"
+
+// Heap-ordered tree with any number of children. Insert, Meld and
+// DecreaseKey link two trees in O(1); ExtractMin pairs up the children of
+// the root, O(log n) amortized
+template <typename T = int, typename Compare = std::less<T>, typename Allocator = std::allocator<T>>
+class PairingHeap : public StaticHeap<PairingHeap<T, Compare, Allocator>, T, Compare>, private CompareHolder<Compare> {
+
+private:
+// Private functions and classes
+
+    class _HeapNode;
+
+    using _HeapNodePtr = _HeapNode*;
+
+    using _NodeAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<_HeapNode>;
+    using _NodeTraits = std::allocator_traits<_NodeAllocator>;
+
+    bool _Compare(const T&, const T&) const;
+
+    _HeapNodePtr _NewNode(const T&);
+
+    void _DeleteNode(_HeapNodePtr);
+
+    _HeapNodePtr _Link(_HeapNodePtr, _HeapNodePtr) const;
+
+    _HeapNodePtr _Combine(_HeapNodePtr) const;
+
+    static void _Cut(_HeapNodePtr);
+
+    static void _Merge(PairingHeap&, PairingHeap&);
+
+    template <typename Iterator>
+    _HeapNodePtr _Build(Iterator, Iterator);
+
+    void _CopyTree(_HeapNodePtr&, _HeapNodePtr);
+
+    void _ClearTree(_HeapNodePtr&);
+
+// Struct fields
+
+    _HeapNodePtr _root;         // Root of Tree
+    size_t _size;               // Size of Tree
+    _NodeAllocator _allocator;  // Allocator of nodes
+
+public:
+// Public methods
+
+    using Handle = HeapHandle<_HeapNode>;
+
+    PairingHeap();
+    explicit PairingHeap(const Allocator&);
+    explicit PairingHeap(const Compare&, const Allocator& = Allocator());
+    PairingHeap(const T&, const Allocator& = Allocator());
+    template <typename Iterator>
+    PairingHeap(Iterator, Iterator, const Allocator& = Allocator());
+    PairingHeap(const PairingHeap&);
+
+    ~PairingHeap();
+
+    Handle Insert(const T&);
+
+    template <typename Iterator>
+    void InsertBatch(Iterator, Iterator);
+
+    T GetMin() const;
+
+    T ExtractMin();
+
+    void DecreaseKey(Handle, const T&);
+
+    void Erase(Handle);
+
+    void Meld(PairingHeap&);
+
+    bool Empty() const;
+
+    size_t Size() const;
+
+    Allocator GetAllocator() const;
+
+    PairingHeap& operator = (const PairingHeap&);
+};
+
+template <typename T, typename Compare, typename Allocator>
+class PairingHeap<T, Compare, Allocator>::_HeapNode {
+public:
+// Struct fields
+
+    T _key_;                // Key
+    _HeapNodePtr _child_;   // First child
+    _HeapNodePtr _sibling_; // Next brother
+    _HeapNodePtr _prev_;    // Previous brother, the parent for the first child
+
+// Constructors and Destructor
+
+    _HeapNode(const T&);
+
+    ~_HeapNode() = default;
+};
+
+//
+// Constructors and Destructor
+//
+
+template <typename T, typename Compare, typename Allocator>
+PairingHeap<T, Compare, Allocator>::_HeapNode::_HeapNode(const T& key) : _key_(key), _child_(nullptr), _sibling_(nullptr), _prev_(nullptr) {}
+
+template <typename T, typename Compare, typename Allocator>
+PairingHeap<T, Compare, Allocator>::PairingHeap() : _root(nullptr), _size(0) {}
+
+template <typename T, typename Compare, typename Allocator>
+PairingHeap<T, Compare, Allocator>::PairingHeap(const Allocator& allocator) : _root(nullptr), _size(0), _allocator(allocator) {}
+
+template <typename T, typename Compare, typename Allocator>
+PairingHeap<T, Compare, Allocator>::PairingHeap(const Compare& compare, const Allocator& allocator) : CompareHolder<Compare>(compare),
+    _root(nullptr), _size(0), _allocator(allocator) {}
+
+template <typename T, typename Compare, typename Allocator>
+PairingHeap<T, Compare, Allocator>::PairingHeap(const T& key, const Allocator& allocator) : _root(nullptr), _size(1), _allocator(allocator)
+{
+    _root = _NewNode(key);
+}
+
+template <typename T, typename Compare, typename Allocator>
+template <typename Iterator>
+PairingHeap<T, Compare, Allocator>::PairingHeap(Iterator first, Iterator last, const Allocator& allocator) : _root(nullptr), _size(0), _allocator(allocator)
+{
+    _root = _Build(first, last);
+}
+
+template <typename T, typename Compare, typename Allocator>
+PairingHeap<T, Compare, Allocator>::PairingHeap(const PairingHeap& rhs) : CompareHolder<Compare>(rhs), _root(nullptr), _size(0),
+    _allocator(_NodeTraits::select_on_container_copy_construction(rhs._allocator))
+{
+    (*this) = rhs;
+}
+
+template <typename T, typename Compare, typename Allocator>
+PairingHeap<T, Compare, Allocator>::~PairingHeap()
+{
+    _ClearTree(_root);
+    _size = 0;
+}
+
+//
+// Private functions and methods
+//
+
+template <typename T, typename Compare, typename Allocator>
+inline bool PairingHeap<T, Compare, Allocator>::_Compare(const T& lhs, const T& rhs) const
+{
+    return this->GetCompare()(lhs, rhs);
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename PairingHeap<T, Compare, Allocator>::_HeapNodePtr PairingHeap<T, Compare, Allocator>::_NewNode(const T& key)
+{
+    _HeapNodePtr ptr = _NodeTraits::allocate(_allocator, 1);
+    try {
+        _NodeTraits::construct(_allocator, ptr, key);
+    } catch (...) {
+        _NodeTraits::deallocate(_allocator, ptr, 1);
+        throw;
+    }
+    return ptr;
+}
+
+template <typename T, typename Compare, typename Allocator>
+void PairingHeap<T, Compare, Allocator>::_DeleteNode(_HeapNodePtr ptr)
+{
+    _NodeTraits::destroy(_allocator, ptr);
+    _NodeTraits::deallocate(_allocator, ptr, 1);
+}
+
+// Links two trees without brothers: the larger root becomes the first
+// child of the smaller one
+template <typename T, typename Compare, typename Allocator>
+typename PairingHeap<T, Compare, Allocator>::_HeapNodePtr PairingHeap<T, Compare, Allocator>::_Link(_HeapNodePtr lhs, _HeapNodePtr rhs) const
+{
+    if (!lhs) {
+        return rhs;
+    } else if (!rhs) {
+        return lhs;
+    }
+
+    if (_Compare(rhs->_key_, lhs->_key_)) {
+        std::swap(lhs, rhs);
+    }
+
+    rhs->_sibling_ = lhs->_child_;
+    if (lhs->_child_) {
+        lhs->_child_->_prev_ = rhs;
+    }
+    rhs->_prev_ = lhs;
+    lhs->_child_ = rhs;
+
+    return lhs;
+}
+
+// Two-pass pairing of a list of brothers into one tree: links them in
+// pairs from left to right, then links the pairs from right to left
+template <typename T, typename Compare, typename Allocator>
+typename PairingHeap<T, Compare, Allocator>::_HeapNodePtr PairingHeap<T, Compare, Allocator>::_Combine(_HeapNodePtr first) const
+{
+    if (!first) {
+        return nullptr;
+    }
+
+    // Linked pairs, in reverse order
+    _HeapNodePtr pairs = nullptr;
+
+    while (first) {
+        _HeapNodePtr second = first->_sibling_;
+        _HeapNodePtr next = (second ? second->_sibling_ : nullptr);
+
+        first->_sibling_ = nullptr;
+        if (second) {
+            second->_sibling_ = nullptr;
+        }
+        _HeapNodePtr tree = _Link(first, second);
+        tree->_sibling_ = pairs;
+        pairs = tree;
+
+        first = next;
+    }
+
+    _HeapNodePtr result = pairs;
+    pairs = pairs->_sibling_;
+    result->_sibling_ = nullptr;
+
+    while (pairs) {
+        _HeapNodePtr next = pairs->_sibling_;
+        pairs->_sibling_ = nullptr;
+        result = _Link(result, pairs);
+        pairs = next;
+    }
+
+    result->_prev_ = nullptr;
+    return result;
+}
+
+// Unlinks the subtree of a node that is not the root
+template <typename T, typename Compare, typename Allocator>
+void PairingHeap<T, Compare, Allocator>::_Cut(_HeapNodePtr node)
+{
+    if (node->_prev_->_child_ == node) {
+        node->_prev_->_child_ = node->_sibling_;
+    } else {
+        node->_prev_->_sibling_ = node->_sibling_;
+    }
+    if (node->_sibling_) {
+        node->_sibling_->_prev_ = node->_prev_;
+    }
+    node->_sibling_ = nullptr;
+    node->_prev_ = nullptr;
+}
+
+// Nodes of rhs stay as they are when both heaps allocate from the same
+// place, otherwise lhs gets their copies
+template <typename T, typename Compare, typename Allocator>
+void PairingHeap<T, Compare, Allocator>::_Merge(PairingHeap& lhs, PairingHeap& rhs)
+{
+    if (&lhs == &rhs) {
+        return;
+    }
+
+    _HeapNodePtr tree = rhs._root;
+    if (lhs._allocator != rhs._allocator) {
+        lhs._CopyTree(tree, rhs._root);
+        rhs._ClearTree(rhs._root);
+    }
+
+    lhs._root = lhs._Link(lhs._root, tree);
+    lhs._size += rhs._size;
+
+    rhs._root = nullptr;
+    rhs._size = 0;
+}
+
+// Tree of the keys, linked in pairs the way a binary counter adds ones,
+// so that no root gets more than log n children; counts the keys in the
+// size
+template <typename T, typename Compare, typename Allocator>
+template <typename Iterator>
+typename PairingHeap<T, Compare, Allocator>::_HeapNodePtr PairingHeap<T, Compare, Allocator>::_Build(Iterator first, Iterator last)
+{
+    std::vector<std::pair<_HeapNodePtr, size_t>> trees;  // Trees with their sizes
+
+    for (; first != last; ++first) {
+        _HeapNodePtr tree = _NewNode(*first);
+        size_t count = 1;
+        _size++;
+
+        while (!trees.empty() && trees.back().second == count) {
+            tree = _Link(trees.back().first, tree);
+            count *= 2;
+            trees.pop_back();
+        }
+        trees.emplace_back(tree, count);
+    }
+
+    _HeapNodePtr result = nullptr;
+    for (; !trees.empty(); trees.pop_back()) {
+        result = _Link(trees.back().first, result);
+    }
+
+    return result;
+}
+
+// Brothers lists may be as long as the heap, so the tree is copied with
+// an explicit stack instead of recursion
+template <typename T, typename Compare, typename Allocator>
+void PairingHeap<T, Compare, Allocator>::_CopyTree(_HeapNodePtr& lhs, _HeapNodePtr rhs)
+{
+    lhs = nullptr;
+    if (!rhs) {
+        return;
+    }
+
+    lhs = _NewNode(rhs->_key_);
+
+    // Copied nodes whose children are not copied yet, with their originals
+    std::vector<std::pair<_HeapNodePtr, _HeapNodePtr>> stack;
+    stack.emplace_back(lhs, rhs);
+
+    while (!stack.empty()) {
+        _HeapNodePtr copy = stack.back().first;
+        _HeapNodePtr node = stack.back().second->_child_;
+        stack.pop_back();
+
+        _HeapNodePtr prev = copy;
+        _HeapNodePtr * link = &copy->_child_;
+        for (; node; node = node->_sibling_) {
+            (*link) = _NewNode(node->_key_);
+            (*link)->_prev_ = prev;
+            prev = (*link);
+            link = &(*link)->_sibling_;
+            if (node->_child_) {
+                stack.emplace_back(prev, node);
+            }
+        }
+    }
+}
+
+// Moves the children of a node in front of it before deleting it, so
+// that no recursion is needed
+template <typename T, typename Compare, typename Allocator>
+void PairingHeap<T, Compare, Allocator>::_ClearTree(_HeapNodePtr& ptr)
+{
+    _HeapNodePtr node = ptr;
+
+    while (node) {
+        if (node->_child_) {
+            _HeapNodePtr child = node->_child_;
+            node->_child_ = child->_sibling_;
+            child->_sibling_ = node;
+            node = child;
+        } else {
+            _HeapNodePtr next = node->_sibling_;
+            _DeleteNode(node);
+            node = next;
+        }
+    }
+
+    ptr = nullptr;
+}
+
+//
+// Public methods
+//
+
+template <typename T, typename Compare, typename Allocator>
+PairingHeap<T, Compare, Allocator>& PairingHeap<T, Compare, Allocator>::operator = (const PairingHeap& rhs)
+{
+    if (this == &rhs) {
+        return (*this);
+    }
+
+    _ClearTree(_root);
+    static_cast<CompareHolder<Compare>&>(*this) = rhs;
+    _size = rhs.Size();
+    _CopyTree(_root, rhs._root);
+
+    return (*this);
+}
+
+template <typename T, typename Compare, typename Allocator>
+size_t PairingHeap<T, Compare, Allocator>::Size() const
+{
+    return _size;
+}
+
+template <typename T, typename Compare, typename Allocator>
+bool PairingHeap<T, Compare, Allocator>::Empty() const
+{
+    return _size == 0;
+}
+
+template <typename T, typename Compare, typename Allocator>
+Allocator PairingHeap<T, Compare, Allocator>::GetAllocator() const
+{
+    return Allocator(_allocator);
+}
+
+template <typename T, typename Compare, typename Allocator>
+typename PairingHeap<T, Compare, Allocator>::Handle PairingHeap<T, Compare, Allocator>::Insert(const T& key)
+{
+    _HeapNodePtr node = _NewNode(key);
+    _root = _Link(_root, node);
+    _size++;
+    return Handle(node);
+}
+
+template <typename T, typename Compare, typename Allocator>
+template <typename Iterator>
+void PairingHeap<T, Compare, Allocator>::InsertBatch(Iterator first, Iterator last)
+{
+    _root = _Link(_root, _Build(first, last));
+}
+
+template <typename T, typename Compare, typename Allocator>
+T PairingHeap<T, Compare, Allocator>::GetMin() const
+{
+    if (!_root) {
+        throw std::range_error("No elements in Heap");
+    }
+    return _root->_key_;
+}
+
+template <typename T, typename Compare, typename Allocator>
+T PairingHeap<T, Compare, Allocator>::ExtractMin()
+{
+    if (!_root) {
+        throw std::range_error("No elements in Heap");
+    }
+
+    _HeapNodePtr result = _root;
+    _root = _Combine(_root->_child_);
+    _size--;
+
+    T answer = result->_key_;
+    _DeleteNode(result);
+
+    return answer;
+}
+
+// Cuts the subtree of the node and links it with the root, O(1)
+template <typename T, typename Compare, typename Allocator>
+void PairingHeap<T, Compare, Allocator>::DecreaseKey(Handle handle, const T& key)
+{
+    _HeapNodePtr node = handle.GetNode();
+    if (_Compare(node->_key_, key)) {
+        throw std::invalid_argument("New key is greater than the old one");
+    }
+    node->_key_ = key;
+
+    if (node != _root) {
+        _Cut(node);
+        _root = _Link(_root, node);
+    }
+}
+
+// Puts the pairing of the children in place of the node
+template <typename T, typename Compare, typename Allocator>
+void PairingHeap<T, Compare, Allocator>::Erase(Handle handle)
+{
+    _HeapNodePtr node = handle.GetNode();
+
+    if (node == _root) {
+        _root = _Combine(_root->_child_);
+    } else {
+        _Cut(node);
+        _root = _Link(_root, _Combine(node->_child_));
+    }
+    _size--;
+
+    _DeleteNode(node);
+}
+
+template <typename T, typename Compare, typename Allocator>
+void PairingHeap<T, Compare, Allocator>::Meld(PairingHeap& rhs)
+{
+    _Merge((*this), rhs);
+}
+
+#endif /* PairingHeap_h */
@@ -0,0 +1,304 @@
+//
+//  RadixHeap.h
+//  Heaps
+//
+
+#ifndef RadixHeap_h
+#define RadixHeap_h
+
+#include <iostream>
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+#include "IHeap.h"
+
+// Monotone priority queue of unsigned integers (radix heap of Ahuja,
+// Mehlhorn, Orlin and Tarjan): every key inserted must not be less than
+// the last extracted minimum, as in Dijkstra with nonnegative weights or
+// in timer queues. Bucket 0 holds keys equal to the last minimum, bucket i
+// keys whose highest bit differing from it is bit i - 1. Keys are placed
+// by their bits, without comparisons. When bucket 0 runs out the lowest
+// nonempty bucket is spread over the lower ones, and every key moves down
+// at most once per bit, so with keys below C Insert is O(1) and
+// ExtractMin O(log C) amortized.
+//
+// Insert throws std::invalid_argument on a key less than the last
+// extracted minimum. A heap that becomes empty forgets it and takes any
+// key again. GetMin looks through the lowest nonempty bucket when no key
+// equals the last minimum. Meld reinserts the keys of the heap with the
+// larger last minimum
+template <typename T = unsigned>
+class RadixHeap : public StaticHeap<RadixHeap<T>, T, std::less<>> {
+
+    static_assert(std::is_unsigned<T>::value, "RadixHeap needs unsigned keys");
+
+private:
+// Private functions and classes
+
+    static constexpr size_t _Buckets = std::numeric_limits<T>::digits + 1;
+
+    static size_t _BitWidth(T);
+
+    static size_t _LowestBit(uint64_t);
+
+    size_t _Bucket(const T&) const;
+
+    size_t _LowestBucket() const;
+
+    void _Push(const T&);
+
+    void _Spread();
+
+    static void _Merge(RadixHeap&, RadixHeap&);
+
+// Struct fields
+
+    std::vector<T> _buckets[_Buckets];
+    uint64_t _nonempty;     // Bit i - 1 is set when bucket i > 0 has keys
+    T _last;                // Last extracted minimum, 0 in an empty heap
+    size_t _size;           // Number of keys
+
+public:
+// Public methods
+
+    RadixHeap();
+    RadixHeap(const T&);
+    template <typename Iterator>
+    RadixHeap(Iterator, Iterator);
+    RadixHeap(const RadixHeap&) = default;
+
+    ~RadixHeap() = default;
+
+    void Insert(const T&);
+
+    // Forward iterators, the keys are checked before any is inserted
+    template <typename Iterator>
+    void InsertBatch(Iterator, Iterator);
+
+    T GetMin() const;
+
+    T ExtractMin();
+
+    void Meld(RadixHeap&);
+
+    bool Empty() const;
+
+    size_t Size() const;
+
+    RadixHeap& operator = (const RadixHeap&) = default;
+};
+
+//
+// Private functions and methods
+//
+
+// Position of the highest set bit plus one, x > 0
+template <typename T>
+inline size_t RadixHeap<T>::_BitWidth(T x)
+{
+#if defined(__GNUC__)
+    return static_cast<size_t>(std::numeric_limits<unsigned long long>::digits -
+                               __builtin_clzll(static_cast<unsigned long long>(x)));
+#else
+    size_t width = 0;
+    for (; x != 0; x >>= 1) {
+        width++;
+    }
+    return width;
+#endif
+}
+
+// Position of the lowest set bit, mask > 0
+template <typename T>
+inline size_t RadixHeap<T>::_LowestBit(uint64_t mask)
+{
+#if defined(__GNUC__)
+    return static_cast<size_t>(__builtin_ctzll(mask));
+#else
+    size_t bit = 0;
+    for (; (mask & 1) == 0; mask >>= 1) {
+        bit++;
+    }
+    return bit;
+#endif
+}
+
+template <typename T>
+inline size_t RadixHeap<T>::_Bucket(const T& key) const
+{
+    return key == _last ? 0 : _BitWidth(key ^ _last);
+}
+
+// Lowest nonempty bucket above bucket 0, there must be one
+template <typename T>
+inline size_t RadixHeap<T>::_LowestBucket() const
+{
+    return _LowestBit(_nonempty) + 1;
+}
+
+template <typename T>
+inline void RadixHeap<T>::_Push(const T& key)
+{
+    size_t bucket = _Bucket(key);
+    _buckets[bucket].push_back(key);
+    if (bucket > 0) {
+        _nonempty |= uint64_t(1) << (bucket - 1);
+    }
+}
+
+// Makes the minimum of the lowest nonempty bucket the last minimum and
+// spreads that bucket. Its keys share the bits above the bucket with the
+// new last minimum, so all of them go to lower buckets
+template <typename T>
+void RadixHeap<T>::_Spread()
+{
+    size_t index = _LowestBucket();
+    std::vector<T>& bucket = _buckets[index];
+
+    _last = (*std::min_element(bucket.begin(), bucket.end()));
+    for (const T& key : bucket) {
+        _Push(key);
+    }
+
+    bucket.clear();
+    _nonempty &= ~(uint64_t(1) << (index - 1));
+}
+
+// The heap with the smaller last minimum keeps its buckets, the keys of
+// the other one are inserted into it
+template <typename T>
+void RadixHeap<T>::_Merge(RadixHeap& lhs, RadixHeap& rhs)
+{
+    if (&lhs == &rhs || rhs._size == 0) {
+        return;
+    }
+    if (lhs._size == 0 || rhs._last < lhs._last || (rhs._last == lhs._last && lhs._size < rhs._size)) {
+        for (size_t i = 0; i < _Buckets; i++) {
+            std::swap(lhs._buckets[i], rhs._buckets[i]);
+        }
+        std::swap(lhs._nonempty, rhs._nonempty);
+        std::swap(lhs._last, rhs._last);
+        std::swap(lhs._size, rhs._size);
+    }
+
+    for (size_t i = 0; i < _Buckets; i++) {
+        for (const T& key : rhs._buckets[i]) {
+            lhs._Push(key);
+        }
+        rhs._buckets[i].clear();
+    }
+    lhs._size += rhs._size;
+    rhs._nonempty = 0;
+    rhs._last = 0;
+    rhs._size = 0;
+}
+
+//
+// Constructors
+//
+
+template <typename T>
+RadixHeap<T>::RadixHeap() : _nonempty(0), _last(0), _size(0) {}
+
+template <typename T>
+RadixHeap<T>::RadixHeap(const T& key) : _nonempty(0), _last(0), _size(0)
+{
+    Insert(key);
+}
+
+template <typename T>
+template <typename Iterator>
+RadixHeap<T>::RadixHeap(Iterator first, Iterator last) : _nonempty(0), _last(0), _size(0)
+{
+    InsertBatch(first, last);
+}
+
+//
+// Public methods
+//
+
+template <typename T>
+size_t RadixHeap<T>::Size() const
+{
+    return _size;
+}
+
+template <typename T>
+bool RadixHeap<T>::Empty() const
+{
+    return _size == 0;
+}
+
+template <typename T>
+void RadixHeap<T>::Insert(const T& key)
+{
+    if (key < _last) {
+        throw std::invalid_argument("Key is less than the last extracted minimum");
+    }
+    _Push(key);
+    _size++;
+}
+
+template <typename T>
+template <typename Iterator>
+void RadixHeap<T>::InsertBatch(Iterator first, Iterator last)
+{
+    if (first == last) {
+        return;
+    }
+
+    if ((*std::min_element(first, last)) < _last) {
+        throw std::invalid_argument("Key is less than the last extracted minimum");
+    }
+
+    for (; first != last; ++first) {
+        _Push(*first);
+        _size++;
+    }
+}
+
+template <typename T>
+T RadixHeap<T>::GetMin() const
+{
+    if (_size == 0) {
+        throw std::range_error("No elements in Heap");
+    }
+    if (!_buckets[0].empty()) {
+        return _last;
+    }
+
+    const std::vector<T>& bucket = _buckets[_LowestBucket()];
+    return (*std::min_element(bucket.begin(), bucket.end()));
+}
+
+template <typename T>
+T RadixHeap<T>::ExtractMin()
+{
+    if (_size == 0) {
+        throw std::range_error("No elements in Heap");
+    }
+    if (_buckets[0].empty()) {
+        _Spread();
+    }
+
+    T result = _last;
+    _buckets[0].pop_back();
+    _size--;
+    if (_size == 0) {
+        _last = 0;
+    }
+
+    return result;
+}
+
+template <typename T>
+void RadixHeap<T>::Meld(RadixHeap<T> & rhs)
+{
+    _Merge((*this), rhs);
+}
+
+#endif /* RadixHeap_h */
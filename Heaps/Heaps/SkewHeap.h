@@ -11,10 +11,15 @@
 
 #include <iostream>
 #include <algorithm>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
 #include "IHeap.h"
 
-template <typename T = int, typename Compare = std::less<T>>
-class SkewHeap : public IHeap<T, Compare> {
+template <typename T = int, typename Compare = std::less<T>, typename Allocator = std::allocator<T>>
+class SkewHeap : public StaticHeap<SkewHeap<T, Compare, Allocator>, T, Compare>, protected CompareHolder<Compare> {
     
 protected:
     
@@ -24,48 +29,79 @@ protected:
     
     using _HeapNodePtr = _HeapNode*;
     
-    static std::function <bool(const T&, const T&)> _Compare;
+    using _NodeAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<_HeapNode>;
+    using _NodeTraits = std::allocator_traits<_NodeAllocator>;
     
-    static _HeapNodePtr _Merge(_HeapNodePtr, _HeapNodePtr);
+    bool _Compare(const T&, const T&) const;
+    
+    _HeapNodePtr _NewNode(const T&);
+    
+    void _DeleteNode(_HeapNodePtr);
+    
+    _HeapNodePtr _Merge(_HeapNodePtr, _HeapNodePtr) const;
     
     static void _Merge(SkewHeap&, SkewHeap&);
     
-    static void _CopyTree(_HeapNodePtr&, const _HeapNodePtr&);
+    template <typename Iterator, typename Merge>
+    _HeapNodePtr _Build(Iterator, Iterator, Merge);
+    
+    _HeapNodePtr _Take(SkewHeap&);
+    
+    void _Replace(_HeapNodePtr, _HeapNodePtr);
     
-    static void _ClearTree(_HeapNodePtr&);
+    void _CopyTree(_HeapNodePtr&, _HeapNodePtr);
+    
+    void _ClearTree(_HeapNodePtr&);
     
 // Struct fields
     
-    _HeapNodePtr _root; // Root of Tree
-    size_t _size;       // Size of Tree
+    _HeapNodePtr _root;         // Root of Tree
+    size_t _size;               // Size of Tree
+    _NodeAllocator _allocator;  // Allocator of nodes
     
 public:
     
 // Public methods
     
+    using Handle = HeapHandle<_HeapNode>;
+    
     SkewHeap();
-    SkewHeap(const T&);
+    explicit SkewHeap(const Allocator&);
+    explicit SkewHeap(const Compare&, const Allocator& = Allocator());
+    SkewHeap(const T&, const Allocator& = Allocator());
+    template <typename Iterator>
+    SkewHeap(Iterator, Iterator, const Allocator& = Allocator());
     SkewHeap(const SkewHeap&);
     
-    virtual ~SkewHeap() override;
+    ~SkewHeap();
+    
+    Handle Insert(const T&);
     
-    virtual void Insert(const T&) override;
+    template <typename Iterator>
+    void InsertBatch(Iterator, Iterator);
     
-    virtual T GetMin() const override;
+    T GetMin() const;
 
-    virtual T ExtractMin() override;
+    T ExtractMin();
+    
+    void DecreaseKey(Handle, const T&);
+    
+    void Erase(Handle);
     
-    virtual void Meld(IHeap<T, Compare>&) override;
+    void Meld(SkewHeap&);
     
-    virtual bool Empty() const override;
+    bool Empty() const;
     
-    virtual size_t Size() const override;
+    size_t Size() const;
+    
+    Allocator GetAllocator() const;
     
     SkewHeap& operator = (const SkewHeap&);
 };
 
-template <typename T, typename Compare>
-class SkewHeap<T, Compare>::_HeapNode {
+// Nodes of LeftistHeap are the same, it keeps ranks in them
+template <typename T, typename Compare, typename Allocator>
+class SkewHeap<T, Compare, Allocator>::_HeapNode {
 public:
     
 // Struct fields
@@ -73,6 +109,8 @@ public:
     T _key_;                // Key
     _HeapNodePtr _left_;    // Left son
     _HeapNodePtr _right_;   // Right son
+    _HeapNodePtr _parent_;  // Parent, nullptr for the root
+    size_t _rank_;          // Rank in LeftistHeap
     
 // Constructors and Destructor
     
@@ -80,34 +118,52 @@ public:
     
     _HeapNode(const T&);
     
-    virtual ~_HeapNode() = default;
+    ~_HeapNode() = default;
 };
 
 //
 // Constructors and Desctuctors
 //
 
-template <typename T, typename Compare>
-SkewHeap<T, Compare>::_HeapNode::_HeapNode() : _left_(nullptr), _right_(nullptr) {}
+template <typename T, typename Compare, typename Allocator>
+SkewHeap<T, Compare, Allocator>::_HeapNode::_HeapNode() : _left_(nullptr), _right_(nullptr), _parent_(nullptr), _rank_(1) {}
+
+
+template <typename T, typename Compare, typename Allocator>
+SkewHeap<T, Compare, Allocator>::_HeapNode::_HeapNode(const T& key) : _key_(key), _left_(nullptr), _right_(nullptr), _parent_(nullptr), _rank_(1) {}
 
+template <typename T, typename Compare, typename Allocator>
+SkewHeap<T, Compare, Allocator>::SkewHeap() : _root(nullptr), _size(0) {}
 
-template <typename T, typename Compare>
-SkewHeap<T, Compare>::_HeapNode::_HeapNode(const T& key) : _key_(key), _left_(nullptr), _right_(nullptr) {}
+template <typename T, typename Compare, typename Allocator>
+SkewHeap<T, Compare, Allocator>::SkewHeap(const Allocator& allocator) : _root(nullptr), _size(0), _allocator(allocator) {}
 
-template <typename T, typename Compare>
-SkewHeap<T, Compare>::SkewHeap() : _root(nullptr), _size(0) {}
+template <typename T, typename Compare, typename Allocator>
+SkewHeap<T, Compare, Allocator>::SkewHeap(const Compare& compare, const Allocator& allocator) : CompareHolder<Compare>(compare),
+    _root(nullptr), _size(0), _allocator(allocator) {}
 
-template <typename T, typename Compare>
-SkewHeap<T, Compare>::SkewHeap(const T& element) : _root(new _HeapNode(element)), _size(1) {}
+template <typename T, typename Compare, typename Allocator>
+SkewHeap<T, Compare, Allocator>::SkewHeap(const T& element, const Allocator& allocator) : _root(nullptr), _size(1), _allocator(allocator)
+{
+    _root = _NewNode(element);
+}
 
-template <typename T, typename Compare>
-SkewHeap<T, Compare>::SkewHeap(const SkewHeap& rhs) : _root(nullptr), _size(rhs.Size())
+template <typename T, typename Compare, typename Allocator>
+template <typename Iterator>
+SkewHeap<T, Compare, Allocator>::SkewHeap(Iterator first, Iterator last, const Allocator& allocator) : _root(nullptr), _size(0), _allocator(allocator)
+{
+    _root = _Build(first, last, [this](_HeapNodePtr lhs, _HeapNodePtr rhs) { return _Merge(lhs, rhs); });
+}
+
+template <typename T, typename Compare, typename Allocator>
+SkewHeap<T, Compare, Allocator>::SkewHeap(const SkewHeap& rhs) : CompareHolder<Compare>(rhs), _root(nullptr), _size(rhs.Size()),
+    _allocator(_NodeTraits::select_on_container_copy_construction(rhs._allocator))
 {
     (*this) = rhs;
 }
 
-template <typename T, typename Compare>
-SkewHeap<T, Compare>::~SkewHeap()
+template <typename T, typename Compare, typename Allocator>
+SkewHeap<T, Compare, Allocator>::~SkewHeap()
 {
     _ClearTree(_root);
     _size = 0;
@@ -118,80 +174,208 @@ SkewHeap<T, Compare>::~SkewHeap()
 // Private functions and methods
 //
 
+template <typename T, typename Compare, typename Allocator>
+typename SkewHeap<T, Compare, Allocator>::_HeapNodePtr SkewHeap<T, Compare, Allocator>::_NewNode(const T& key)
+{
+    _HeapNodePtr ptr = _NodeTraits::allocate(_allocator, 1);
+    try {
+        _NodeTraits::construct(_allocator, ptr, key);
+    } catch (...) {
+        _NodeTraits::deallocate(_allocator, ptr, 1);
+        throw;
+    }
+    return ptr;
+}
+
+template <typename T, typename Compare, typename Allocator>
+void SkewHeap<T, Compare, Allocator>::_DeleteNode(_HeapNodePtr ptr)
+{
+    _NodeTraits::destroy(_allocator, ptr);
+    _NodeTraits::deallocate(_allocator, ptr, 1);
+}
 
-template <typename T, typename Compare>
-void SkewHeap<T, Compare>::_CopyTree(_HeapNodePtr & lhs, const _HeapNodePtr & rhs)
+// Paths may be as long as the heap, so the tree is copied with an
+// explicit stack instead of recursion
+template <typename T, typename Compare, typename Allocator>
+void SkewHeap<T, Compare, Allocator>::_CopyTree(_HeapNodePtr & lhs, _HeapNodePtr rhs)
 {
+    lhs = nullptr;
     if (rhs == nullptr) {
-        lhs = nullptr;
         return;
     }
     
-    lhs = new _HeapNode(rhs->_key_);
+    lhs = _NewNode(rhs->_key_);
+    lhs->_rank_ = rhs->_rank_;
+    
+    // Copied nodes whose sons are not copied yet, with their originals
+    std::vector<std::pair<_HeapNodePtr, _HeapNodePtr>> stack;
+    stack.emplace_back(lhs, rhs);
     
-    _CopyTree(lhs->_left_, rhs->_left_);
-    _CopyTree(lhs->_right_, rhs->_right_);
+    while (!stack.empty()) {
+        _HeapNodePtr copy = stack.back().first;
+        _HeapNodePtr node = stack.back().second;
+        stack.pop_back();
+        
+        if (node->_left_) {
+            copy->_left_ = _NewNode(node->_left_->_key_);
+            copy->_left_->_rank_ = node->_left_->_rank_;
+            copy->_left_->_parent_ = copy;
+            stack.emplace_back(copy->_left_, node->_left_);
+        }
+        if (node->_right_) {
+            copy->_right_ = _NewNode(node->_right_->_key_);
+            copy->_right_->_rank_ = node->_right_->_rank_;
+            copy->_right_->_parent_ = copy;
+            stack.emplace_back(copy->_right_, node->_right_);
+        }
+    }
 }
 
-template <typename T, typename Compare>
-void SkewHeap<T, Compare>::_ClearTree(_HeapNodePtr & ptr)
+// Rotates left sons up until the node has none, then deletes it and goes
+// on with its right son; no recursion and no extra memory
+template <typename T, typename Compare, typename Allocator>
+void SkewHeap<T, Compare, Allocator>::_ClearTree(_HeapNodePtr & ptr)
 {
-    if (ptr == nullptr) {
-        return;
+    _HeapNodePtr node = ptr;
+    
+    while (node) {
+        if (node->_left_) {
+            _HeapNodePtr left = node->_left_;
+            node->_left_ = left->_right_;
+            left->_right_ = node;
+            node = left;
+        } else {
+            _HeapNodePtr next = node->_right_;
+            _DeleteNode(node);
+            node = next;
+        }
     }
     
-    _ClearTree(ptr->_left_);
-    _ClearTree(ptr->_right_);
-    
-    delete ptr;
-    
     ptr = nullptr;
 }
 
-template <typename T, typename Compare>
-std::function<bool(const T&, const T&)> SkewHeap<T, Compare>::_Compare = Compare();
+template <typename T, typename Compare, typename Allocator>
+inline bool SkewHeap<T, Compare, Allocator>::_Compare(const T& lhs, const T& rhs) const
+{
+    return this->GetCompare()(lhs, rhs);
+}
 
 
-template <typename T, typename Compare>
-typename SkewHeap<T, Compare>::_HeapNodePtr SkewHeap<T, Compare>::_Merge(_HeapNodePtr lhs, _HeapNodePtr rhs)
+// Top-down: walks down the right paths taking the smaller root each time
+// and swaps the sons of every taken node, so the rest of the meld goes to
+// its left son
+template <typename T, typename Compare, typename Allocator>
+typename SkewHeap<T, Compare, Allocator>::_HeapNodePtr SkewHeap<T, Compare, Allocator>::_Merge(_HeapNodePtr lhs, _HeapNodePtr rhs) const
 {
-    if (!lhs) {
-        return rhs;
-    } else if (!rhs) {
-        return lhs;
+    _HeapNodePtr result = nullptr;
+    _HeapNodePtr * link = &result;
+    _HeapNodePtr parent = nullptr;
+    
+    while (lhs && rhs) {
+        if (_Compare(rhs->_key_, lhs->_key_)) {
+            std::swap(lhs, rhs);
+        }
+        (*link) = lhs;
+        lhs->_parent_ = parent;
+        parent = lhs;
+        
+        _HeapNodePtr next = lhs->_right_;
+        lhs->_right_ = lhs->_left_;
+        link = &lhs->_left_;
+        lhs = next;
     }
     
-    if (_Compare(lhs->_key_, rhs->_key_)) {
-        lhs->_right_ = _Merge(lhs->_right_, rhs);
-        
-        std::swap(lhs->_left_, lhs->_right_);
-        
-        return lhs;
-    } else {
-        rhs->_left_ = _Merge(lhs, rhs->_left_);
-        
-        std::swap(rhs->_right_, rhs->_left_);
+    (*link) = (lhs ? lhs : rhs);
+    if (*link) {
+        (*link)->_parent_ = parent;
+    }
+    
+    return result;
+}
+
+// Tree of the keys, melded in pairs the way a binary counter adds ones:
+// the stack holds trees of decreasing sizes, and a new node is melded
+// with the trees of its size. There are n / 2 melds of single nodes,
+// n / 4 of pairs and so on, O(n) in total, and the trees melded are the
+// ones just built, still in the cache. Counts the keys in the size
+template <typename T, typename Compare, typename Allocator>
+template <typename Iterator, typename Merge>
+typename SkewHeap<T, Compare, Allocator>::_HeapNodePtr SkewHeap<T, Compare, Allocator>::_Build(Iterator first, Iterator last, Merge merge)
+{
+    std::vector<std::pair<_HeapNodePtr, size_t>> trees;  // Trees with their sizes
+    
+    for (; first != last; ++first) {
+        _HeapNodePtr tree = _NewNode(*first);
+        size_t count = 1;
+        _size++;
         
-        return rhs;
+        while (!trees.empty() && trees.back().second == count) {
+            tree = merge(trees.back().first, tree);
+            count *= 2;
+            trees.pop_back();
+        }
+        trees.emplace_back(tree, count);
+    }
+    
+    _HeapNodePtr result = nullptr;
+    for (; !trees.empty(); trees.pop_back()) {
+        result = merge(trees.back().first, result);
     }
+    
+    return result;
 }
 
-template <typename T, typename Compare>
-void SkewHeap<T, Compare>::_Merge(SkewHeap& lhs, SkewHeap& rhs)
+// Takes the tree of rhs, leaving it empty. Nodes stay as they are when
+// both heaps allocate from the same place, otherwise they are copied
+template <typename T, typename Compare, typename Allocator>
+typename SkewHeap<T, Compare, Allocator>::_HeapNodePtr SkewHeap<T, Compare, Allocator>::_Take(SkewHeap& rhs)
 {
-    lhs._root = _Merge(lhs._root, rhs._root);
-    lhs._size += rhs._size;
+    _HeapNodePtr result = rhs._root;
+    if (_allocator != rhs._allocator) {
+        _CopyTree(result, rhs._root);
+        rhs._ClearTree(rhs._root);
+    }
     rhs._root = nullptr;
+    rhs._size = 0;
+    return result;
 }
 
-template <typename T, typename Compare>
-size_t SkewHeap<T, Compare>::Size() const
+template <typename T, typename Compare, typename Allocator>
+void SkewHeap<T, Compare, Allocator>::_Merge(SkewHeap& lhs, SkewHeap& rhs)
+{
+    if (&lhs == &rhs) {
+        return;
+    }
+    size_t size = rhs._size;
+    lhs._Replace(nullptr, lhs._Merge(lhs._root, lhs._Take(rhs)));
+    lhs._size += size;
+}
+
+// Puts tree in place of node (of the root for nullptr)
+template <typename T, typename Compare, typename Allocator>
+void SkewHeap<T, Compare, Allocator>::_Replace(_HeapNodePtr node, _HeapNodePtr tree)
+{
+    _HeapNodePtr parent = (node ? node->_parent_ : nullptr);
+    if (!parent) {
+        _root = tree;
+    } else if (parent->_left_ == node) {
+        parent->_left_ = tree;
+    } else {
+        parent->_right_ = tree;
+    }
+    if (tree) {
+        tree->_parent_ = parent;
+    }
+}
+
+template <typename T, typename Compare, typename Allocator>
+size_t SkewHeap<T, Compare, Allocator>::Size() const
 {
     return _size;
 }
 
-template <typename T, typename Compare>
-bool SkewHeap<T, Compare>::Empty() const
+template <typename T, typename Compare, typename Allocator>
+bool SkewHeap<T, Compare, Allocator>::Empty() const
 {
     return _size == 0;
 }
@@ -201,22 +385,29 @@ bool SkewHeap<T, Compare>::Empty() const
 // Public functions and methods
 //
 
-template <typename T, typename Compare>
-SkewHeap<T, Compare>& SkewHeap<T, Compare>::operator = (const SkewHeap<T, Compare>& rhs)
+template <typename T, typename Compare, typename Allocator>
+SkewHeap<T, Compare, Allocator>& SkewHeap<T, Compare, Allocator>::operator = (const SkewHeap<T, Compare, Allocator>& rhs)
 {
     if (this == &rhs) {
         return (*this);
     }
     
     _ClearTree(_root);
+    static_cast<CompareHolder<Compare>&>(*this) = rhs;
     _size = rhs.Size();
     _CopyTree(_root, rhs._root);
     
     return (*this);
 }
 
-template <typename T, typename Compare>
-T SkewHeap<T, Compare>::GetMin() const
+template <typename T, typename Compare, typename Allocator>
+Allocator SkewHeap<T, Compare, Allocator>::GetAllocator() const
+{
+    return Allocator(_allocator);
+}
+
+template <typename T, typename Compare, typename Allocator>
+T SkewHeap<T, Compare, Allocator>::GetMin() const
 {
     if (!_root) {
         throw std::range_error("No elements in Heap");
@@ -224,37 +415,70 @@ T SkewHeap<T, Compare>::GetMin() const
     return _root->_key_;
 }
 
-template <typename T, typename Compare>
-T SkewHeap<T, Compare>::ExtractMin()
+template <typename T, typename Compare, typename Allocator>
+T SkewHeap<T, Compare, Allocator>::ExtractMin()
 {
     if (!_root) {
         throw std::range_error("No elements in Heap");
     }
     _HeapNodePtr result = _root;
     
-    _root = _Merge(_root->_left_, _root->_right_);
+    _Replace(nullptr, _Merge(_root->_left_, _root->_right_));
+    _size--;
     T answer = result->_key_;
     
-    delete result;
+    _DeleteNode(result);
     
     return answer;
 }
 
-template <typename T, typename Compare>
-void SkewHeap<T, Compare>::Meld(IHeap<T, Compare>& rhs)
+// Cuts the subtree of the node and melds it with the rest
+template <typename T, typename Compare, typename Allocator>
+void SkewHeap<T, Compare, Allocator>::DecreaseKey(Handle handle, const T& key)
 {
-    try {
-        _Merge((*this), dynamic_cast<SkewHeap<T, Compare>&>(rhs));
-    } catch (const std::bad_cast& error) {
-        std::cerr << error.what();
-    };
+    _HeapNodePtr node = handle.GetNode();
+    if (_Compare(node->_key_, key)) {
+        throw std::invalid_argument("New key is greater than the old one");
+    }
+    node->_key_ = key;
+    
+    if (node->_parent_ && _Compare(key, node->_parent_->_key_)) {
+        _Replace(node, nullptr);
+        _Replace(nullptr, _Merge(_root, node));
+    }
 }
 
-template <typename T, typename Compare>
-void SkewHeap<T, Compare>::Insert(const T& element)
+// Puts the meld of the children in place of the node
+template <typename T, typename Compare, typename Allocator>
+void SkewHeap<T, Compare, Allocator>::Erase(Handle handle)
+{
+    _HeapNodePtr node = handle.GetNode();
+    _Replace(node, _Merge(node->_left_, node->_right_));
+    _size--;
+    _DeleteNode(node);
+}
+
+template <typename T, typename Compare, typename Allocator>
+void SkewHeap<T, Compare, Allocator>::Meld(SkewHeap<T, Compare, Allocator>& rhs)
 {
-    SkewHeap<T, Compare> rhs(element);
     _Merge((*this), rhs);
 }
 
+template <typename T, typename Compare, typename Allocator>
+typename SkewHeap<T, Compare, Allocator>::Handle SkewHeap<T, Compare, Allocator>::Insert(const T& element)
+{
+    _HeapNodePtr node = _NewNode(element);
+    _Replace(nullptr, _Merge(_root, node));
+    _size++;
+    return Handle(node);
+}
+
+template <typename T, typename Compare, typename Allocator>
+template <typename Iterator>
+void SkewHeap<T, Compare, Allocator>::InsertBatch(Iterator first, Iterator last)
+{
+    _HeapNodePtr tree = _Build(first, last, [this](_HeapNodePtr lhs, _HeapNodePtr rhs) { return _Merge(lhs, rhs); });
+    _Replace(nullptr, _Merge(_root, tree));
+}
+
 #endif /* SkewHeap_h */
@@ -15,7 +15,7 @@
 #include "IHeap.h"
 
 template <typename T = int, typename Compare = std::less<T>>
-class StlHeap : public IHeap<T, Compare>
+class StlHeap : public StaticHeap<StlHeap<T, Compare>, T, Compare>
 {
     
 private:
@@ -26,31 +26,44 @@ private:
 public:
     
     StlHeap() = default;
+    explicit StlHeap(const Compare&);
     StlHeap(const T&);
+    template <typename Iterator>
+    StlHeap(Iterator, Iterator);
     StlHeap(const StlHeap&);
     
-    ~StlHeap() override = default;
+    ~StlHeap() = default;
     
-    void Insert(const T&) override;
+    void Insert(const T&);
     
-    T GetMin() const override;
+    template <typename Iterator>
+    void InsertBatch(Iterator, Iterator);
+    
+    T GetMin() const;
 
-    T ExtractMin() override;
+    T ExtractMin();
     
-    void Meld(IHeap<T, Compare>&) override;
+    void Meld(StlHeap&);
     
-    bool Empty() const override; // TODO: Empty
+    bool Empty() const; // TODO: Empty
     
-    size_t Size() const override; // TODO: Size
+    size_t Size() const; // TODO: Size
     
     StlHeap& operator = (const StlHeap&);
 };
 
 
 
+template <typename T, typename Compare>
+StlHeap<T, Compare>::StlHeap(const Compare& compare) : _heap(compare) {}
+
 template <typename T, typename Compare>
 StlHeap<T, Compare>::StlHeap(const T& key) : _heap({key}) {}
 
+template <typename T, typename Compare>
+template <typename Iterator>
+StlHeap<T, Compare>::StlHeap(Iterator first, Iterator last) : _heap(first, last) {}
+
 template <typename T, typename Compare>
 StlHeap<T, Compare>::StlHeap(const StlHeap& rhs) : _heap(rhs._heap) {}
 
@@ -61,6 +74,13 @@ void StlHeap<T, Compare>::Insert(const T& key)
     _heap.insert(key);
 }
 
+template <typename T, typename Compare>
+template <typename Iterator>
+void StlHeap<T, Compare>::InsertBatch(Iterator first, Iterator last)
+{
+    _heap.insert(first, last);
+}
+
 template <typename T, typename Compare>
 T StlHeap<T, Compare>::GetMin() const
 {
@@ -82,9 +102,9 @@ T StlHeap<T, Compare>::ExtractMin()
 }
 
 template <typename T, typename Compare>
-void StlHeap<T, Compare>::Meld(IHeap<T, Compare> & rhs)
+void StlHeap<T, Compare>::Meld(StlHeap<T, Compare> & rhs)
 {
-    _heap.merge(dynamic_cast<StlHeap<T, Compare>&>(rhs)._heap);
+    _heap.merge(rhs._heap);
 }
 
 template <typename T, typename Compare>
@@ -1,9 +1,23 @@
 #include <iostream>
 #include <algorithm>
-#include <fstream>
+#include <limits>
+#include <map>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
 #include "Testing.h"
 
-using Heaps = testing::Types<BinomialHeap<KeyType, HeapCompare>, LeftistHeap<KeyType, HeapCompare>, SkewHeap<KeyType, HeapCompare> >;
+using Heaps = testing::Types<BinomialHeap<KeyType, HeapCompare>, LeftistHeap<KeyType, HeapCompare>, SkewHeap<KeyType, HeapCompare>,
+                             PairingHeap<KeyType, HeapCompare>, FibonacciHeap<KeyType, HeapCompare>,
+                             DaryHeap<KeyType, HeapCompare, 4>, DaryHeap<KeyType, HeapCompare, 8>,
+                             HeapAdaptor<BinomialHeap<KeyType, HeapCompare>>, HeapAdaptor<DaryHeap<KeyType, HeapCompare>>,
+                             HeapAdaptor<FibonacciHeap<KeyType, HeapCompare>>,
+                             BinomialHeap<KeyType, HeapCompare, PoolAllocator<KeyType>>,
+                             LeftistHeap<KeyType, HeapCompare, PoolAllocator<KeyType>>,
+                             SkewHeap<KeyType, HeapCompare, PoolAllocator<KeyType>>,
+                             PairingHeap<KeyType, HeapCompare, PoolAllocator<KeyType>>,
+                             FibonacciHeap<KeyType, HeapCompare, PoolAllocator<KeyType>> >;
 TYPED_TEST_SUITE(HeapTesting, Heaps);
 
 TYPED_TEST(HeapTesting, AddHeapTest)
@@ -91,24 +105,526 @@ TYPED_TEST(HeapTesting, Meld)
     }
 }
 
-TYPED_TEST(HeapTesting, AllTesting)
+TYPED_TEST(HeapTesting, InsertBatch)
 {
-    std::ifstream fin;
-    fin.open("/Users/jolex007/Documents/programming/MIPT/Practice/Heaps/tests/test.txt");
+    const size_t numberOfTests = 1000;
+
+    std::vector<KeyType> keys(numberOfTests);
+    for (KeyType& key : keys) {
+        key = rand();
+    }
+    StlHeap<KeyType, HeapCompare> expected(keys.begin(), keys.end());
 
-    size_t numberOfTests;
-    fin >> numberOfTests;
+    TypeParam heap(keys.begin(), keys.begin() + numberOfTests / 2);
+    ASSERT_EQ(heap.Size(), numberOfTests / 2);
+    heap.InsertBatch(keys.data() + numberOfTests / 2, keys.data() + numberOfTests);
+    heap.InsertBatch(keys.data(), keys.data());
+    ASSERT_EQ(heap.Size(), numberOfTests);
 
-    HeapTesting<TypeParam>::_heap.emplace_back();
-    HeapTesting<TypeParam>::_stlHeap.emplace_back();
+    for (size_t i = 0; i < numberOfTests; i++) {
+        if (i % 10 == 0) {
+            KeyType key = rand();
+            heap.InsertBatch(&key, &key + 1);
+            expected.Insert(key);
+        }
+        ASSERT_EQ(heap.ExtractMin(), expected.ExtractMin());
+    }
+    while (!expected.Empty()) {
+        ASSERT_EQ(heap.ExtractMin(), expected.ExtractMin());
+    }
+    ASSERT_TRUE(heap.Empty());
+}
+
+using MonotoneHeaps = testing::Types<RadixHeap<MonotoneKeyType>, HeapAdaptor<RadixHeap<MonotoneKeyType>>,
+                                     BinomialHeap<MonotoneKeyType, std::less<>>, PairingHeap<MonotoneKeyType, std::less<>>,
+                                     DaryHeap<MonotoneKeyType, std::less<>, 4>>;
+TYPED_TEST_SUITE(MonotoneHeapTesting, MonotoneHeaps);
+
+// Increment of a key over the last minimum: ties, small, middle and large
+// steps, so that keys land in low and high buckets of a radix heap
+MonotoneKeyType MonotoneStep(MonotoneKeyType minimum)
+{
+    MonotoneKeyType steps[] = {0, MonotoneKeyType(rand() % 16), MonotoneKeyType(rand() % 65536), MonotoneKeyType(rand())};
+    MonotoneKeyType step = steps[rand() % 4];
+    return std::min(step, std::numeric_limits<MonotoneKeyType>::max() - minimum);
+}
+
+// Dijkstra-like: every extraction is followed by 0, 1 or 2 keys above the
+// extracted minimum
+TYPED_TEST(MonotoneHeapTesting, MonotoneWorkload)
+{
+    const size_t numberOfTests = 100000;
+
+    TypeParam heap;
+    StlHeap<MonotoneKeyType, std::less<>> expected;
+    MonotoneKeyType minimum = 0;
+
+    for (size_t i = 0; i < numberOfTests; i++) {
+        if (expected.Empty()) {
+            ASSERT_ANY_THROW(heap.GetMin());
+            ASSERT_ANY_THROW(heap.ExtractMin());
+            MonotoneKeyType key = minimum + MonotoneStep(minimum);
+            heap.Insert(key);
+            expected.Insert(key);
+        }
+
+        ASSERT_EQ(heap.GetMin(), expected.GetMin());
+        minimum = heap.ExtractMin();
+        ASSERT_EQ(minimum, expected.ExtractMin());
+
+        for (int k = rand() % 3; k > 0; k--) {
+            MonotoneKeyType key = minimum + MonotoneStep(minimum);
+            heap.Insert(key);
+            expected.Insert(key);
+        }
+        ASSERT_EQ(heap.Size(), expected.Size());
+    }
+}
+
+// Heaps built from batches and partly drained, each up to its own minimum,
+// then melded together
+TYPED_TEST(MonotoneHeapTesting, InsertBatchAndMeld)
+{
+    const size_t numberOfHeaps = 50;
+    const size_t numberOfKeys = 200;
+
+    std::vector<TypeParam> heaps;
+    StlHeap<MonotoneKeyType, std::less<>> expected;
+
+    for (size_t k = 0; k < numberOfHeaps; k++) {
+        MonotoneKeyType base = rand() % 1000000;
+        std::vector<MonotoneKeyType> keys(numberOfKeys);
+        for (MonotoneKeyType& key : keys) {
+            key = base + MonotoneStep(base);
+        }
+        heaps.emplace_back(keys.begin(), keys.begin() + numberOfKeys / 2);
+        heaps.back().InsertBatch(keys.data() + numberOfKeys / 2, keys.data() + numberOfKeys);
+
+        std::sort(keys.begin(), keys.end());
+        size_t extracted = rand() % numberOfKeys;
+        for (size_t i = 0; i < extracted; i++) {
+            ASSERT_EQ(heaps.back().ExtractMin(), keys[i]);
+        }
+        expected.InsertBatch(keys.begin() + extracted, keys.end());
+    }
+
+    while (heaps.size() > 1) {
+        size_t index = rand() % (heaps.size() - 1) + 1;
+        heaps[0].Meld(heaps[index]);
+        ASSERT_TRUE(heaps[index].Empty());
+        heaps.erase(heaps.begin() + index);
+    }
+
+    TypeParam& heap = heaps[0];
+    ASSERT_EQ(heap.Size(), expected.Size());
+    while (!expected.Empty()) {
+        MonotoneKeyType minimum = heap.ExtractMin();
+        ASSERT_EQ(minimum, expected.ExtractMin());
+        if (rand() % 2 == 0) {
+            MonotoneKeyType key = minimum + MonotoneStep(minimum);
+            heap.Insert(key);
+            expected.Insert(key);
+        }
+    }
+    ASSERT_TRUE(heap.Empty());
+}
+
+TEST(RadixHeap, MonotoneBound)
+{
+    static_assert(std::is_base_of<IHeap<unsigned, std::less<>>, HeapAdaptor<RadixHeap<>>>::value,
+                  "RadixHeap is an IHeap of unsigned keys through HeapAdaptor");
+
+    RadixHeap<> heap;
+    heap.Insert(10);
+    heap.Insert(20);
+    ASSERT_EQ(heap.ExtractMin(), 10u);
+    ASSERT_THROW(heap.Insert(5), std::invalid_argument);
+
+    std::vector<unsigned> keys = {30, 9, 40};
+    ASSERT_THROW(heap.InsertBatch(keys.begin(), keys.end()), std::invalid_argument);
+    ASSERT_EQ(heap.Size(), 1u);
+
+    heap.Insert(10);
+    ASSERT_EQ(heap.ExtractMin(), 10u);
+    ASSERT_EQ(heap.ExtractMin(), 20u);
+    ASSERT_THROW(heap.ExtractMin(), std::range_error);
+
+    // An empty heap takes any key
+    heap.Insert(0);
+    heap.Insert(std::numeric_limits<unsigned>::max());
+    ASSERT_EQ(heap.ExtractMin(), 0u);
+    ASSERT_EQ(heap.GetMin(), std::numeric_limits<unsigned>::max());
+
+    RadixHeap<unsigned long long> wide;
+    const unsigned long long top = std::numeric_limits<unsigned long long>::max();
+    for (unsigned long long key : {top, top - 1, 1ULL << 63, 0ULL, 1ULL}) {
+        wide.Insert(key);
+    }
+    for (unsigned long long key : {0ULL, 1ULL, 1ULL << 63, top - 1, top}) {
+        ASSERT_EQ(wide.ExtractMin(), key);
+    }
+    ASSERT_TRUE(wide.Empty());
+}
 
-    std::chrono::time_point<std::chrono::system_clock> start, end;
+using ComparedHeaps = testing::Types<BinomialHeap<KeyType, DirectedCompare>, LeftistHeap<KeyType, DirectedCompare>,
+                                     SkewHeap<KeyType, DirectedCompare>, PairingHeap<KeyType, DirectedCompare>,
+                                     FibonacciHeap<KeyType, DirectedCompare>, DaryHeap<KeyType, DirectedCompare, 4>,
+                                     StlHeap<KeyType, DirectedCompare>>;
+TYPED_TEST_SUITE(CompareTesting, ComparedHeaps);
 
+// Copies take the comparator of the source along with its keys
+TYPED_TEST(CompareTesting, CopyComparator)
+{
+    const size_t numberOfTests = 1000;
+
+    DirectedCompare compare;
+    compare.descending = true;
+
+    TypeParam descending(compare);
+    TypeParam ascending;
+    std::vector<KeyType> keys;
     for (size_t i = 0; i < numberOfTests; i++) {
-        int operationType;
-        fin >> operationType;
+        KeyType key = rand() % 2000 - 1000;
+        descending.Insert(key);
+        ascending.Insert(-key);
+        keys.push_back(key);
+    }
+    std::sort(keys.begin(), keys.end(), [](KeyType lhs, KeyType rhs) { return lhs > rhs; });
+
+    TypeParam copy(descending);
+    ascending = descending;
+    ascending.Insert(keys.front());
+    copy.Insert(keys.front());
+    keys.insert(keys.begin(), keys.front());
+
+    for (KeyType key : keys) {
+        ASSERT_EQ(ascending.ExtractMin(), key);
+        ASSERT_EQ(copy.ExtractMin(), key);
+    }
+    ASSERT_TRUE(ascending.Empty());
+    ASSERT_TRUE(copy.Empty());
+}
+
+// Heaps sharing one pool meld without copying, and keep working after
+// the heap that allocated their nodes is gone
+template <typename Heap>
+void TestSharedPoolMeld()
+{
+    PoolAllocator<KeyType> allocator;
+    StlHeap<KeyType, HeapCompare> expected;
+    Heap heap(allocator);
+
+    for (int k = 0; k < 100; k++) {
+        Heap other(allocator);
+        for (int i = 0; i < 100; i++) {
+            KeyType key = rand();
+            other.Insert(key);
+            expected.Insert(key);
+        }
+        heap.Meld(other);
+        ASSERT_TRUE(other.Empty());
+    }
+
+    ASSERT_EQ(heap.Size(), expected.Size());
+    while (!expected.Empty()) {
+        ASSERT_EQ(heap.ExtractMin(), expected.ExtractMin());
+    }
+    ASSERT_TRUE(heap.Empty());
+}
+
+TEST(NodePool, SharedPoolMeld)
+{
+    TestSharedPoolMeld<BinomialHeap<KeyType, HeapCompare, PoolAllocator<KeyType>>>();
+    TestSharedPoolMeld<LeftistHeap<KeyType, HeapCompare, PoolAllocator<KeyType>>>();
+    TestSharedPoolMeld<SkewHeap<KeyType, HeapCompare, PoolAllocator<KeyType>>>();
+    TestSharedPoolMeld<PairingHeap<KeyType, HeapCompare, PoolAllocator<KeyType>>>();
+    TestSharedPoolMeld<FibonacciHeap<KeyType, HeapCompare, PoolAllocator<KeyType>>>();
+}
+
+// Random inserts, decreases, erases and extractions of distinct keys,
+// checked against the map of keys to their handles
+template <typename Heap>
+void TestHandles()
+{
+    const size_t numberOfTests = 20000;
+
+    Heap heap;
+    std::map<KeyType, typename Heap::Handle> keys;
+
+    auto newKey = [&keys](KeyType upper) {
+        KeyType key;
+        do {
+            key = rand() % upper;
+        } while (keys.count(key));
+        return key;
+    };
+    auto randomKey = [&keys]() {
+        auto it = keys.lower_bound(rand());
+        return (it == keys.end() ? keys.begin() : it);
+    };
+
+    for (size_t i = 0; i < numberOfTests; i++) {
+        int operationType = (keys.empty() ? 0 : rand() % 4);
+
+        if (operationType == 0) {
+            KeyType key = newKey(RAND_MAX);
+            keys[key] = heap.Insert(key);
+        } else if (operationType == 1) {
+            auto it = randomKey();
+            if (it->first == 0) {
+                continue;
+            }
+            KeyType key = newKey(it->first);
+            ASSERT_NO_THROW(heap.DecreaseKey(it->second, key));
+            keys[key] = it->second;
+            keys.erase(it);
+        } else if (operationType == 2) {
+            auto it = randomKey();
+            ASSERT_NO_THROW(heap.Erase(it->second));
+            keys.erase(it);
+        } else {
+            ASSERT_EQ(heap.ExtractMin(), keys.begin()->first);
+            keys.erase(keys.begin());
+        }
+
+        ASSERT_EQ(heap.Size(), keys.size());
+        if (!keys.empty()) {
+            ASSERT_EQ(heap.GetMin(), keys.begin()->first);
+        }
+    }
+
+    Heap copy(heap);
+    for (auto it = keys.begin(); it != keys.end(); it++) {
+        ASSERT_EQ(heap.ExtractMin(), it->first);
+        ASSERT_EQ(copy.ExtractMin(), it->first);
+    }
+    ASSERT_TRUE(heap.Empty());
+    ASSERT_TRUE(copy.Empty());
+}
+
+TEST(Handles, DecreaseKeyAndErase)
+{
+    TestHandles<BinomialHeap<KeyType, HeapCompare>>();
+    TestHandles<LeftistHeap<KeyType, HeapCompare>>();
+    TestHandles<SkewHeap<KeyType, HeapCompare>>();
+    TestHandles<PairingHeap<KeyType, HeapCompare>>();
+    TestHandles<FibonacciHeap<KeyType, HeapCompare>>();
+    TestHandles<BinomialHeap<KeyType, HeapCompare, PoolAllocator<KeyType>>>();
+    TestHandles<LeftistHeap<KeyType, HeapCompare, PoolAllocator<KeyType>>>();
+    TestHandles<PairingHeap<KeyType, HeapCompare, PoolAllocator<KeyType>>>();
+    TestHandles<FibonacciHeap<KeyType, HeapCompare, PoolAllocator<KeyType>>>();
+}
 
-        HeapTesting<TypeParam>::typeOfTests[operationType]++;
+// Handles of keys inserted after a batch go through the nodes the batch
+// built when they are decreased and erased
+template <typename Heap>
+void TestBatchHandles()
+{
+    const KeyType size = 1000;
+
+    std::vector<KeyType> keys;
+    for (KeyType i = 0; i < size; i++) {
+        keys.push_back(2 * ((i * 7919) % size));
+    }
+    Heap heap(keys.begin(), keys.end());
+    StlHeap<KeyType, HeapCompare> expected(keys.begin(), keys.end());
+
+    std::vector<typename Heap::Handle> handles;
+    for (KeyType i = 0; i < size; i++) {
+        handles.push_back(heap.Insert(2 * i + 1));
+    }
+    for (KeyType i = 0; i < size; i++) {
+        if (i % 2 == 0) {
+            ASSERT_NO_THROW(heap.Erase(handles[i]));
+        } else {
+            ASSERT_NO_THROW(heap.DecreaseKey(handles[i], -i));
+            expected.Insert(-i);
+        }
+    }
+
+    ASSERT_EQ(heap.Size(), expected.Size());
+    while (!expected.Empty()) {
+        ASSERT_EQ(heap.ExtractMin(), expected.ExtractMin());
+    }
+}
+
+TEST(Handles, AfterInsertBatch)
+{
+    TestBatchHandles<BinomialHeap<KeyType, HeapCompare>>();
+    TestBatchHandles<LeftistHeap<KeyType, HeapCompare>>();
+    TestBatchHandles<SkewHeap<KeyType, HeapCompare>>();
+    TestBatchHandles<PairingHeap<KeyType, HeapCompare>>();
+    TestBatchHandles<FibonacciHeap<KeyType, HeapCompare>>();
+}
+
+TEST(Handles, IncreaseThrows)
+{
+    BinomialHeap<KeyType, HeapCompare> heap;
+    auto handle = heap.Insert(10);
+    ASSERT_THROW(heap.DecreaseKey(handle, 20), std::invalid_argument);
+    ASSERT_EQ(heap.GetMin(), 10);
+}
+
+// Sorted insertions make long paths in skew and leftist heaps; melding,
+// copying and clearing them must not depend on the stack depth
+template <typename Heap>
+void TestLongPaths()
+{
+    const KeyType size = 1000000;
+
+    Heap lhs, rhs;
+    for (KeyType i = 0; i < size; i++) {
+        lhs.Insert(2 * i);
+        rhs.Insert(2 * (size - i) - 1);
+    }
+
+    lhs.Meld(rhs);
+    Heap copy(lhs);
+
+    ASSERT_EQ(lhs.Size(), size_t(2 * size));
+    ASSERT_TRUE(rhs.Empty());
+    for (KeyType i = 0; i < 2 * size; i++) {
+        ASSERT_EQ(lhs.ExtractMin(), i);
+    }
+    ASSERT_EQ(copy.GetMin(), 0);
+}
+
+TEST(LongPaths, MeldSortedHeaps)
+{
+    TestLongPaths<SkewHeap<KeyType, HeapCompare>>();
+    TestLongPaths<LeftistHeap<KeyType, HeapCompare>>();
+    TestLongPaths<SkewHeap<KeyType, HeapCompare, PoolAllocator<KeyType>>>();
+    TestLongPaths<LeftistHeap<KeyType, HeapCompare, PoolAllocator<KeyType>>>();
+}
+
+// Threads insert distinct keys and extract some of them at the same time;
+// every key must come out exactly once
+TEST(MultiQueue, ConcurrentInsertExtract)
+{
+    const size_t numberOfThreads = 8;
+    const KeyType keysPerThread = 20000;
+
+    // One heap makes every thread wait for the same lock
+    for (size_t queues : {1, 4}) {
+        MultiQueue<KeyType, HeapCompare> queue(queues);
+        std::vector<std::vector<KeyType>> extracted(numberOfThreads);
+        std::vector<std::thread> threads;
+
+        for (size_t t = 0; t < numberOfThreads; t++) {
+            threads.emplace_back([&queue, &extracted, t, keysPerThread]() {
+                for (KeyType i = 0; i < keysPerThread; i++) {
+                    queue.Insert(static_cast<KeyType>(t) * keysPerThread + i);
+                    KeyType key;
+                    if (i % 2 == 1 && queue.TryExtractMin(key)) {
+                        extracted[t].push_back(key);
+                    }
+                }
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+
+        std::vector<KeyType> keys;
+        for (const std::vector<KeyType>& part : extracted) {
+            keys.insert(keys.end(), part.begin(), part.end());
+        }
+        ASSERT_EQ(queue.Size(), numberOfThreads * keysPerThread - keys.size());
+        KeyType key;
+        while (queue.TryExtractMin(key)) {
+            keys.push_back(key);
+        }
+        ASSERT_TRUE(queue.Empty());
+        ASSERT_THROW(queue.ExtractMin(), std::range_error);
+
+        std::sort(keys.begin(), keys.end());
+        ASSERT_EQ(keys.size(), numberOfThreads * keysPerThread);
+        for (size_t i = 0; i < keys.size(); i++) {
+            ASSERT_EQ(keys[i], static_cast<KeyType>(i));
+        }
+    }
+}
+
+// Rank of an extracted key is the number of smaller keys left in the
+// queue; it is 0 for one heap and stays O(q) on average for q heaps
+TEST(MultiQueue, RankError)
+{
+    const KeyType size = 100000;
+
+    for (size_t queues : {1, 4, 16}) {
+        MultiQueue<KeyType, HeapCompare> queue(queues);
+        std::vector<KeyType> keys(size);
+        for (KeyType i = 0; i < size; i++) {
+            keys[i] = i;
+        }
+        std::shuffle(keys.begin(), keys.end(), std::mt19937(2019));
+        for (KeyType key : keys) {
+            queue.Insert(key);
+        }
+
+        // Fenwick tree of the extracted keys
+        std::vector<KeyType> tree(size + 1, 0);
+        double sum = 0;
+        KeyType maximum = 0;
+        for (KeyType i = 0; i < size; i++) {
+            KeyType key = queue.ExtractMin();
+            KeyType smaller = 0;
+            for (KeyType k = key; k > 0; k -= k & -k) {
+                smaller += tree[k];
+            }
+            for (KeyType k = key + 1; k <= size; k += k & -k) {
+                tree[k]++;
+            }
+            sum += key - smaller;
+            maximum = std::max(maximum, key - smaller);
+        }
+
+        RecordProperty("MeanRankError" + std::to_string(queues), std::to_string(sum / size));
+        RecordProperty("MaxRankError" + std::to_string(queues), std::to_string(maximum));
+        if (queues == 1) {
+            ASSERT_EQ(maximum, 0);
+        }
+        ASSERT_LE(sum / size, 2.0 * queues);
+    }
+}
+
+// Every heap of the queue must order keys by the comparator the queue got,
+// not by a default constructed one
+TEST(MultiQueue, StatefulCompare)
+{
+    const KeyType size = 10000;
+    DirectedCompare compare;
+    compare.descending = true;
+
+    for (size_t queues : {1, 4, 16}) {
+        MultiQueue<KeyType, DirectedCompare> queue(queues, compare);
+        for (KeyType key = 0; key < size; key++) {
+            queue.Insert(key);
+        }
+
+        for (KeyType i = 0; i < size; i++) {
+            KeyType key = queue.ExtractMin();
+            if (queues == 1) {
+                ASSERT_EQ(key, size - 1 - i);
+            } else if (i < size / 4) {
+                ASSERT_GE(key, size / 2);
+            }
+        }
+        ASSERT_TRUE(queue.Empty());
+    }
+}
+
+// Random operations on many heaps checked against StlHeap. Timing is done
+// by HeapsWorkloads, not here
+TYPED_TEST(HeapTesting, AllTesting)
+{
+    const size_t numberOfTests = 1000;
+
+    HeapTesting<TypeParam>::_heap.emplace_back();
+    HeapTesting<TypeParam>::_stlHeap.emplace_back();
+
+    for (size_t i = 0; i < numberOfTests; i++) {
+        int operationType = rand() % 5;
 
         KeyType key;
         size_t index;
@@ -122,10 +638,7 @@ TYPED_TEST(HeapTesting, AllTesting)
 
             key = rand();
 
-            start = std::chrono::system_clock::now();
             ASSERT_NO_THROW(HeapTesting<TypeParam>::AddHeap(key));
-            end = std::chrono::system_clock::now();
-
             ASSERT_NO_THROW(HeapTesting<TypeParam>::AddHeapStl(key));
         break;
 
@@ -134,10 +647,7 @@ TYPED_TEST(HeapTesting, AllTesting)
             key = rand();
             index = rand() % HeapTesting<TypeParam>::_heap.size();
 
-            start = std::chrono::system_clock::now();
             ASSERT_NO_THROW(HeapTesting<TypeParam>::Insert(index, key));
-            end = std::chrono::system_clock::now();
-
             ASSERT_NO_THROW(HeapTesting<TypeParam>::InsertStl(index, key));
         break;
 
@@ -152,13 +662,11 @@ TYPED_TEST(HeapTesting, AllTesting)
             } catch (...) {
                 flag = false;
             }
-            start = std::chrono::system_clock::now();
             if (flag) {
                 ASSERT_EQ(HeapTesting<TypeParam>::GetMin(index), key);
             } else {
                 ASSERT_ANY_THROW(HeapTesting<TypeParam>::GetMin(index));
             }
-            end = std::chrono::system_clock::now();
         break;
 
         case 3: // ExtractMin
@@ -173,13 +681,11 @@ TYPED_TEST(HeapTesting, AllTesting)
                 flag = false;
             }
 
-            start = std::chrono::system_clock::now();
             if (flag) {
                 ASSERT_EQ(HeapTesting<TypeParam>::ExtractMin(index), key);
             } else {
                 ASSERT_ANY_THROW(HeapTesting<TypeParam>::ExtractMin(index));
             }
-            end = std::chrono::system_clock::now();
 
         break;
 
@@ -194,31 +700,19 @@ TYPED_TEST(HeapTesting, AllTesting)
             while (index2 == index1) {
                 index2 = rand() % HeapTesting<TypeParam>::_heap.size();
             }
-            start = std::chrono::system_clock::now();
             ASSERT_NO_THROW(HeapTesting<TypeParam>::Meld(index1, index2));
-            end = std::chrono::system_clock::now();
-
             ASSERT_NO_THROW(HeapTesting<TypeParam>::MeldStl(index1, index2));
         break;
         }
-
-        HeapTesting<TypeParam>::summaryTime += std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
     }
-    
-    fin.close();
-}
-
-
-void CreateTests(const size_t numberOfTests)
-{
-    std::ofstream fout;
-    fout.open("/Users/jolex007/Documents/programming/MIPT/Practice/Heaps/tests/test.txt");
 
-    fout << numberOfTests << "\n";
-
-    for (size_t i = 0; i < numberOfTests; i++) {
-        fout << rand() % 5 << " ";
+    // The heaps left must hold the same keys as their StlHeap copies
+    ASSERT_EQ(HeapTesting<TypeParam>::_heap.size(), HeapTesting<TypeParam>::_stlHeap.size());
+    for (size_t index = 0; index < HeapTesting<TypeParam>::_heap.size(); index++) {
+        ASSERT_EQ(HeapTesting<TypeParam>::_heap[index].Size(), HeapTesting<TypeParam>::_stlHeap[index].Size());
+        while (!HeapTesting<TypeParam>::_stlHeap[index].Empty()) {
+            ASSERT_EQ(HeapTesting<TypeParam>::ExtractMin(index), HeapTesting<TypeParam>::ExtractMinStl(index));
+        }
+        ASSERT_TRUE(HeapTesting<TypeParam>::_heap[index].Empty());
     }
-
-    fout.close();
-}
\ No newline at end of file
+}
@@ -11,11 +11,16 @@
 
 #include <iostream>
 #include <algorithm>
-#include <time.h>
-#include <chrono>
 #include "gtest/gtest.h"
 #include "BinomialHeap.h"
+#include "DaryHeap.h"
+#include "FibonacciHeap.h"
+#include "HeapAdaptor.h"
 #include "LeftistHeap.h"
+#include "MultiQueue.h"
+#include "NodePool.h"
+#include "PairingHeap.h"
+#include "RadixHeap.h"
 #include "SkewHeap.h"
 #include "StlHeap.h"
 
@@ -50,20 +55,33 @@ protected:
     void MeldStl(size_t index1, size_t index2);
 
 public:
-    unsigned int summaryTime = 0;
-    std::vector <int> typeOfTests;
-
     std::vector <T> _heap;
     std::vector <StlHeap<KeyType, HeapCompare>> _stlHeap;
 };
 
+// Comparator with state: orders keys up or down
+struct DirectedCompare {
+    bool descending = false;
+
+    bool operator () (KeyType lhs, KeyType rhs) const { return descending ? rhs < lhs : lhs < rhs; }
+};
+
+// Heaps with a comparator that has state
+template <typename T>
+class CompareTesting : public ::testing::Test {};
+
+using MonotoneKeyType = unsigned;
+
+// Heaps under monotone workloads: no key inserted is less than the last
+// extracted minimum, so RadixHeap can take part
+template <typename T>
+class MonotoneHeapTesting : public ::testing::Test {};
+
 template <typename T>
 void HeapTesting<T>::SetUp()
 {
     _heap.clear();
     _stlHeap.clear();
-    summaryTime = 0;
-    typeOfTests.resize(5, 0);
 }
 
 template <typename T>
@@ -71,15 +89,6 @@ void HeapTesting<T>::TearDown()
 {
     _heap.clear();
     _stlHeap.clear();
-    if (summaryTime != 0) {
-        std::cout << summaryTime << " - time of " << typeid(T).name() << "\n\n";
-        std::cout << "Where:\n";
-        std::cout << typeOfTests[0] << " - number of \"AddHeap\" tests\n";
-        std::cout << typeOfTests[1] << " - number of \"Insert\" tests\n";
-        std::cout << typeOfTests[2] << " - number of \"GetMin\" tests\n";
-        std::cout << typeOfTests[3] << " - number of \"ExtractMin\" tests\n";
-        std::cout << typeOfTests[4] << " - number of \"Meld\" tests\n";
-    }
 }
 
 template <typename T>
@@ -147,6 +156,4 @@ void HeapTesting<T>::MeldStl(size_t index1, size_t index2)
 
 } // end of namespace
 
-void CreateTests(const size_t);
-
 #endif /* Testing_h */
\ No newline at end of file
@@ -0,0 +1,368 @@
+//
+//  Workloads.cpp
+//  Heaps
+//
+
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+#include "BinomialHeap.h"
+#include "DaryHeap.h"
+#include "FibonacciHeap.h"
+#include "LeftistHeap.h"
+#include "NodePool.h"
+#include "PairingHeap.h"
+#include "RadixHeap.h"
+#include "SkewHeap.h"
+#include "StlHeap.h"
+
+// Heaps under workloads close to real use, with throughput and latency
+// of single operations.
+//
+// Usage: HeapsWorkloads [--workload all|dijkstra|events|meld]
+//                       [--keys all|uniform|ties|exponential|ascending|descending]
+//                       [--heap name] [--operations N] [--size N]
+//                       [--repetitions N] [--format csv|json]
+//
+// Every run is done once untimed to warm up, then the given number of
+// times as a whole for the throughput (the median is reported), then once
+// more timing every operation for the latency percentiles. All heaps get
+// the same operations, so their checksums of extracted keys must agree.
+
+using KeyType = long long;
+using HeapCompare = std::less<KeyType>;
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    std::string workload = "all";
+    std::string keys = "all";
+    std::string heap = "all";
+    size_t operations = 1000000;
+    size_t size = 100000;           // Keys in the heaps before the operations
+    size_t repetitions = 3;
+    std::string format = "csv";
+};
+
+struct Result {
+    std::string workload;
+    std::string keys;
+    std::string heap;
+    size_t operations;
+    double throughput;              // Millions of operations per second
+    long long p50;                  // Latency percentiles, ns
+    long long p99;
+    long long checksum;
+};
+
+// Values of a key distribution. Meld uses them as keys; Dijkstra and
+// event simulation as increments over the extracted minimum
+std::vector<KeyType> MakeValues(const std::string& keys, size_t count)
+{
+    std::mt19937_64 gen(2019);
+    std::vector<KeyType> values(count);
+
+    for (size_t i = 0; i < count; i++) {
+        if (keys == "uniform") {
+            values[i] = static_cast<KeyType>(gen() % (1 << 20));
+        } else if (keys == "ties") {
+            values[i] = static_cast<KeyType>(gen() % 16);
+        } else if (keys == "exponential") {
+            values[i] = static_cast<KeyType>(std::exponential_distribution<double>(1.0 / 1000)(gen));
+        } else if (keys == "ascending") {
+            values[i] = static_cast<KeyType>(i);
+        } else {
+            values[i] = static_cast<KeyType>(count - i);
+        }
+    }
+    return values;
+}
+
+// Runs operations as they are, or timing each of them
+template <bool Timed>
+class OperationTimer {
+
+private:
+    std::vector<long long> _latencies;
+
+public:
+    template <typename Function>
+    void operator () (Function function)
+    {
+        if (Timed) {
+            auto start = Clock::now();
+            function();
+            auto end = Clock::now();
+            _latencies.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+        } else {
+            function();
+        }
+    }
+
+    std::vector<long long>& GetLatencies() { return _latencies; }
+};
+
+// Dijkstra with lazy deletion: extracts the minimum and inserts 0, 1 or 2
+// keys above it (1 on average), so keys only grow
+template <typename Heap, typename Timer>
+long long RunDijkstra(const std::vector<KeyType>& values, const Options& options, Timer& timer)
+{
+    const int fanout[] = {2, 1, 0, 1};
+
+    Heap heap;
+    size_t next = 0;
+    for (; next < options.size; next++) {
+        heap.Insert(values[next]);
+    }
+
+    long long checksum = 0;
+    KeyType minimum = 0;
+    size_t operations = 0;
+    for (size_t step = 0; operations < options.operations; step++) {
+        if (heap.Empty()) {
+            timer([&]() { heap.Insert(minimum + values[next]); });
+            next++;
+            operations++;
+            continue;
+        }
+        timer([&]() { minimum = heap.ExtractMin(); });
+        checksum += minimum;
+        operations++;
+
+        for (int k = 0; k < fanout[step % 4] && operations < options.operations; k++) {
+            timer([&]() { heap.Insert(minimum + values[next]); });
+            next++;
+            operations++;
+        }
+    }
+    return checksum;
+}
+
+// Hold model of discrete event simulation: the next event is extracted
+// and one is scheduled after it, the size stays the same
+template <typename Heap, typename Timer>
+long long RunEvents(const std::vector<KeyType>& values, const Options& options, Timer& timer)
+{
+    Heap heap;
+    size_t next = 0;
+    for (; next < options.size; next++) {
+        heap.Insert(values[next]);
+    }
+
+    long long checksum = 0;
+    KeyType minimum = 0;
+    for (size_t operations = 0; operations + 1 < options.operations && !heap.Empty(); operations += 2) {
+        timer([&]() { minimum = heap.ExtractMin(); });
+        checksum += minimum;
+        timer([&]() { heap.Insert(minimum + values[next]); });
+        next++;
+    }
+    return checksum;
+}
+
+// Many heaps: keys go to random heaps, minima are extracted from random
+// heaps and random pairs of heaps are melded, half, a fifth and a bit
+// less than a third of the operations
+template <typename Heap, typename Timer>
+long long RunMeld(const std::vector<KeyType>& values, const Options& options, Timer& timer)
+{
+    const size_t numberOfHeaps = 64;
+
+    // Copies of one heap, so that heaps with pools share one and meld
+    // without copying nodes
+    std::mt19937 gen(2019);
+    std::vector<Heap> heaps(numberOfHeaps, Heap());
+    size_t next = 0;
+    for (; next < options.size; next++) {
+        heaps[gen() % numberOfHeaps].Insert(values[next]);
+    }
+
+    long long checksum = 0;
+    for (size_t operations = 0; operations < options.operations; operations++) {
+        unsigned operation = gen() % 10;
+        Heap& heap = heaps[gen() % numberOfHeaps];
+
+        if (operation < 5) {
+            timer([&]() { heap.Insert(values[next]); });
+            next++;
+        } else if (operation < 7) {
+            if (!heap.Empty()) {
+                KeyType key = 0;
+                timer([&]() { key = heap.ExtractMin(); });
+                checksum += key;
+            }
+        } else {
+            Heap& other = heaps[gen() % numberOfHeaps];
+            if (&other != &heap) {
+                timer([&]() { heap.Meld(other); });
+            }
+        }
+    }
+    return checksum;
+}
+
+template <typename Heap, typename Timer>
+long long RunWorkload(const std::string& workload, const std::vector<KeyType>& values, const Options& options, Timer& timer)
+{
+    if (workload == "dijkstra") {
+        return RunDijkstra<Heap>(values, options, timer);
+    } else if (workload == "events") {
+        return RunEvents<Heap>(values, options, timer);
+    }
+    return RunMeld<Heap>(values, options, timer);
+}
+
+// Median cost of reading the clock twice, subtracted from the latencies
+long long TimerOverhead()
+{
+    OperationTimer<true> timer;
+    for (int i = 0; i < 100000; i++) {
+        timer([]() {});
+    }
+    std::vector<long long>& latencies = timer.GetLatencies();
+    std::nth_element(latencies.begin(), latencies.begin() + latencies.size() / 2, latencies.end());
+    return latencies[latencies.size() / 2];
+}
+
+template <typename Heap>
+Result Benchmark(const std::string& name, const std::string& workload, const std::string& keys,
+                 const std::vector<KeyType>& values, const Options& options, long long overhead)
+{
+    Result result{workload, keys, name, options.operations, 0, 0, 0, 0};
+
+    OperationTimer<false> untimed;
+    result.checksum = RunWorkload<Heap>(workload, values, options, untimed);
+
+    std::vector<long long> times;
+    for (size_t k = 0; k < options.repetitions; k++) {
+        auto start = Clock::now();
+        RunWorkload<Heap>(workload, values, options, untimed);
+        auto end = Clock::now();
+        times.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+    }
+    std::sort(times.begin(), times.end());
+    result.throughput = 1000.0 * options.operations / std::max<long long>(times[times.size() / 2], 1);
+
+    OperationTimer<true> timer;
+    RunWorkload<Heap>(workload, values, options, timer);
+    std::vector<long long>& latencies = timer.GetLatencies();
+    std::sort(latencies.begin(), latencies.end());
+    if (!latencies.empty()) {
+        result.p50 = std::max(0LL, latencies[latencies.size() / 2] - overhead);
+        result.p99 = std::max(0LL, latencies[latencies.size() * 99 / 100] - overhead);
+    }
+
+    return result;
+}
+
+void Print(const std::vector<Result>& results, const std::string& format)
+{
+    if (format == "json") {
+        std::cout << "[\n";
+        for (size_t i = 0; i < results.size(); i++) {
+            const Result& result = results[i];
+            std::cout << "  {\"workload\": \"" << result.workload << "\", \"keys\": \"" << result.keys
+                      << "\", \"heap\": \"" << result.heap << "\", \"operations\": " << result.operations
+                      << ", \"mops\": " << result.throughput << ", \"p50_ns\": " << result.p50
+                      << ", \"p99_ns\": " << result.p99 << ", \"checksum\": " << result.checksum << "}"
+                      << (i + 1 < results.size() ? ",\n" : "\n");
+        }
+        std::cout << "]\n";
+        return;
+    }
+
+    std::cout << "workload,keys,heap,operations,mops,p50_ns,p99_ns,checksum\n";
+    for (const Result& result : results) {
+        std::cout << result.workload << "," << result.keys << "," << result.heap << "," << result.operations << ","
+                  << result.throughput << "," << result.p50 << "," << result.p99 << "," << result.checksum << "\n";
+    }
+}
+
+int main(int argc, char ** argv) {
+
+    Options options;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string option = argv[i];
+        std::string value = argv[i + 1];
+
+        if (option == "--workload") {
+            options.workload = value;
+        } else if (option == "--keys") {
+            options.keys = value;
+        } else if (option == "--heap") {
+            options.heap = value;
+        } else if (option == "--operations") {
+            options.operations = std::strtoul(value.c_str(), nullptr, 10);
+        } else if (option == "--size") {
+            options.size = std::strtoul(value.c_str(), nullptr, 10);
+        } else if (option == "--repetitions") {
+            options.repetitions = std::max<size_t>(1, std::strtoul(value.c_str(), nullptr, 10));
+        } else if (option == "--format") {
+            options.format = value;
+        } else {
+            std::cerr << "Unknown option " << option << "\n";
+            return 1;
+        }
+    }
+
+    using Runner = std::function<Result(const std::string&, const std::string&, const std::vector<KeyType>&, long long)>;
+    struct HeapEntry {
+        std::string name;
+        Runner run;
+        bool meld;                  // Takes part in the meld workload
+    };
+    std::vector<HeapEntry> heaps;
+    auto add = [&heaps, &options](const std::string& name, auto heap, bool meld = true) {
+        using Heap = decltype(heap);
+        heaps.push_back({name, [name, &options](const std::string& workload, const std::string& keys,
+                                                const std::vector<KeyType>& values, long long overhead) {
+            return Benchmark<Heap>(name, workload, keys, values, options, overhead);
+        }, meld});
+    };
+    add("4-ary", DaryHeap<KeyType, HeapCompare, 4>());
+    add("binomial", BinomialHeap<KeyType, HeapCompare>());
+    add("leftist", LeftistHeap<KeyType, HeapCompare>());
+    add("skew", SkewHeap<KeyType, HeapCompare>());
+    add("pairing", PairingHeap<KeyType, HeapCompare>());
+    add("pool-pairing", PairingHeap<KeyType, HeapCompare, PoolAllocator<KeyType>>());
+    add("fibonacci", FibonacciHeap<KeyType, HeapCompare>());
+    // Keys of Dijkstra and events never go below the last minimum, those
+    // of meld do
+    add("radix", RadixHeap<unsigned long long>(), false);
+    // Melding multisets moves every node of one of them, which makes the
+    // meld workload quadratic
+    add("stl", StlHeap<KeyType, HeapCompare>(), false);
+
+    const std::vector<std::string> workloads = {"dijkstra", "events", "meld"};
+    const std::vector<std::string> distributions = {"uniform", "ties", "exponential", "ascending", "descending"};
+
+    long long overhead = TimerOverhead();
+    std::vector<Result> results;
+
+    for (const std::string& workload : workloads) {
+        if (options.workload != "all" && options.workload != workload) {
+            continue;
+        }
+        for (const std::string& keys : distributions) {
+            if (options.keys != "all" && options.keys != keys) {
+                continue;
+            }
+            std::vector<KeyType> values = MakeValues(keys, options.size + options.operations);
+            for (const HeapEntry& heap : heaps) {
+                if ((options.heap != "all" && options.heap != heap.name) || (workload == "meld" && !heap.meld)) {
+                    continue;
+                }
+                results.push_back(heap.run(workload, keys, values, overhead));
+                std::cerr << workload << " " << keys << " " << heap.name << " done\n";
+            }
+        }
+    }
+
+    Print(results, options.format);
+
+    return 0;
+}
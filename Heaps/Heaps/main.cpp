@@ -15,8 +15,6 @@
 
 int main(int argc, char ** argv) {
 
-    CreateTests(1000);
-
     testing::InitGoogleTest(&argc, argv);
 
     return RUN_ALL_TESTS();
@@ -0,0 +1,260 @@
+#ifndef matrix_h
+#define matrix_h
+
+#include <vector>
+#include <iostream>
+#include "rational.h"
+
+//
+//
+// MATRIX OVER RATIONAL NUMBERS
+//
+//
+
+
+class Matrix {
+
+public:
+
+    // Constructors
+    Matrix(size_t, size_t);
+    Matrix(const std::vector<std::vector<Rational>> &);
+
+    // Element access
+    Rational & operator () (size_t, size_t);
+    const Rational & operator () (size_t, size_t) const;
+
+    size_t rows() const;
+    size_t columns() const;
+
+    // Exact linear algebra, everything runs fraction-free elimination
+    // over BigInteger and builds Rationals only for the answer
+    Rational determinant() const;
+    size_t rank() const;
+
+    // One solution of A * x = b (free variables are zero),
+    // empty vector if the system is inconsistent
+    std::vector<Rational> solve(const std::vector<Rational> &) const;
+
+
+private:
+
+    using IntegerRows = std::vector<std::vector<BigInteger>>;
+
+    // Class fields
+    size_t rows_;
+    size_t columns_;
+    std::vector<Rational> data_;
+
+
+    // Secondary functions
+    IntegerRows integerRows(const std::vector<Rational> &, BigInteger &) const;
+    static size_t eliminate(IntegerRows &, size_t, std::vector<size_t> &, bool &);
+    static BigInteger numerator(const Rational &);
+    static BigInteger denominator(const Rational &);
+};
+
+Matrix::Matrix(size_t rows, size_t columns) : rows_(rows), columns_(columns), data_(rows * columns) {}
+
+Matrix::Matrix(const std::vector<std::vector<Rational>> & elements)
+{
+    rows_ = elements.size();
+    columns_ = (elements.empty() ? 0 : elements[0].size());
+    data_.reserve(rows_ * columns_);
+
+    for (size_t i = 0; i < rows_; i++) {
+        data_.insert(data_.end(), elements[i].begin(), elements[i].end());
+    }
+}
+
+Rational & Matrix::operator () (size_t row, size_t column)
+{
+    return data_[row * columns_ + column];
+}
+
+const Rational & Matrix::operator () (size_t row, size_t column) const
+{
+    return data_[row * columns_ + column];
+}
+
+size_t Matrix::rows() const
+{
+    return rows_;
+}
+
+size_t Matrix::columns() const
+{
+    return columns_;
+}
+
+BigInteger Matrix::numerator(const Rational & element)
+{
+    BigInteger result = (element.is_small_ ? Rational::toBigInteger(element.small_numerator_) : element.numerator_);
+    return (element.sign_ == NEGATIVE ? -result : result);
+}
+
+BigInteger Matrix::denominator(const Rational & element)
+{
+    return (element.is_small_ ? Rational::toBigInteger(element.small_denominator_) : element.denominator_);
+}
+
+// Every row (with the right side appended, if there is one) is multiplied
+// by the lcm of its denominators, product of these factors goes to scale
+Matrix::IntegerRows Matrix::integerRows(const std::vector<Rational> & right_side, BigInteger & scale) const
+{
+    IntegerRows result(rows_);
+    scale = 1;
+
+    for (size_t i = 0; i < rows_; i++) {
+        BigInteger lcm = 1;
+
+        for (size_t j = 0; j <= columns_; j++) {
+            if (j == columns_ && right_side.empty()) {
+                break;
+            }
+            BigInteger denom = denominator(j < columns_ ? (*this)(i, j) : right_side[i]);
+            if (denom != 1) {
+                lcm = lcm / gcd(lcm, denom) * denom;
+            }
+        }
+
+        result[i].reserve(columns_ + 1);
+        for (size_t j = 0; j <= columns_; j++) {
+            if (j == columns_ && right_side.empty()) {
+                break;
+            }
+            const Rational & element = (j < columns_ ? (*this)(i, j) : right_side[i]);
+            result[i].push_back(lcm == 1 ? numerator(element) : numerator(element) * (lcm / denominator(element)));
+        }
+
+        scale *= lcm;
+    }
+
+    return result;
+}
+
+// Bareiss elimination on the first columns of the rows. Every entry stays
+// a minor of the original matrix, so each division by the previous pivot
+// is exact and numbers grow only linearly. Returns rank, pivot columns
+// are appended to pivots, odd_swaps tells the parity of row swaps
+size_t Matrix::eliminate(IntegerRows & a, size_t columns, std::vector<size_t> & pivots, bool & odd_swaps)
+{
+    BigInteger previous = 1;
+    size_t rank = 0;
+    odd_swaps = false;
+
+    for (size_t column = 0; column < columns && rank < a.size(); column++) {
+        size_t pivot = rank;
+        while (pivot < a.size() && a[pivot][column] == 0) {
+            pivot++;
+        }
+        if (pivot == a.size()) {
+            continue;
+        }
+        if (pivot != rank) {
+            std::swap(a[pivot], a[rank]);
+            odd_swaps = !odd_swaps;
+        }
+
+        const std::vector<BigInteger> & pivot_row = a[rank];
+
+        for (size_t i = rank + 1; i < a.size(); i++) {
+            for (size_t j = column + 1; j < pivot_row.size(); j++) {
+                BigInteger value = pivot_row[column] * a[i][j];
+                if (a[i][column] != 0 && pivot_row[j] != 0) {
+                    value -= a[i][column] * pivot_row[j];
+                }
+                a[i][j] = (previous == 1 ? value : value / previous);
+            }
+            a[i][column] = 0;
+        }
+
+        previous = pivot_row[column];
+        pivots.push_back(column);
+        rank++;
+    }
+
+    return rank;
+}
+
+Rational Matrix::determinant() const
+{
+    if (rows_ != columns_) {
+        std::cerr << "Determinant of non-square matrix!";
+        return 0;
+    }
+    if (rows_ == 0) {
+        return 1;
+    }
+
+    BigInteger scale;
+    IntegerRows a = integerRows(std::vector<Rational>(), scale);
+    std::vector<size_t> pivots;
+    bool odd_swaps;
+
+    if (eliminate(a, columns_, pivots, odd_swaps) < rows_) {
+        return 0;
+    }
+
+    BigInteger result = a[rows_ - 1][columns_ - 1];
+    return Rational(odd_swaps ? -result : result) / Rational(scale);
+}
+
+size_t Matrix::rank() const
+{
+    BigInteger scale;
+    IntegerRows a = integerRows(std::vector<Rational>(), scale);
+    std::vector<size_t> pivots;
+    bool odd_swaps;
+
+    return eliminate(a, columns_, pivots, odd_swaps);
+}
+
+std::vector<Rational> Matrix::solve(const std::vector<Rational> & right_side) const
+{
+    if (right_side.size() != rows_) {
+        std::cerr << "Size of right side doesn't match the matrix!";
+        return std::vector<Rational>();
+    }
+
+    BigInteger scale;
+    IntegerRows a = integerRows(right_side, scale);
+    std::vector<size_t> pivots;
+    bool odd_swaps;
+
+    size_t rank = eliminate(a, columns_, pivots, odd_swaps);
+
+    for (size_t i = rank; i < rows_; i++) {
+        if (a[i][columns_] != 0) {
+            return std::vector<Rational>();
+        }
+    }
+
+    std::vector<Rational> result(columns_);
+    if (rank == 0) {
+        return result;
+    }
+
+    // Back substitution stays in integers: by Cramer's rule y = D * x is
+    // integral, where D is the last pivot, so every division is exact
+    BigInteger D = a[rank - 1][pivots[rank - 1]];
+    std::vector<BigInteger> y(rank);
+
+    for (size_t i = rank; i > 0; i--) {
+        const std::vector<BigInteger> & row = a[i - 1];
+        BigInteger sum = D * row[columns_];
+
+        for (size_t j = i; j < rank; j++) {
+            if (row[pivots[j]] != 0) {
+                sum -= row[pivots[j]] * y[j];
+            }
+        }
+
+        y[i - 1] = sum / row[pivots[i - 1]];
+        result[pivots[i - 1]] = Rational(y[i - 1]) / Rational(D);
+    }
+
+    return result;
+}
+
+#endif /* matrix_h */
@@ -0,0 +1,105 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "matrix.h"
+
+// Textbook Gaussian elimination directly over Rational, returns solution
+// of A * x = b for a non-singular matrix together with its determinant
+std::vector<Rational> naiveSolve(std::vector<std::vector<Rational>> a, std::vector<Rational> b, Rational & determinant)
+{
+    size_t n = a.size();
+    determinant = 1;
+
+    for (size_t column = 0; column < n; column++) {
+        size_t pivot = column;
+        while (pivot < n && a[pivot][column] == 0) {
+            pivot++;
+        }
+        if (pivot == n) {
+            determinant = 0;
+            return std::vector<Rational>();
+        }
+        if (pivot != column) {
+            std::swap(a[pivot], a[column]);
+            std::swap(b[pivot], b[column]);
+            determinant = -determinant;
+        }
+
+        determinant *= a[column][column];
+
+        for (size_t i = column + 1; i < n; i++) {
+            Rational factor = a[i][column] / a[column][column];
+            for (size_t j = column; j < n; j++) {
+                a[i][j] -= factor * a[column][j];
+            }
+            b[i] -= factor * b[column];
+        }
+    }
+
+    std::vector<Rational> x(n);
+    for (size_t i = n; i > 0; i--) {
+        Rational sum = b[i - 1];
+        for (size_t j = i; j < n; j++) {
+            sum -= a[i - 1][j] * x[j];
+        }
+        x[i - 1] = sum / a[i - 1][i - 1];
+    }
+
+    return x;
+}
+
+template <class Function>
+long long measure(Function function)
+{
+    using namespace std::chrono;
+
+    auto start = high_resolution_clock::now();
+    function();
+    auto finish = high_resolution_clock::now();
+    return duration_cast<milliseconds>(finish - start).count();
+}
+
+// Usage: matrix_benchmark [max size], sizes go from 10 up to max size with step 30
+int main(int argc, char ** argv)
+{
+    size_t max_size = (argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100);
+
+    std::mt19937 gen(7);
+
+    std::cout << "size\tbareiss, ms\tnaive, ms\n";
+    for (size_t n = 10; n <= max_size; n += 30) {
+        std::vector<std::vector<Rational>> elements(n, std::vector<Rational>(n));
+        std::vector<Rational> b(n);
+
+        for (size_t i = 0; i < n; i++) {
+            for (size_t j = 0; j < n; j++) {
+                elements[i][j] = static_cast<int>(gen() % 201) - 100;
+            }
+            b[i] = static_cast<int>(gen() % 201) - 100;
+        }
+
+        Matrix matrix(elements);
+        Rational fast_determinant, naive_determinant;
+        std::vector<Rational> fast_solution, naive_solution;
+
+        long long fast_time = measure([&]() {
+            fast_determinant = matrix.determinant();
+            fast_solution = matrix.solve(b);
+        });
+        long long naive_time = measure([&]() {
+            naive_solution = naiveSolve(elements, b, naive_determinant);
+        });
+
+        bool same = (fast_determinant == naive_determinant && fast_solution.size() == naive_solution.size());
+        for (size_t i = 0; same && i < fast_solution.size(); i++) {
+            same = (fast_solution[i] == naive_solution[i]);
+        }
+
+        std::cout << n << "\t" << fast_time << "\t\t" << naive_time << (same ? "" : "\tMISMATCH") << "\n";
+    }
+
+    return 0;
+}
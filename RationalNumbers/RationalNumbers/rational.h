@@ -4,6 +4,7 @@
 #include <vector>
 #include <string>
 #include <iostream>
+#include <cstdint>
 
 enum SignType {
     POSITIVE = 0,
@@ -204,26 +205,18 @@ BigInteger& BigInteger::sumAndSub (BigInteger & first, const BigInteger & second
 BigInteger BigInteger::mult (const BigInteger & first, const BigInteger & second, SignType result_sign_)
 {
     BigInteger result;
-    size_t size = first.data_.size() * second.data_.size();
+    size_t size = first.data_.size() + second.data_.size();
     result.sign_ = result_sign_;
-    result.data_.clear();
-    result.data_.reserve(size + 1);
-    
-    unsigned char carry = 0;
+    result.data_.assign(size, 0);
     
-    for (size_t i = 0; i < size + 1; i++) {
-        result.data_.push_back(carry);
-        carry = 0;
-        for (size_t j = 0; j <= i; j++) {
-            unsigned char first_term = (j < first.data_.size() ? first.data_[j] : 0);
-            unsigned char second_term = (i - j < second.data_.size() ? second.data_[i - j] : 0);
-            
-            result.data_[i] += first_term * second_term;
+    for (size_t i = 0; i < first.data_.size(); i++) {
+        unsigned int carry = 0;
+        for (size_t j = 0; j < second.data_.size() || carry; j++) {
+            unsigned int current = result.data_[i + j] + carry +
+                                   (j < second.data_.size() ? first.data_[i] * second.data_[j] : 0);
             
-            if (result.data_[i] >= BigInteger::Base) {
-                carry += result.data_[i] / BigInteger::Base;
-                result.data_[i] %= BigInteger::Base;
-            }
+            result.data_[i + j] = current % BigInteger::Base;
+            carry = current / BigInteger::Base;
         }
     }
     
@@ -236,31 +229,29 @@ BigInteger BigInteger::divAndMod (const BigInteger & first, const BigInteger & s
 {
     if (second == 0) {
         std::cerr << "Devision by zero";
+        return 0;
     }
     
-    BigInteger result = 0;
-    
-    BigInteger num = abs(first), denom = abs(second), degree;
+    BigInteger result, num;
+    BigInteger denom = abs(second);
+    result.data_.assign(first.data_.size(), 0);
     
-    while (num >= denom) {
-        degree = 1;
-        
-        while (num >= denom) {
-            denom *= BigInteger::Base;
-            degree *= BigInteger::Base;
-        }
-        
-        if (degree > 0) {
-            denom.data_.erase(denom.data_.begin());
-            degree.data_.erase(degree.data_.begin());
-        }
+    // Long division: bring down one digit at a time, every quotient digit
+    // takes at most Base - 1 in-place subtractions
+    for (size_t i = first.data_.size(); i > 0; i--) {
+        num.data_.insert(num.data_.begin(), first.data_[i - 1]);
+        num.deleteLeadingZeros();
         
-        while (num >= denom) {
-            num -= denom;
-            result += degree;
+        while (BigInteger::compareByAbs(num, denom) != LOWER) {
+            int borrow = 0;
+            for (size_t j = 0; j < num.data_.size(); j++) {
+                int digit = num.data_[j] - borrow - (j < denom.data_.size() ? denom.data_[j] : 0);
+                borrow = (digit < 0 ? 1 : 0);
+                num.data_[j] = static_cast<unsigned char>(digit + borrow * BigInteger::Base);
+            }
+            num.deleteLeadingZeros();
+            result.data_[i - 1]++;
         }
-        
-        denom = abs(second);
     }
     
     if (is_div) {
@@ -548,6 +539,8 @@ public:
     // Rational to double
     explicit operator double();
     
+    friend class Matrix;
+    
     
 private:
     
@@ -556,21 +549,41 @@ private:
     BigInteger denominator_;
     SignType sign_;
     
+    // Fixed-width fast path: while is_small_ is set, absolute values of
+    // numerator and denominator live here and BigInteger fields are unused
+    bool is_small_;
+    int64_t small_numerator_;
+    int64_t small_denominator_;
+    
+    // Any number with so many decimal digits fits into int64_t
+    static const size_t SmallDigits = 18;
+    
     
     // Secondary functions
     void normalize();
+    void promote();
+    void demote();
     void divisionForDecimal(std::string &, BigInteger &, BigInteger &, bool, size_t = 0);
     static CompareType compareByAbs(const Rational &, const Rational &);
     static CompareType compare(const Rational &, const Rational &);
     static Rational sumAndSub (const Rational &, const Rational &, SignType, bool);
     static Rational& multAndDiv (Rational &, const Rational &, SignType, bool = true);
+    
+    // Fast path functions, return false if result doesn't fit into int64_t
+    static bool smallCompareByAbs (const Rational &, const Rational &, CompareType &);
+    static bool smallSumAndSub (Rational &, const Rational &, const Rational &, bool);
+    static bool smallMultAndDiv (Rational &, const Rational &, bool);
+    static int64_t smallGcd (int64_t, int64_t);
+    static BigInteger toBigInteger (int64_t);
+    static Rational promoted (const Rational &);
 };
 
 Rational::Rational()
 {
-    numerator_ = 0;
-    denominator_ = 1;
     sign_ = POSITIVE;
+    is_small_ = true;
+    small_numerator_ = 0;
+    small_denominator_ = 1;
 }
 
 Rational::Rational(BigInteger number)
@@ -578,22 +591,44 @@ Rational::Rational(BigInteger number)
     numerator_ = abs(number);
     denominator_ = 1;
     sign_ = number.sign_;
+    is_small_ = false;
+    demote();
 }
 
 Rational::Rational(int number)
 {
-    numerator_ = (number < 0 ? -number : number);
-    denominator_ = 1;
     sign_ = (number < 0 ? NEGATIVE : POSITIVE);
+    is_small_ = true;
+    small_numerator_ = (number < 0 ? -static_cast<int64_t>(number) : number);
+    small_denominator_ = 1;
 }
 
 Rational::operator double()
 {
+    // Integers below 2^53 are exact in double, so one division rounds correctly
+    const int64_t exact_limit = static_cast<int64_t>(1) << 53;
+    
+    if (is_small_ && small_numerator_ < exact_limit && small_denominator_ < exact_limit) {
+        double result = static_cast<double>(small_numerator_) / static_cast<double>(small_denominator_);
+        return (sign_ == POSITIVE ? result : -result);
+    }
     return std::stod(asDecimal(1000));
 }
 
 void Rational::normalize()
 {
+    if (is_small_) {
+        int64_t GCD = smallGcd(small_numerator_, small_denominator_);
+        small_numerator_ /= GCD;
+        small_denominator_ /= GCD;
+        
+        if (small_numerator_ == 0) {
+            sign_ = POSITIVE;
+            small_denominator_ = 1;
+        }
+        return;
+    }
+    
     BigInteger GCD = gcd(numerator_, denominator_);
     numerator_ /= GCD;
     denominator_ /= GCD;
@@ -602,15 +637,99 @@ void Rational::normalize()
         sign_ = POSITIVE;
         denominator_ = 1;
     }
+    
+    demote();
+}
+
+void Rational::promote()
+{
+    if (!is_small_) {
+        return;
+    }
+    numerator_ = toBigInteger(small_numerator_);
+    denominator_ = toBigInteger(small_denominator_);
+    is_small_ = false;
+}
+
+void Rational::demote()
+{
+    if (is_small_ || numerator_.data_.size() > SmallDigits || denominator_.data_.size() > SmallDigits) {
+        return;
+    }
+    
+    small_numerator_ = 0;
+    for (size_t i = numerator_.data_.size(); i > 0; i--) {
+        small_numerator_ = small_numerator_ * BigInteger::Base + numerator_.data_[i - 1];
+    }
+    
+    small_denominator_ = 0;
+    for (size_t i = denominator_.data_.size(); i > 0; i--) {
+        small_denominator_ = small_denominator_ * BigInteger::Base + denominator_.data_[i - 1];
+    }
+    
+    is_small_ = true;
+}
+
+int64_t Rational::smallGcd(int64_t a, int64_t b)
+{
+    while (b != 0) {
+        a %= b;
+        std::swap(a, b);
+    }
+    return a;
+}
+
+BigInteger Rational::toBigInteger(int64_t number)
+{
+    BigInteger result;
+    result.data_.clear();
+    
+    do {
+        result.data_.push_back(number % BigInteger::Base);
+        number /= BigInteger::Base;
+    } while (number > 0);
+    
+    return result;
+}
+
+Rational Rational::promoted(const Rational & element)
+{
+    Rational result = element;
+    result.promote();
+    return result;
 }
 
 std::string Rational::toString()
 {
+    if (is_small_) {
+        return (sign_ == POSITIVE ? "" : "-") + std::to_string(small_numerator_) +
+               (small_denominator_ == 1 ? "" : "/" + std::to_string(small_denominator_));
+    }
     return (sign_ == POSITIVE ? "" : "-") + numerator_.toString() + (denominator_ == 1 ? "" : "/" + denominator_.toString());
 }
 
+bool Rational::smallCompareByAbs(const Rational & first, const Rational & second, CompareType & result)
+{
+    int64_t first_term, second_term;
+    
+    if (__builtin_mul_overflow(first.small_numerator_, second.small_denominator_, &first_term) ||
+        __builtin_mul_overflow(second.small_numerator_, first.small_denominator_, &second_term)) {
+        return false;
+    }
+    
+    result = (first_term < second_term ? LOWER : (first_term > second_term ? GREATER : EQUAL));
+    return true;
+}
+
 CompareType Rational::compareByAbs(const Rational & first, const Rational & second)
 {
+    if (first.is_small_ || second.is_small_) {
+        CompareType result;
+        if (first.is_small_ && second.is_small_ && smallCompareByAbs(first, second, result)) {
+            return result;
+        }
+        return compareByAbs(promoted(first), promoted(second));
+    }
     if (first.numerator_ == second.numerator_ && first.denominator_ == second.denominator_) {
         return EQUAL;
     }
@@ -622,9 +741,6 @@ CompareType Rational::compare(const Rational & first, const Rational & second)
     if (first.sign_ != second.sign_) {
         return (first.sign_ == NEGATIVE ? LOWER : GREATER);
     }
-    if (first.numerator_ == second.numerator_ && first.denominator_ == second.denominator_) {
-        return EQUAL;
-    }
     return (first.sign_ == POSITIVE ? compareByAbs(first, second) : compareByAbs(second, first));
 }
 
@@ -671,6 +787,10 @@ void Rational::divisionForDecimal(std::string & answer, BigInteger & num, BigInt
 
 std::string Rational::asDecimal(size_t precision = 0)
 {
+    if (is_small_) {
+        return promoted(*this).asDecimal(precision);
+    }
+    
     BigInteger num = abs(numerator_);
     BigInteger denom = abs(denominator_);
 
@@ -686,9 +806,71 @@ std::string Rational::asDecimal(size_t precision = 0)
     return answer;
 }
 
+bool Rational::smallSumAndSub (Rational & result, const Rational & first, const Rational & second, bool is_sum)
+{
+    // Both fractions are reduced, so after bringing them to the common
+    // denominator only a divisor of GCD can be cancelled
+    int64_t GCD = smallGcd(first.small_denominator_, second.small_denominator_);
+    int64_t first_factor = second.small_denominator_ / GCD;
+    int64_t second_factor = first.small_denominator_ / GCD;
+    int64_t first_term, second_term, numerator, denominator;
+    
+    if (__builtin_mul_overflow(first.small_numerator_, first_factor, &first_term) ||
+        __builtin_mul_overflow(second.small_numerator_, second_factor, &second_term) ||
+        (is_sum ?
+         __builtin_add_overflow(first_term, second_term, &numerator) :
+         __builtin_sub_overflow(first_term, second_term, &numerator))) {
+        return false;
+    }
+    
+    int64_t reduction = smallGcd(numerator, GCD);
+    
+    if (__builtin_mul_overflow(second_factor, second.small_denominator_ / reduction, &denominator)) {
+        return false;
+    }
+    
+    result.small_numerator_ = numerator / reduction;
+    result.small_denominator_ = (numerator == 0 ? 1 : denominator);
+    return true;
+}
+
+bool Rational::smallMultAndDiv (Rational & first, const Rational & second, bool is_mult)
+{
+    int64_t second_numerator = (is_mult ? second.small_numerator_ : second.small_denominator_);
+    int64_t second_denominator = (is_mult ? second.small_denominator_ : second.small_numerator_);
+    
+    // Division by zero is reported by BigInteger path
+    if (second_denominator == 0) {
+        return false;
+    }
+    
+    int64_t first_gcd = smallGcd(first.small_numerator_, second_denominator);
+    int64_t second_gcd = smallGcd(second_numerator, first.small_denominator_);
+    int64_t numerator, denominator;
+    
+    if (__builtin_mul_overflow(first.small_numerator_ / first_gcd, second_numerator / second_gcd, &numerator) ||
+        __builtin_mul_overflow(first.small_denominator_ / second_gcd, second_denominator / first_gcd, &denominator)) {
+        return false;
+    }
+    
+    first.small_numerator_ = numerator;
+    first.small_denominator_ = (numerator == 0 ? 1 : denominator);
+    return true;
+}
+
 Rational Rational::sumAndSub (const Rational & first, const Rational & second, SignType result_sign, bool is_sum)
 {
     Rational result;
+    
+    if (first.is_small_ && second.is_small_ && smallSumAndSub(result, first, second, is_sum)) {
+        result.sign_ = (result.small_numerator_ == 0 ? POSITIVE : result_sign);
+        return result;
+    }
+    if (first.is_small_ || second.is_small_) {
+        return sumAndSub(promoted(first), promoted(second), result_sign, is_sum);
+    }
+    
+    result.is_small_ = false;
     result.numerator_ = first.numerator_ * second.denominator_ + second.numerator_ * first.denominator_ * (is_sum ? 1 : -1);
     result.denominator_ = first.denominator_ * second.denominator_;
     result.sign_ = result_sign;
@@ -698,6 +880,16 @@ Rational Rational::sumAndSub (const Rational & first, const Rational & second, S
 
 Rational& Rational::multAndDiv (Rational & first, const Rational & second, SignType result_sign, bool is_mult)
 {
+    if (first.is_small_ && second.is_small_ && smallMultAndDiv(first, second, is_mult)) {
+        first.sign_ = (first.small_numerator_ == 0 ? POSITIVE : result_sign);
+        return first;
+    }
+    if (first.is_small_ || second.is_small_) {
+        Rational rhs = promoted(second);
+        first.promote();
+        return multAndDiv(first, rhs, result_sign, is_mult);
+    }
+    
     if (!is_mult && second == 0) {
         std::cerr << "Division by zero!";
     }
@@ -710,9 +902,14 @@ Rational& Rational::multAndDiv (Rational & first, const Rational & second, SignT
 
 Rational & Rational::operator = (const Rational & second)
 {
-    this -> numerator_ = second.numerator_;
-    this -> denominator_ = second.denominator_;
+    if (!second.is_small_) {
+        this -> numerator_ = second.numerator_;
+        this -> denominator_ = second.denominator_;
+    }
     this -> sign_ = second.sign_;
+    this -> is_small_ = second.is_small_;
+    this -> small_numerator_ = second.small_numerator_;
+    this -> small_denominator_ = second.small_denominator_;
     return *this;
 }
 
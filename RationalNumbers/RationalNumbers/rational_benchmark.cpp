@@ -0,0 +1,84 @@
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <vector>
+
+#include "rational.h"
+
+// Values whose numerator and denominator fit into int64_t
+Rational makeSmall(std::mt19937 & gen)
+{
+    int numerator = static_cast<int>(gen() % 2000001) - 1000000;
+    int denominator = static_cast<int>(gen() % 1000000) + 1;
+    return Rational(numerator) / Rational(denominator);
+}
+
+// Values with ~30 digit numerators, always kept in BigInteger form
+Rational makeLarge(std::mt19937 & gen)
+{
+    std::stringstream stream;
+    stream << (gen() % 9 + 1);
+    for (int i = 0; i < 29; i++) {
+        stream << gen() % 10;
+    }
+
+    BigInteger numerator;
+    stream >> numerator;
+    return Rational(numerator) / makeSmall(gen);
+}
+
+template <class Function>
+long long measure(Function function)
+{
+    using namespace std::chrono;
+
+    auto start = high_resolution_clock::now();
+    function();
+    auto finish = high_resolution_clock::now();
+    return duration_cast<microseconds>(finish - start).count();
+}
+
+// Runs add, multiply, divide and compare on random pairs from a pool
+// where every value is large with given probability
+long long runMix(int large_percent, size_t operations)
+{
+    std::mt19937 gen(large_percent);
+    std::vector<Rational> pool;
+
+    for (int i = 0; i < 256; i++) {
+        pool.push_back(static_cast<int>(gen() % 100) < large_percent ? makeLarge(gen) : makeSmall(gen));
+    }
+
+    size_t less_count = 0;
+
+    long long time = measure([&]() {
+        for (size_t i = 0; i < operations; i++) {
+            const Rational & first = pool[gen() % pool.size()];
+            const Rational & second = pool[gen() % pool.size()];
+
+            Rational result;
+            switch (i % 4) {
+                case 0: result = first + second; break;
+                case 1: result = first * second; break;
+                case 2: result = (second == 0 ? first : first / second); break;
+                case 3: less_count += (first < second); break;
+            }
+        }
+    });
+
+    return time;
+}
+
+int main()
+{
+    const size_t operations = 10000;
+
+    std::cout << "large %\ttime, ms\tns per op\n";
+    for (int large_percent : {0, 1, 10, 50, 100}) {
+        long long time = runMix(large_percent, operations);
+        std::cout << large_percent << "\t" << time / 1000 << "\t\t" << time * 1000 / static_cast<long long>(operations) << "\n";
+    }
+
+    return 0;
+}